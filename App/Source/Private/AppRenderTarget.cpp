@@ -2,6 +2,7 @@
 
 #include <Core/Renderer.h>
 #include <Core/Scene.h>
+#include <Vulkan/SwapChain.h>
 
 #include <volk.h>
 
@@ -23,7 +24,7 @@ namespace Nightbird
 		renderPass->Begin(commandBuffer, framebuffer, extent);
 		Camera* mainCamera = scene->GetMainCamera();
 		if (mainCamera)
-			renderer->DrawScene(scene, mainCamera, commandBuffer, extent);
+			renderer->DrawScene(scene, mainCamera, commandBuffer, renderPass, framebuffer, renderer->GetOitTargets(), renderer->GetSwapChain()->GetDepthImage(), extent, renderSettings);
 		renderPass->End(commandBuffer);
 	}
 }
\ No newline at end of file
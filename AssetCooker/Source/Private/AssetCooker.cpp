@@ -0,0 +1,314 @@
+#include "AssetCooker.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+
+#include <stb_image.h>
+
+#include "Core/CookedModel.h"
+#include "Core/CookedTexture.h"
+#include "Core/Hash.h"
+#include "Core/JobSystem.h"
+#include "Core/MappedFile.h"
+#include "Core/Model.h"
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr const char* DatabaseFileName = "CookDatabase.json";
+
+		std::string GetLowerExtension(const std::filesystem::path& path)
+		{
+			std::string extension = path.extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return extension;
+		}
+
+		// Keeps the write time fast path working after a touch that left the content alone
+		void RefreshWriteTime(CookedSourceInfo& info, const std::filesystem::path& path)
+		{
+			std::error_code error;
+			auto writeTime = std::filesystem::last_write_time(path, error);
+			if (!error)
+				info.writeTime = writeTime.time_since_epoch().count();
+		}
+	}
+
+	AssetCooker::AssetCooker(JobSystem* jobSystem, const std::filesystem::path& sourceRoot, const std::filesystem::path& outputRoot, const CookSettings& settings)
+		: jobSystem(jobSystem), sourceRoot(sourceRoot), outputRoot(outputRoot), settings(settings), importer(jobSystem, settings.model)
+	{
+	}
+
+	bool AssetCooker::Run()
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		std::error_code error;
+		if (!std::filesystem::is_directory(sourceRoot, error))
+		{
+			std::cerr << "Source directory not found: " << sourceRoot.string() << std::endl;
+			return false;
+		}
+
+		std::filesystem::create_directories(outputRoot, error);
+
+		// Loaded even when forced, records of deleted sources still say which outputs to remove
+		std::filesystem::path databasePath = outputRoot / DatabaseFileName;
+		database.Load(databasePath);
+
+		std::vector<CookItem> items = GatherSources();
+
+		// Records are only read here, the database is updated once every item is done
+		jobSystem->ParallelFor(items.size(), [&](size_t itemIndex)
+			{
+				CookItem& item = items[itemIndex];
+
+				const CookRecord* existing = database.Find(item.key);
+				if (existing && !settings.force)
+				{
+					item.record = *existing;
+					if (IsUpToDate(item, item.record))
+					{
+						item.result = CookResult::UpToDate;
+						return;
+					}
+				}
+
+				bool cooked = item.type == AssetType::Model ? CookModel(item) : CookTexture(item);
+				item.result = cooked ? CookResult::Cooked : CookResult::Failed;
+
+				if (cooked)
+					std::cout << "Cooked " << item.key << std::endl;
+				else
+					std::cerr << "Failed to cook " << item.key << std::endl;
+			});
+
+		size_t cookedCount = 0;
+		size_t upToDateCount = 0;
+		size_t failedCount = 0;
+
+		std::unordered_set<std::string> sources;
+		for (const CookItem& item : items)
+		{
+			sources.insert(item.key);
+
+			switch (item.result)
+			{
+			case CookResult::UpToDate:
+				++upToDateCount;
+				database.Set(item.key, item.record);
+				break;
+			case CookResult::Cooked:
+				++cookedCount;
+				database.Set(item.key, item.record);
+				break;
+			case CookResult::Failed:
+				// Forgotten and its old output dropped, so nothing stale is loaded and the next run retries it
+				++failedCount;
+				database.Remove(item.key);
+				std::filesystem::remove(item.output, error);
+				break;
+			}
+		}
+
+		std::vector<std::string> deletedSources;
+		for (const auto& [source, record] : database.GetRecords())
+		{
+			if (sources.count(source) == 0)
+				deletedSources.push_back(source);
+		}
+
+		for (const std::string& source : deletedSources)
+		{
+			std::filesystem::remove(outputRoot / database.Find(source)->output, error);
+			database.Remove(source);
+			std::cout << "Removed output of deleted " << source << std::endl;
+		}
+
+		database.Save(databasePath);
+
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "Cooked " << cookedCount << ", up to date " << upToDateCount << ", failed " << failedCount << " in " << milliseconds << " ms on " << jobSystem->GetWorkerCount() << " threads" << std::endl;
+
+		return failedCount == 0;
+	}
+
+	std::vector<AssetCooker::CookItem> AssetCooker::GatherSources() const
+	{
+		std::vector<CookItem> items;
+		std::vector<uintmax_t> sizes;
+
+		std::error_code error;
+		for (auto it = std::filesystem::recursive_directory_iterator(sourceRoot, std::filesystem::directory_options::skip_permission_denied, error);
+			it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			if (error)
+				break;
+
+			if (!it->is_regular_file(error))
+				continue;
+
+			std::string extension = GetLowerExtension(it->path());
+
+			CookItem item;
+			if (extension == ".glb" || extension == ".gltf")
+				item.type = AssetType::Model;
+			else if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp")
+				item.type = AssetType::Texture;
+			else
+				continue;
+
+			std::filesystem::path relative = std::filesystem::relative(it->path(), sourceRoot, error);
+			if (error)
+				continue;
+
+			item.key = relative.generic_string();
+			item.source = it->path();
+			item.output = outputRoot / relative;
+			item.output += item.type == AssetType::Model ? CookedModelExtension : CookedTextureExtension;
+			item.record.output = item.key + (item.type == AssetType::Model ? CookedModelExtension : CookedTextureExtension);
+
+			items.push_back(std::move(item));
+			sizes.push_back(it->file_size(error));
+		}
+
+		// Largest first, so a big model doesn't start last and hold up the run
+		std::vector<size_t> order(items.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+		std::vector<CookItem> sorted;
+		sorted.reserve(items.size());
+		for (size_t index : order)
+			sorted.push_back(std::move(items[index]));
+
+		return sorted;
+	}
+
+	uint64_t AssetCooker::GetSettingsHash(AssetType type) const
+	{
+		uint32_t values[4] = {};
+		values[0] = static_cast<uint32_t>(type);
+
+		if (type == AssetType::Model)
+		{
+			values[1] = CookedModelVersion;
+			values[2] = settings.model.optimizeMeshes ? 1 : 0;
+			values[3] = settings.model.generateLods ? 1 : 0;
+		}
+		else
+		{
+			values[1] = CookedTextureVersion;
+		}
+
+		return HashBytes(values, sizeof(values));
+	}
+
+	bool AssetCooker::IsUpToDate(const CookItem& item, CookRecord& record) const
+	{
+		if (record.settingsHash != GetSettingsHash(item.type))
+			return false;
+
+		std::error_code error;
+		if (!std::filesystem::exists(item.output, error))
+			return false;
+
+		if (!IsCookedSourceCurrent(record.source, item.source))
+			return false;
+		RefreshWriteTime(record.source, item.source);
+
+		for (auto& [dependency, info] : record.dependencies)
+		{
+			std::filesystem::path dependencyPath = sourceRoot / dependency;
+			if (!IsCookedSourceCurrent(info, dependencyPath))
+				return false;
+			RefreshWriteTime(info, dependencyPath);
+		}
+
+		return true;
+	}
+
+	bool AssetCooker::CookModel(CookItem& item) const
+	{
+		// Taken before the import, a source saved mid cook then shows up as changed next run
+		CookedSourceInfo sourceInfo;
+		if (!GetCookedSourceInfo(item.source, sourceInfo))
+			return false;
+
+		std::vector<CookedDependency> cookedDependencies;
+		if (!GetCookedDependencies(item.source, cookedDependencies))
+			return false;
+
+		// The database keys dependencies by their path under the source root
+		std::vector<std::pair<std::string, CookedSourceInfo>> dependencies;
+		for (const CookedDependency& dependency : cookedDependencies)
+		{
+			std::error_code error;
+			std::filesystem::path relative = std::filesystem::relative(item.source.parent_path() / dependency.path, sourceRoot, error);
+			if (!error)
+				dependencies.emplace_back(relative.lexically_normal().generic_string(), dependency.info);
+		}
+
+		ModelImportStats importStats;
+		auto model = importer.Import(item.source, &importStats);
+		if (!model)
+			return false;
+
+		if (settings.reportImportStats && importStats.readSeconds > 0.0)
+			std::cout << "Read " << item.key << ": " << importStats.readVertices << " vertices in " << importStats.readSeconds * 1000.0 << " ms (" << importStats.readVertices / importStats.readSeconds / 1e6 << "M vertices/s per thread)" << std::endl;
+
+		std::error_code error;
+		std::filesystem::create_directories(item.output.parent_path(), error);
+
+		if (!WriteCookedModel(*model, sourceInfo, cookedDependencies, item.output))
+			return false;
+
+		item.record.source = sourceInfo;
+		item.record.settingsHash = GetSettingsHash(item.type);
+		item.record.dependencies = std::move(dependencies);
+		return true;
+	}
+
+	bool AssetCooker::CookTexture(CookItem& item) const
+	{
+		CookedSourceInfo sourceInfo;
+		if (!GetCookedSourceInfo(item.source, sourceInfo))
+			return false;
+
+		MappedFile source;
+		if (!source.Open(item.source))
+			return false;
+
+		// Flipped here rather than through stb's global flag, models decode on other workers at the same time
+		int width, height, channels;
+		stbi_uc* pixels = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()), &width, &height, &channels, STBI_rgb_alpha);
+		if (!pixels)
+		{
+			std::cerr << "STB Image failed to decode " << item.key << std::endl;
+			return false;
+		}
+
+		size_t rowSize = static_cast<size_t>(width) * 4;
+		std::vector<uint8_t> flipped(rowSize * height);
+		for (int row = 0; row < height; ++row)
+			memcpy(flipped.data() + rowSize * row, pixels + rowSize * (height - 1 - row), rowSize);
+
+		stbi_image_free(pixels);
+
+		std::error_code error;
+		std::filesystem::create_directories(item.output.parent_path(), error);
+
+		if (!WriteCookedTexture(flipped.data(), static_cast<uint32_t>(width), static_cast<uint32_t>(height), sourceInfo, item.output))
+			return false;
+
+		item.record.source = sourceInfo;
+		item.record.settingsHash = GetSettingsHash(item.type);
+		item.record.dependencies.clear();
+		return true;
+	}
+}
\ No newline at end of file
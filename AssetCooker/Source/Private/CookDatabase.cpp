@@ -0,0 +1,133 @@
+#include "CookDatabase.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr uint32_t DatabaseVersion = 1;
+
+		nlohmann::json SourceToJson(const CookedSourceInfo& info)
+		{
+			return { { "size", info.size }, { "writeTime", info.writeTime }, { "hash", info.contentHash } };
+		}
+
+		CookedSourceInfo SourceFromJson(const nlohmann::json& json)
+		{
+			CookedSourceInfo info;
+			info.size = json.value("size", uint64_t(0));
+			info.writeTime = json.value("writeTime", int64_t(0));
+			info.contentHash = json.value("hash", uint64_t(0));
+			return info;
+		}
+	}
+
+	bool CookDatabase::Load(const std::filesystem::path& path)
+	{
+		records.clear();
+
+		std::ifstream file(path);
+		if (!file.is_open())
+			return true;
+
+		nlohmann::json json = nlohmann::json::parse(file, nullptr, false);
+		if (json.is_discarded() || !json.is_object())
+		{
+			std::cerr << "Cook database is corrupt, everything will be recooked: " << path.string() << std::endl;
+			return false;
+		}
+
+		if (json.value("version", uint32_t(0)) != DatabaseVersion)
+			return true;
+
+		// Held in locals, items() only references the object it iterates
+		nlohmann::json recordsJson = json.value("records", nlohmann::json::object());
+		for (const auto& [source, entry] : recordsJson.items())
+		{
+			CookRecord record;
+			record.source = SourceFromJson(entry.value("source", nlohmann::json::object()));
+			record.settingsHash = entry.value("settings", uint64_t(0));
+			record.output = entry.value("output", std::string());
+
+			nlohmann::json dependencies = entry.value("dependencies", nlohmann::json::object());
+			for (const auto& [dependency, info] : dependencies.items())
+				record.dependencies.emplace_back(dependency, SourceFromJson(info));
+
+			records[source] = std::move(record);
+		}
+
+		return true;
+	}
+
+	bool CookDatabase::Save(const std::filesystem::path& path) const
+	{
+		nlohmann::json recordsJson = nlohmann::json::object();
+		for (const auto& [source, record] : records)
+		{
+			nlohmann::json dependencies = nlohmann::json::object();
+			for (const auto& [dependency, info] : record.dependencies)
+				dependencies[dependency] = SourceToJson(info);
+
+			recordsJson[source] = {
+				{ "source", SourceToJson(record.source) },
+				{ "settings", record.settingsHash },
+				{ "output", record.output },
+				{ "dependencies", dependencies }
+			};
+		}
+
+		nlohmann::json json = { { "version", DatabaseVersion }, { "records", recordsJson } };
+
+		// Replaced in one step, an interrupted save leaves the previous database
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ".tmp";
+
+		{
+			std::ofstream file(temporaryPath, std::ios::trunc);
+			if (!file.is_open())
+			{
+				std::cerr << "Failed to open cook database for writing at " << temporaryPath.string() << std::endl;
+				return false;
+			}
+
+			file << json.dump(1, '\t');
+			if (!file.good())
+				return false;
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error)
+		{
+			std::cerr << "Failed to save cook database at " << path.string() << ": " << error.message() << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	const CookRecord* CookDatabase::Find(const std::string& source) const
+	{
+		auto it = records.find(source);
+		return it != records.end() ? &it->second : nullptr;
+	}
+
+	void CookDatabase::Set(const std::string& source, const CookRecord& record)
+	{
+		records[source] = record;
+	}
+
+	void CookDatabase::Remove(const std::string& source)
+	{
+		records.erase(source);
+	}
+
+	const std::unordered_map<std::string, CookRecord>& CookDatabase::GetRecords() const
+	{
+		return records;
+	}
+}
\ No newline at end of file
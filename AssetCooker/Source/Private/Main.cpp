@@ -0,0 +1,79 @@
+#include "AssetCooker.h"
+#include "SceneBenchmark.h"
+
+#include "Core/JobSystem.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace Nightbird;
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::cout << "Usage: AssetCooker <source directory> [output directory] [--force] [--no-optimize] [--no-lods] [--import-stats] [--threads <count>]" << std::endl;
+		std::cout << "Without an output directory the cooked files are written next to their sources" << std::endl;
+		std::cout << "       AssetCooker --benchmark-scene <object count> [directory]" << std::endl;
+		std::cout << "Compares JSON and binary scene loads on a synthetic scene written to the directory" << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::filesystem::path sourceRoot;
+	std::filesystem::path outputRoot;
+	CookSettings settings;
+	size_t threadCount = 0;
+	size_t benchmarkObjectCount = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--force")
+			settings.force = true;
+		else if (argument == "--no-optimize")
+			settings.model.optimizeMeshes = false;
+		else if (argument == "--no-lods")
+			settings.model.generateLods = false;
+		else if (argument == "--import-stats")
+			settings.reportImportStats = true;
+		else if (argument == "--threads" && i + 1 < argc)
+			threadCount = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (argument == "--benchmark-scene" && i + 1 < argc)
+			benchmarkObjectCount = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (argument == "--help" || argument == "-h")
+		{
+			PrintUsage();
+			return 0;
+		}
+		else if (sourceRoot.empty())
+			sourceRoot = argument;
+		else if (outputRoot.empty())
+			outputRoot = argument;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (benchmarkObjectCount > 0)
+		return RunSceneBenchmark(benchmarkObjectCount, sourceRoot.empty() ? std::filesystem::current_path() : sourceRoot) ? 0 : 1;
+
+	if (sourceRoot.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (outputRoot.empty())
+		outputRoot = sourceRoot;
+
+	JobSystem jobSystem(threadCount);
+
+	AssetCooker cooker(&jobSystem, sourceRoot, outputRoot, settings);
+	return cooker.Run() ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "SceneBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "Core/GlmRegistration.h"
+#include "Core/PrefabInstance.h"
+#include "Core/SceneBinary.h"
+#include "Core/SceneObject.h"
+#include "Core/SpatialObject.h"
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr size_t GroupSize = 100;
+		constexpr int RunCount = 3;
+
+		// Groups of spatial objects under the root, every tenth object a prefab instance
+		void BuildScene(SceneObject& root, size_t objectCount)
+		{
+			SceneObject* group = &root;
+
+			for (size_t i = 0; i < objectCount; ++i)
+			{
+				std::unique_ptr<SpatialObject> object;
+				if (i % 10 == 5)
+					object = std::make_unique<PrefabInstance>("Prefab" + std::to_string(i), "Assets/Models/Model" + std::to_string(i % 7) + ".glb");
+				else
+					object = std::make_unique<SpatialObject>("Object" + std::to_string(i));
+
+				float offset = static_cast<float>(i);
+				object->SetPosition(glm::vec3(offset, offset * 0.5f, -offset));
+				object->SetScale(glm::vec3(1.0f + (i % 3)));
+				object->layers = static_cast<uint32_t>(i);
+
+				SpatialObject* rawObject = object.get();
+				if (i % GroupSize == 0)
+				{
+					root.AddChild(std::move(object));
+					group = rawObject;
+				}
+				else
+				{
+					group->AddChild(std::move(object));
+				}
+			}
+		}
+
+		bool LoadJson(const std::filesystem::path& path, SceneObject& root)
+		{
+			std::ifstream is(path);
+			if (!is.is_open())
+				return false;
+
+			nlohmann::json json;
+			is >> json;
+			root.Deserialize(json);
+			return true;
+		}
+
+		double ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	bool RunSceneBenchmark(size_t objectCount, const std::filesystem::path& directory)
+	{
+		GlmRegistration();
+
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+
+		std::filesystem::path jsonPath = directory / "SceneBenchmark.tscene";
+		std::filesystem::path binaryPath = directory / "SceneBenchmark.scene";
+
+		SceneObject source("Root");
+		BuildScene(source, objectCount);
+
+		nlohmann::json sourceJson;
+		source.Serialize(sourceJson);
+
+		{
+			std::ofstream os(jsonPath);
+			if (!os.is_open())
+			{
+				std::cerr << "Failed to write " << jsonPath.string() << std::endl;
+				return false;
+			}
+
+			os << sourceJson.dump(4);
+		}
+
+		if (!SaveSceneBinary(source, binaryPath.string()))
+			return false;
+
+		// Best of a few runs, each into a fresh root like a scene load
+		double jsonMilliseconds = 0.0;
+		double binaryMilliseconds = 0.0;
+		bool identical = true;
+
+		for (int run = 0; run < RunCount; ++run)
+		{
+			SceneObject jsonRoot("Root");
+			auto jsonStart = std::chrono::steady_clock::now();
+			if (!LoadJson(jsonPath, jsonRoot))
+				return false;
+			double jsonTime = ElapsedMilliseconds(jsonStart);
+
+			SceneObject binaryRoot("Root");
+			auto binaryStart = std::chrono::steady_clock::now();
+			if (!LoadSceneBinary(binaryPath.string(), binaryRoot))
+				return false;
+			double binaryTime = ElapsedMilliseconds(binaryStart);
+
+			jsonMilliseconds = run == 0 ? jsonTime : std::min(jsonMilliseconds, jsonTime);
+			binaryMilliseconds = run == 0 ? binaryTime : std::min(binaryMilliseconds, binaryTime);
+
+			if (run == 0)
+			{
+				nlohmann::json jsonReload;
+				nlohmann::json binaryReload;
+				jsonRoot.Serialize(jsonReload);
+				binaryRoot.Serialize(binaryReload);
+				identical = jsonReload == sourceJson && binaryReload == sourceJson;
+			}
+		}
+
+		std::cout << "Scene benchmark, " << objectCount << " objects" << std::endl;
+		std::cout << "JSON:   " << std::filesystem::file_size(jsonPath, error) / 1024 << " KB, loaded in " << jsonMilliseconds << " ms" << std::endl;
+		std::cout << "Binary: " << std::filesystem::file_size(binaryPath, error) / 1024 << " KB, loaded in " << binaryMilliseconds << " ms" << std::endl;
+		std::cout << "Binary loads " << jsonMilliseconds / binaryMilliseconds << "x faster" << std::endl;
+
+		std::filesystem::remove(jsonPath, error);
+		std::filesystem::remove(binaryPath, error);
+
+		if (!identical)
+			std::cerr << "Reloaded scenes differ from the saved one" << std::endl;
+
+		return identical;
+	}
+}
\ No newline at end of file
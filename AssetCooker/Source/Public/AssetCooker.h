@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Core/ModelImporter.h"
+#include "CookDatabase.h"
+
+namespace Nightbird
+{
+	class JobSystem;
+
+	struct CookSettings
+	{
+		ModelImportSettings model;
+
+		// Ignores the database and cooks every source
+		bool force = false;
+
+		// Prints the accessor read throughput of every cooked model
+		bool reportImportStats = false;
+	};
+
+	// Turns a source asset tree into cooked runtime files. Outputs mirror the source tree and sit under their source name
+	// plus the cooked extension, so the runtime finds them by the path it would have loaded the source from
+	class AssetCooker
+	{
+	public:
+		AssetCooker(JobSystem* jobSystem, const std::filesystem::path& sourceRoot, const std::filesystem::path& outputRoot, const CookSettings& settings);
+
+		// Returns false when any asset failed to cook
+		bool Run();
+
+	private:
+		enum class AssetType
+		{
+			Model,
+			Texture
+		};
+
+		enum class CookResult
+		{
+			UpToDate,
+			Cooked,
+			Failed
+		};
+
+		struct CookItem
+		{
+			std::string key;
+			std::filesystem::path source;
+			std::filesystem::path output;
+			AssetType type;
+
+			CookRecord record;
+			CookResult result = CookResult::Failed;
+		};
+
+		JobSystem* jobSystem;
+		std::filesystem::path sourceRoot;
+		std::filesystem::path outputRoot;
+		CookSettings settings;
+
+		ModelImporter importer;
+		CookDatabase database;
+
+		std::vector<CookItem> GatherSources() const;
+
+		// Hash of everything besides the source that changes the output
+		uint64_t GetSettingsHash(AssetType type) const;
+
+		// Compares against the database record, refreshing its write times when only a touch changed them
+		bool IsUpToDate(const CookItem& item, CookRecord& record) const;
+
+		bool CookModel(CookItem& item) const;
+		bool CookTexture(CookItem& item) const;
+	};
+}
\ No newline at end of file
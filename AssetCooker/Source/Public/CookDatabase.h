@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/CookedModel.h"
+
+namespace Nightbird
+{
+	// Everything a cooked output was built from, keyed by path relative to the source root
+	struct CookRecord
+	{
+		CookedSourceInfo source;
+		uint64_t settingsHash = 0;
+		std::string output;
+
+		// Files the source pulls in, e.g. the buffers and images of a .gltf
+		std::vector<std::pair<std::string, CookedSourceInfo>> dependencies;
+	};
+
+	class CookDatabase
+	{
+	public:
+		// A missing file is an empty database, so the first run cooks everything
+		bool Load(const std::filesystem::path& path);
+		bool Save(const std::filesystem::path& path) const;
+
+		// Null when the source was never cooked
+		const CookRecord* Find(const std::string& source) const;
+
+		void Set(const std::string& source, const CookRecord& record);
+		void Remove(const std::string& source);
+
+		const std::unordered_map<std::string, CookRecord>& GetRecords() const;
+
+	private:
+		std::unordered_map<std::string, CookRecord> records;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace Nightbird
+{
+	// Builds a synthetic object tree, saves it as a JSON and a binary scene in directory and times loading each back.
+	// The JSON side is the parse and SceneObject::Deserialize of Scene::LoadSceneJSON, the binary side LoadSceneBinary.
+	// The prefab model loads both formats start afterwards are left out. Returns false when either reload differs
+	bool RunSceneBenchmark(size_t objectCount, const std::filesystem::path& directory);
+}
\ No newline at end of file
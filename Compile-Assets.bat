@@ -46,6 +46,17 @@ xcopy /E /I /Y "%editor_source%" "%editor_destination%"
 echo Moving App assets to Editor build
 xcopy /E /I /Y "%app_source%" "%editor_destination%"
 
+set cooker=out\bin\%config%-windows-x86_64\AssetCooker\AssetCooker.exe
+
+if exist "%cooker%" (
+	echo Cooking App assets
+	"%cooker%" "%app_destination%"
+	echo Cooking Editor assets
+	"%cooker%" "%editor_destination%"
+) else (
+	echo AssetCooker not built, models and textures will be imported at runtime
+)
+
 echo Checking App Shaders...
 if exist "%app_destination%\Shaders\Compile.bat" (
 	echo Compiling App shaders
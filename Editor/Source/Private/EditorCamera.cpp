@@ -12,6 +12,8 @@ namespace Nightbird
 	{
 		auto& input = Input::Get();
 
+		const Transform& transform = GetTransform();
+
 		glm::vec3 forward = transform.rotation * glm::vec3(0.0f, 0.0f, -1.0f);
 		glm::vec3 right = transform.rotation * glm::vec3(1.0f, 0.0f, 0.0f);
 		glm::vec3 up = transform.rotation * glm::vec3(0.0f, 1.0f, 0.0f);
@@ -31,7 +33,7 @@ namespace Nightbird
 		if (input.IsKeyPressed(GLFW_KEY_E))
 			movementDir += up;
 
-		transform.position += movementDir * movementSpeed * delta;
+		SetPosition(transform.position + movementDir * movementSpeed * delta);
 		
 		double mouseX, mouseY;
 		input.GetCursorPos(mouseX, mouseY);
@@ -48,7 +50,7 @@ namespace Nightbird
 		glm::quat pitchQuat = glm::angleAxis(pitchDelta, right);
 		glm::quat yawQuat = glm::angleAxis(yawDelta, glm::vec3(0.0f, 1.0f, 0.0f));
 
-		transform.rotation = glm::normalize(yawQuat * pitchQuat * transform.rotation);
+		SetRotation(glm::normalize(yawQuat * pitchQuat * transform.rotation));
 	}
 
 	void EditorCamera::SetLastMousePos(double x, double y)
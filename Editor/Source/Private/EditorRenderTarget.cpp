@@ -37,7 +37,7 @@ namespace Nightbird
 			sceneWindow->GetColorTexture()->TransitionToColor(commandBuffer);
 			
 			sceneWindow->BeginRenderPass(commandBuffer);
-			renderer->DrawScene(scene, sceneWindow->GetEditorCamera(), commandBuffer, sceneWindow->GetExtent());
+			renderer->DrawScene(scene, sceneWindow->GetEditorCamera(), commandBuffer, sceneWindow->GetRenderPass(), sceneWindow->GetFramebuffer(), sceneWindow->GetOitTargets(), sceneWindow->GetDepthTexture()->GetImage(), sceneWindow->GetExtent(), renderSettings);
 			sceneWindow->EndRenderPass(commandBuffer);
 
 			sceneWindow->GetColorTexture()->TransitionToShaderRead(commandBuffer);
@@ -72,6 +72,12 @@ namespace Nightbird
 				if (ImGui::DragInt(label.c_str(), &intValue))
 					property.set_value(instance, intValue);
 			}
+			else if (valueType == rttr::type::get<uint32_t>())
+			{
+				uint32_t uintValue = value.get_value<uint32_t>();
+				if (ImGui::InputScalar(label.c_str(), ImGuiDataType_U32, &uintValue, nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal))
+					property.set_value(instance, uintValue);
+			}
 			else if (valueType == rttr::type::get<float>())
 			{
 				float floatValue = value.get_value<float>();
@@ -47,7 +47,8 @@ namespace Nightbird
 
 		ImGui::Text("Instantiate model from path.");
 
-		for (const auto& [path, model] : m_ModelManager->GetModels())
+		auto snapshot = m_ModelManager->GetModels();
+		for (const auto& [path, model] : *snapshot)
 		{
 			if (ImGui::Selectable(path.c_str(), selectedModel == path, 0, ImVec2(0.0f, 30.0f)))
 				selectedModel = path;
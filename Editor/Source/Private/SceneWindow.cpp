@@ -2,14 +2,20 @@
 
 #include <array>
 #include <iostream>
+#include <string>
 
 #include <ImGuizmo.h>
 
 #include "Vulkan/Device.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/Texture.h"
+#include "Vulkan/OitTargets.h"
+#include "Vulkan/DescriptorSetLayoutManager.h"
+#include "Vulkan/DescriptorPool.h"
 #include "Core/Engine.h"
+#include "Core/Renderer.h"
 #include "Core/Scene.h"
+#include "Core/JobSystem.h"
 #include "Core/MeshInstance.h"
 #include "EditorUI.h"
 #include "EditorCamera.h"
@@ -42,11 +48,26 @@ namespace Nightbird
 		return colorTexture;
 	}
 
+	VulkanTexture* SceneWindow::GetDepthTexture() const
+	{
+		return depthTexture;
+	}
+
 	VkFramebuffer SceneWindow::GetFramebuffer() const
 	{
 		return framebuffer;
 	}
 
+	VulkanRenderPass* SceneWindow::GetRenderPass() const
+	{
+		return renderPass.get();
+	}
+
+	VulkanOitTargets* SceneWindow::GetOitTargets() const
+	{
+		return oitTargets;
+	}
+
 	VkExtent2D SceneWindow::GetExtent() const
 	{
 		return extent;
@@ -120,6 +141,33 @@ namespace Nightbird
 
 		ImGui::Image(imGuiTextureId, ImVec2((float)extent.width, (float)extent.height));
 
+		// Gizmo hover state is from the previous frame, close enough to keep clicks on handles from reselecting
+		if (ImGui::IsItemClicked(ImGuiMouseButton_Left) && !ImGuizmo::IsOver() && !ImGuizmo::IsUsing())
+		{
+			ImVec2 mouse = ImGui::GetMousePos();
+			PickObject(glm::vec2(mouse.x - pos.x, mouse.y - pos.y), glm::vec2(size.x, size.y));
+		}
+
+		// Culling rate of the last scene draw
+		const RenderStats& renderStats = engine->GetRenderer()->GetRenderStats();
+		std::string drawStats = "Draws: " + std::to_string(renderStats.visibleDraws) + " / " + std::to_string(renderStats.totalDraws);
+		if (renderStats.occludedDraws > 0)
+			drawStats += "  Occluded: " + std::to_string(renderStats.occludedDraws);
+		if (renderStats.gpuOccludedDraws > 0)
+			drawStats += "  GPU occluded: " + std::to_string(renderStats.gpuOccludedDraws);
+		drawStats += "  Tris: " + std::to_string(renderStats.drawnTriangles);
+		if (renderStats.lodTrianglesSaved > 0)
+			drawStats += " (LOD saved " + std::to_string(renderStats.lodTrianglesSaved) + ")";
+
+		// Average worker load, only shown while jobs are running
+		const auto& workerStats = engine->GetJobSystem()->GetWorkerStats();
+		float utilization = 0.0f;
+		for (const JobWorkerStats& worker : workerStats)
+			utilization += worker.utilization;
+		if (!workerStats.empty() && utilization > 0.0f)
+			drawStats += "  Jobs: " + std::to_string(static_cast<int>(utilization * 100.0f / workerStats.size())) + "%";
+		ImGui::GetWindowDrawList()->AddText(ImVec2(pos.x + 8.0f, pos.y + 8.0f), IM_COL32(255, 255, 255, 255), drawStats.c_str());
+
 		ImGuizmo::SetOrthographic(false);
 		ImGuizmo::SetDrawlist(ImGui::GetWindowDrawList());
 		
@@ -158,26 +206,60 @@ namespace Nightbird
 
 			ImGuizmo::DecomposeMatrixToComponents(glm::value_ptr(model), &translation[0], &eulerDegrees[0], &scale[0]);
 			
-			selectedSpatialObject->transform.position = translation;
+			Transform transform = selectedSpatialObject->GetTransform();
+			transform.position = translation;
 
-			selectedSpatialObject->transform.eulerCache = eulerDegrees;
-			selectedSpatialObject->transform.rotation = glm::quat(glm::radians(eulerDegrees));
+			transform.eulerCache = eulerDegrees;
+			transform.rotation = glm::quat(glm::radians(eulerDegrees));
 
-			selectedSpatialObject->transform.scale = scale;
+			transform.scale = scale;
+			selectedSpatialObject->SetTransform(transform);
 		}
 	}
 
+	void SceneWindow::PickObject(const glm::vec2& cursor, const glm::vec2& viewportSize)
+	{
+		if (viewportSize.x <= 0.0f || viewportSize.y <= 0.0f)
+			return;
+
+		// Unproject the cursor on the near and far planes (OpenGL depth range, y up)
+		glm::vec2 ndc = glm::vec2(cursor.x / viewportSize.x * 2.0f - 1.0f, 1.0f - cursor.y / viewportSize.y * 2.0f);
+		glm::mat4 inverseViewProjection = glm::inverse(editorCamera->GetProjectionMatrix(viewportSize.x, viewportSize.y) * editorCamera->GetViewMatrix());
+
+		glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+		nearPoint /= nearPoint.w;
+		farPoint /= farPoint.w;
+
+		glm::vec3 origin = glm::vec3(nearPoint);
+		glm::vec3 direction = glm::vec3(farPoint) - origin;
+		float length = glm::length(direction);
+		if (length <= 0.0f)
+			return;
+
+		SpatialQueryHit hit;
+		if (engine->GetScene()->Raycast(origin, direction / length, length, hit, SpatialCategory::MeshInstance))
+			editorUI->SelectObject(hit.object);
+		else
+			editorUI->SelectObject(nullptr);
+	}
+
 	void SceneWindow::CreateRenderResources()
 	{
 		colorTexture = new VulkanTexture(device, extent.width, extent.height, colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
 		imGuiTextureId = reinterpret_cast<ImTextureID>(ImGui_ImplVulkan_AddTexture(colorTexture->GetSampler(), colorTexture->GetImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
 
-		depthTexture = new VulkanTexture(device, extent.width, extent.height, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+		depthTexture = new VulkanTexture(device, extent.width, extent.height, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
 
-		std::array<VkImageView, 2> attachments =
+		Renderer* renderer = engine->GetRenderer();
+		oitTargets = new VulkanOitTargets(device, extent.width, extent.height, renderer->GetDescriptorSetLayoutManager()->GetOitCompositeDescriptorSetLayout(), renderer->GetDescriptorPool()->Get());
+
+		std::array<VkImageView, 4> attachments =
 		{
 			colorTexture->GetImageView(),
-			depthTexture->GetImageView()
+			depthTexture->GetImageView(),
+			oitTargets->GetAccumImageView(),
+			oitTargets->GetRevealageImageView()
 		};
 
 		VkFramebufferCreateInfo framebufferInfo{};
@@ -212,6 +294,11 @@ namespace Nightbird
 			delete depthTexture;
 			depthTexture = nullptr;
 		}
+		if (oitTargets)
+		{
+			delete oitTargets;
+			oitTargets = nullptr;
+		}
 		if (framebuffer != VK_NULL_HANDLE)
 		{
 			vkDestroyFramebuffer(device->GetLogical(), framebuffer, nullptr);
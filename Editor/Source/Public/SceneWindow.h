@@ -8,12 +8,15 @@
 
 #include <volk.h>
 
+#include <glm/glm.hpp>
+
 namespace Nightbird
 {
 	class VulkanDevice;
 	class VulkanRenderPass;
 	class VulkanTexture;
 	class VulkanRenderPass;
+	class VulkanOitTargets;
 	class Scene;
 	class Engine;
 	class EditorUI;
@@ -28,8 +31,11 @@ namespace Nightbird
 		EditorCamera* GetEditorCamera() const;
 
 		VulkanTexture* GetColorTexture() const;
+		VulkanTexture* GetDepthTexture() const;
 
 		VkFramebuffer GetFramebuffer() const;
+		VulkanRenderPass* GetRenderPass() const;
+		VulkanOitTargets* GetOitTargets() const;
 		VkExtent2D GetExtent() const;
 		
 		void BeginRenderPass(VkCommandBuffer commandBuffer);
@@ -41,6 +47,9 @@ namespace Nightbird
 
 	protected:
 		void OnRender() override;
+
+		// Selects the closest mesh instance under the cursor, or clears the selection
+		void PickObject(const glm::vec2& cursor, const glm::vec2& viewportSize);
 		
 		void CreateRenderResources();
 		void CleanupRenderResources();
@@ -58,6 +67,8 @@ namespace Nightbird
 		VulkanTexture* colorTexture = nullptr;
 		VulkanTexture* depthTexture = nullptr;
 
+		VulkanOitTargets* oitTargets = nullptr;
+
 		std::unique_ptr<VulkanRenderPass> renderPass;
 
 		VkFramebuffer framebuffer = VK_NULL_HANDLE;
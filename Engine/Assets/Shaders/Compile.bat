@@ -1,2 +1,8 @@
 "glslc.exe" Shader.vert -o Vert.spv
-"glslc.exe" Shader.frag -o Frag.spv
\ No newline at end of file
+"glslc.exe" Shader.frag -o Frag.spv
+"glslc.exe" Depth.vert -o DepthVert.spv
+"glslc.exe" -DOIT Shader.frag -o FragOit.spv
+"glslc.exe" Fullscreen.vert -o FullscreenVert.spv
+"glslc.exe" OitComposite.frag -o OitCompositeFrag.spv
+"glslc.exe" DepthReduce.comp -o DepthReduceComp.spv
+"glslc.exe" OcclusionCull.comp -o OcclusionCullComp.spv
\ No newline at end of file
@@ -1,2 +1,8 @@
 ./glslc Shader.vert -o Vert.spv
 ./glslc Shader.frag -o Frag.spv
+./glslc Depth.vert -o DepthVert.spv
+./glslc -DOIT Shader.frag -o FragOit.spv
+./glslc Fullscreen.vert -o FullscreenVert.spv
+./glslc OitComposite.frag -o OitCompositeFrag.spv
+./glslc DepthReduce.comp -o DepthReduceComp.spv
+./glslc OcclusionCull.comp -o OcclusionCullComp.spv
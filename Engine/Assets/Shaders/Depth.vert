@@ -0,0 +1,34 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform CameraUBO
+{
+	mat4 view;
+	mat4 projection;
+	vec4 position;
+} cameraUBO;
+
+layout(set = 1, binding = 0) uniform MeshUBO
+{
+	mat4 model;
+	uvec4 pointLightIndices[2];
+	uint pointLightCount;
+} meshUBO;
+
+// Position dequantization of the drawn primitive, see VertexDecode
+layout(push_constant) uniform VertexDecode
+{
+	vec4 positionOffset;
+	vec4 positionScale;
+} vertexDecode;
+
+layout(location = 0) in vec4 inPosition;
+
+// Must match Shader.vert exactly for the EQUAL depth test of the color pass
+invariant gl_Position;
+
+void main()
+{
+	vec3 position = vertexDecode.positionOffset.xyz + inPosition.xyz * vertexDecode.positionScale.xyz;
+	vec4 worldPosition = meshUBO.model * vec4(position, 1.0);
+	gl_Position = cameraUBO.projection * cameraUBO.view * worldPosition;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 450
+
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput accumInput;
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput revealageInput;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	float revealage = subpassLoad(revealageInput).r;
+
+	// No transparent surface covered this pixel
+	if (revealage >= 1.0)
+		discard;
+
+	vec4 accum = subpassLoad(accumInput);
+	vec3 averageColor = accum.rgb / max(accum.a, 0.00001);
+
+	outColor = vec4(averageColor, 1.0 - revealage);
+}
\ No newline at end of file
@@ -37,8 +37,35 @@ layout (std430, set = 0, binding = 3) readonly buffer PointLights
 layout (set = 0, binding = 4) uniform PointLightMeta
 {
 	uint count;
+	uint perObjectLights;
 } pointLightMeta;
 
+// x: offset into lightIndices, y: light count
+layout (std430, set = 0, binding = 5) readonly buffer LightClusters
+{
+	uvec2 lightClusters[];
+};
+
+layout (std430, set = 0, binding = 6) readonly buffer LightIndices
+{
+	uint lightIndices[];
+};
+
+layout (set = 0, binding = 7) uniform LightClusterMeta
+{
+	uvec4 gridSize;
+	vec4 tileSize;
+	vec4 depthParams;
+} clusterMeta;
+
+// Per object light list, used instead of the clusters when pointLightMeta.perObjectLights is set
+layout(set = 1, binding = 0) uniform MeshUBO
+{
+	mat4 model;
+	uvec4 pointLightIndices[2];
+	uint pointLightCount;
+} meshUBO;
+
 layout(set = 2, binding = 0) uniform MaterialFactorsUBO
 {
 	vec4 baseColor;
@@ -56,13 +83,28 @@ layout(location = 2) in vec2 fragBaseColorTexCoord;
 layout(location = 3) in vec2 fragMetallicRoughnessTexCoord;
 layout(location = 4) in vec2 fragNormalTexCoord;
 
+// Permutation switches set per pipeline variant (see ShaderVariant.h), disabled paths are compiled out
+layout(constant_id = 0) const bool HAS_BASE_COLOR_TEXTURE = true;
+layout(constant_id = 1) const bool HAS_METALLIC_ROUGHNESS_TEXTURE = true;
+layout(constant_id = 2) const bool HAS_DIRECTIONAL_LIGHTS = true;
+layout(constant_id = 3) const bool HAS_POINT_LIGHTS = true;
+
+#ifdef OIT
+layout(location = 0) out vec4 outAccum;
+layout(location = 1) out float outRevealage;
+#else
 layout(location = 0) out vec4 outColor;
+#endif
 
 void main()
 {
-	vec4 baseColor = texture(baseColorSampler, fragBaseColorTexCoord) * factorsUBO.baseColor;
+	vec4 baseColor = factorsUBO.baseColor;
+	if (HAS_BASE_COLOR_TEXTURE)
+		baseColor *= texture(baseColorSampler, fragBaseColorTexCoord);
 
-	vec4 metallicRoughness = texture(metallicRoughnessSampler, fragMetallicRoughnessTexCoord);
+	vec4 metallicRoughness = vec4(1.0);
+	if (HAS_METALLIC_ROUGHNESS_TEXTURE)
+		metallicRoughness = texture(metallicRoughnessSampler, fragMetallicRoughnessTexCoord);
 	float metallic = metallicRoughness.b * factorsUBO.metallicRoughness.b;
 	float roughness = metallicRoughness.g * factorsUBO.metallicRoughness.g;
 
@@ -75,7 +117,9 @@ void main()
 
 	vec3 color = vec3(0.0);
 
-	for (uint i = 0; i < directionalLightMeta.count; ++i)
+	uint directionalLightCount = HAS_DIRECTIONAL_LIGHTS ? directionalLightMeta.count : 0u;
+
+	for (uint i = 0; i < directionalLightCount; ++i)
 	{
 		DirectionalLight light = directionalLights[i];
 		vec3 lightDir = normalize(-light.direction.xyz);
@@ -94,9 +138,27 @@ void main()
 		color += (diffuse + specular) * lightColor * intensity;
 	}
 
-	for (uint i = 0; i < pointLightMeta.count; ++i)
+	bool perObjectLights = pointLightMeta.perObjectLights != 0u;
+	uvec2 lightRange = uvec2(0u, meshUBO.pointLightCount);
+
+	if (HAS_POINT_LIGHTS && !perObjectLights)
+	{
+		float viewDepth = -(cameraUBO.view * vec4(fragWorldPos, 1.0)).z;
+
+		uvec3 cluster;
+		cluster.xy = min(uvec2(gl_FragCoord.xy / clusterMeta.tileSize.xy), clusterMeta.gridSize.xy - 1u);
+		cluster.z = uint(clamp(log(max(viewDepth, clusterMeta.depthParams.z)) * clusterMeta.depthParams.x + clusterMeta.depthParams.y, 0.0, float(clusterMeta.gridSize.z - 1u)));
+
+		uint clusterIndex = cluster.x + cluster.y * clusterMeta.gridSize.x + cluster.z * clusterMeta.gridSize.x * clusterMeta.gridSize.y;
+		lightRange = lightClusters[clusterIndex];
+	}
+
+	uint lightCount = HAS_POINT_LIGHTS ? lightRange.y : 0u;
+
+	for (uint i = 0; i < lightCount; ++i)
 	{
-		PointLight light = pointLights[i];
+		uint lightIndex = perObjectLights ? meshUBO.pointLightIndices[i / 4u][i % 4u] : lightIndices[lightRange.x + i];
+		PointLight light = pointLights[lightIndex];
 		vec3 lightPos = light.positionRadius.xyz;
 		float radius = light.positionRadius.w;
 		vec3 lightColor = light.colorIntensity.rgb;
@@ -128,5 +190,15 @@ void main()
 	color *= baseColor.rgb;
 	
 	vec3 gammaCorrected = pow(color, vec3(1.0 / 2.2));
+
+#ifdef OIT
+	// Weighted blended OIT (McGuire and Bavoil), favouring opaque-ish surfaces close to the camera
+	float alpha = baseColor.a;
+	float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+
+	outAccum = vec4(gammaCorrected * alpha, alpha) * weight;
+	outRevealage = alpha;
+#else
 	outColor = vec4(gammaCorrected, baseColor.a);
+#endif
 }
\ No newline at end of file
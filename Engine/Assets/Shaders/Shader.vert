@@ -10,10 +10,20 @@ layout(set = 0, binding = 0) uniform CameraUBO
 layout(set = 1, binding = 0) uniform MeshUBO
 {
 	mat4 model;
+	uvec4 pointLightIndices[2];
+	uint pointLightCount;
 } meshUBO;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+// Position dequantization of the drawn primitive, see VertexDecode
+layout(push_constant) uniform VertexDecode
+{
+	vec4 positionOffset;
+	vec4 positionScale;
+} vertexDecode;
+
+layout(location = 0) in vec4 inPosition;
+// Octahedral encoded
+layout(location = 1) in vec2 inNormal;
 layout(location = 2) in vec2 inBaseColorTexCoord;
 layout(location = 3) in vec2 inMetallicRoughnessTexCoord;
 layout(location = 4) in vec2 inNormalTexCoord;
@@ -25,13 +35,26 @@ layout(location = 2) out vec2 fragBaseColorTexCoord;
 layout(location = 3) out vec2 fragMetallicRoughnessTexCoord;
 layout(location = 4) out vec2 fragNormalTexCoord;
 
+// Keeps depth identical to Depth.vert when drawing after the depth pre-pass
+invariant gl_Position;
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0);
+	normal.x += normal.x >= 0.0 ? -fold : fold;
+	normal.y += normal.y >= 0.0 ? -fold : fold;
+	return normalize(normal);
+}
+
 void main()
 {
-	vec4 worldPosition = meshUBO.model * vec4(inPosition, 1.0);
+	vec3 position = vertexDecode.positionOffset.xyz + inPosition.xyz * vertexDecode.positionScale.xyz;
+	vec4 worldPosition = meshUBO.model * vec4(position, 1.0);
 	fragWorldPos = worldPosition.xyz;
 	
 	mat3 normalMat = transpose(inverse(mat3(meshUBO.model)));
-	fragNormal = normalize(normalMat * inNormal);
+	fragNormal = normalize(normalMat * DecodeOctahedral(inNormal));
 	
 	gl_Position = cameraUBO.projection * cameraUBO.view * worldPosition;
 	fragBaseColorTexCoord = inBaseColorTexCoord;
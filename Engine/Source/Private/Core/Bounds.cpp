@@ -0,0 +1,170 @@
+#include "Core/Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Nightbird
+{
+	bool AABB::IsValid() const
+	{
+		return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+	}
+
+	void AABB::Expand(const glm::vec3& point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void AABB::Expand(const AABB& other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+
+	glm::vec3 AABB::GetCenter() const
+	{
+		return (min + max) * 0.5f;
+	}
+
+	glm::vec3 AABB::GetExtents() const
+	{
+		return (max - min) * 0.5f;
+	}
+
+	AABB AABB::Transform(const glm::mat4& matrix) const
+	{
+		if (!IsValid())
+			return *this;
+
+		// Transform the center and project the extents onto the absolute basis
+		glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+		glm::vec3 extents = GetExtents();
+
+		glm::mat3 absolute = glm::mat3(glm::abs(glm::vec3(matrix[0])), glm::abs(glm::vec3(matrix[1])), glm::abs(glm::vec3(matrix[2])));
+		glm::vec3 worldExtents = absolute * extents;
+
+		AABB result;
+		result.min = center - worldExtents;
+		result.max = center + worldExtents;
+		return result;
+	}
+
+	float AABB::DistanceSquared(const glm::vec3& point) const
+	{
+		glm::vec3 delta = glm::max(glm::max(min - point, point - max), glm::vec3(0.0f));
+		return glm::dot(delta, delta);
+	}
+
+	bool AABB::Intersects(const AABB& other) const
+	{
+		return min.x <= other.max.x && max.x >= other.min.x &&
+			min.y <= other.max.y && max.y >= other.min.y &&
+			min.z <= other.max.z && max.z >= other.min.z;
+	}
+
+	bool BoundingSphere::IsValid() const
+	{
+		return radius >= 0.0f;
+	}
+
+	void BoundingSphere::Expand(const BoundingSphere& other)
+	{
+		if (!other.IsValid())
+			return;
+
+		if (!IsValid())
+		{
+			*this = other;
+			return;
+		}
+
+		glm::vec3 delta = other.center - center;
+		float distance = glm::length(delta);
+
+		// One sphere already contains the other
+		if (distance + other.radius <= radius)
+			return;
+
+		if (distance + radius <= other.radius)
+		{
+			*this = other;
+			return;
+		}
+
+		float newRadius = (distance + radius + other.radius) * 0.5f;
+		center += delta * ((newRadius - radius) / distance);
+		radius = newRadius;
+	}
+
+	BoundingSphere BoundingSphere::Transform(const glm::mat4& matrix) const
+	{
+		if (!IsValid())
+			return *this;
+
+		float scaleSquared = std::max({ glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])), glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])), glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2])) });
+
+		BoundingSphere result;
+		result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+		result.radius = radius * std::sqrt(scaleSquared);
+		return result;
+	}
+
+	BoundingSphere BoundingSphere::FromAABB(const AABB& aabb)
+	{
+		BoundingSphere sphere;
+		if (!aabb.IsValid())
+			return sphere;
+
+		sphere.center = aabb.GetCenter();
+		sphere.radius = glm::length(aabb.GetExtents());
+		return sphere;
+	}
+
+	Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+	{
+		glm::vec4 row0 = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		glm::vec4 row1 = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		glm::vec4 row2 = glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		glm::vec4 row3 = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+		Frustum frustum;
+		frustum.planes[0] = row3 + row0;
+		frustum.planes[1] = row3 - row0;
+		frustum.planes[2] = row3 + row1;
+		frustum.planes[3] = row3 - row1;
+		frustum.planes[4] = row3 + row2;
+		frustum.planes[5] = row3 - row2;
+
+		for (glm::vec4& plane : frustum.planes)
+			plane /= glm::length(glm::vec3(plane));
+
+		return frustum;
+	}
+
+	bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::IntersectsAABB(const AABB& aabb) const
+	{
+		glm::vec3 center = aabb.GetCenter();
+		glm::vec3 extents = aabb.GetExtents();
+
+		for (const glm::vec4& plane : planes)
+		{
+			glm::vec3 normal = glm::vec3(plane);
+			float radius = glm::dot(extents, glm::abs(normal));
+
+			if (glm::dot(normal, center) + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+}
\ No newline at end of file
@@ -15,7 +15,7 @@ namespace Nightbird
 
 	glm::mat4 Camera::GetProjectionMatrix(float width, float height) const
 	{
-		glm::mat4 proj = glm::perspective(glm::radians(fov), width / height, 0.01f, 100.0f);
+		glm::mat4 proj = glm::perspective(glm::radians(fov), width / height, nearPlane, farPlane);
 		return proj;
 	}
 
@@ -38,7 +38,9 @@ RTTR_REGISTRATION
 {
 	rttr::registration::class_<Nightbird::Camera>("Camera")
 	.constructor<std::string>()
-	.property("FOV", &Nightbird::Camera::fov);
+	.property("FOV", &Nightbird::Camera::fov)
+	.property("Near Plane", &Nightbird::Camera::nearPlane)
+	.property("Far Plane", &Nightbird::Camera::farPlane);
 
 	rttr::registration::method("CreateCamera", [](const std::string& name) -> Nightbird::SceneObject*
 	{
@@ -0,0 +1,772 @@
+#include "Core/CookedModel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <fastgltf/math.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "Core/Hash.h"
+#include "Core/MappedFile.h"
+#include "Core/Model.h"
+#include "Core/MeshPrimitive.h"
+#include "Core/TriangleBVH.h"
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr uint32_t Magic = 0x444D424E; // "NBMD"
+
+		// Every section starts on this boundary so the mapped structures can be read in place
+		constexpr uint64_t Alignment = 16;
+
+		enum MaterialFlags : uint32_t
+		{
+			MaterialTransparent = 1 << 0,
+			MaterialDoubleSided = 1 << 1,
+			MaterialBaseColorTexture = 1 << 2,
+			MaterialMetallicRoughnessTexture = 1 << 3,
+			MaterialNormalTexture = 1 << 4
+		};
+
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t sourceSize;
+			int64_t sourceWriteTime;
+			uint64_t sourceHash;
+
+			uint32_t textureCount;
+			uint32_t materialCount;
+			uint32_t meshCount;
+			uint32_t primitiveCount;
+			uint32_t nodeCount;
+			uint32_t childCount;
+			uint32_t rootCount;
+			uint32_t dependencyCount;
+
+			uint64_t texturesOffset;
+			uint64_t materialsOffset;
+			uint64_t meshesOffset;
+			uint64_t primitivesOffset;
+			uint64_t nodesOffset;
+			uint64_t childrenOffset;
+			uint64_t rootsOffset;
+			uint64_t stringsOffset;
+			uint64_t stringsSize;
+			uint64_t dependenciesOffset;
+		};
+
+		// The path lives in the string section
+		struct FileDependency
+		{
+			uint32_t pathOffset;
+			uint32_t pathLength;
+			uint64_t size;
+			int64_t writeTime;
+			uint64_t contentHash;
+		};
+
+		struct FileTexture
+		{
+			uint64_t pixelsOffset;
+			uint64_t pixelsSize;
+			uint32_t width;
+			uint32_t height;
+			uint32_t channels;
+			uint32_t sRGB;
+		};
+
+		struct FileMaterial
+		{
+			float baseColorFactor[4];
+			float metallicFactor;
+			float roughnessFactor;
+			uint32_t flags;
+			uint32_t reserved;
+			uint64_t baseColorTexture;
+			uint64_t metallicRoughnessTexture;
+			uint64_t normalTexture;
+		};
+
+		struct FileMesh
+		{
+			uint32_t firstPrimitive;
+			uint32_t primitiveCount;
+			uint64_t collisionOffset;
+			uint64_t collisionSize;
+		};
+
+		struct FilePrimitive
+		{
+			uint32_t material;
+			uint32_t indexType;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t lodCount;
+			uint32_t reserved;
+			uint64_t lodsOffset;
+
+			float boundsMin[3];
+			float boundsMax[3];
+			float sphereCenter[3];
+			float sphereRadius;
+			float positionOffset[4];
+			float positionScale[4];
+
+			uint64_t texCoordOffsets[3];
+			uint64_t vertexOffset;
+			uint64_t vertexSize;
+			uint64_t indexOffset;
+			uint64_t indexSize;
+		};
+
+		struct FileNode
+		{
+			uint32_t nameOffset;
+			uint32_t nameLength;
+			int32_t mesh;
+			uint32_t firstChild;
+			uint32_t childCount;
+			float translation[3];
+			float rotation[4];
+			float scale[3];
+		};
+
+		static_assert(sizeof(MeshLod) == 12, "MeshLod is stored verbatim in cooked models");
+
+		class FileWriter
+		{
+		public:
+			std::vector<uint8_t> bytes;
+
+			uint64_t Append(const void* data, size_t size)
+			{
+				Align();
+				uint64_t offset = bytes.size();
+				if (size > 0)
+					bytes.insert(bytes.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+				return offset;
+			}
+
+			template<typename T>
+			uint64_t Append(const std::vector<T>& items)
+			{
+				return Append(items.data(), items.size() * sizeof(T));
+			}
+
+			// Reserves space the caller fills in place, returns its offset
+			uint64_t Allocate(size_t size)
+			{
+				Align();
+				uint64_t offset = bytes.size();
+				bytes.resize(bytes.size() + size);
+				return offset;
+			}
+
+			void Align()
+			{
+				bytes.resize((bytes.size() + Alignment - 1) / Alignment * Alignment);
+			}
+		};
+
+		class FileReader
+		{
+		public:
+			FileReader(const uint8_t* data, size_t size)
+				: data(data), size(size)
+			{
+			}
+
+			// Null when the range leaves the file or breaks alignment
+			template<typename T>
+			const T* Get(uint64_t offset, uint64_t count) const
+			{
+				if (offset % alignof(T) != 0 || offset > size || count > (size - offset) / sizeof(T))
+					return nullptr;
+				return reinterpret_cast<const T*>(data + offset);
+			}
+
+			bool Contains(uint64_t offset, uint64_t length) const
+			{
+				return offset <= size && length <= size - offset;
+			}
+
+			const uint8_t* At(uint64_t offset) const
+			{
+				return data + offset;
+			}
+
+		private:
+			const uint8_t* data;
+			size_t size;
+		};
+
+		FileMaterial MakeMaterial(const MeshPrimitiveInfo& info)
+		{
+			FileMaterial material{};
+			memcpy(material.baseColorFactor, &info.baseColorFactor[0], sizeof(material.baseColorFactor));
+			material.metallicFactor = info.metallicFactor;
+			material.roughnessFactor = info.roughnessFactor;
+
+			if (info.enableTransparency)
+				material.flags |= MaterialTransparent;
+			if (info.doubleSided)
+				material.flags |= MaterialDoubleSided;
+			if (info.hasBaseColorTexture)
+			{
+				material.flags |= MaterialBaseColorTexture;
+				material.baseColorTexture = info.baseColorTextureIndex;
+			}
+			if (info.hasMetallicRoughnessTexture)
+			{
+				material.flags |= MaterialMetallicRoughnessTexture;
+				material.metallicRoughnessTexture = info.metallicRoughnessTextureIndex;
+			}
+			if (info.hasNormalTexture)
+			{
+				material.flags |= MaterialNormalTexture;
+				material.normalTexture = info.normalTextureIndex;
+			}
+
+			return material;
+		}
+
+		// The cooker only writes range checked indices, anything past the vertex count means the file was damaged
+		template<typename T>
+		bool IndicesInRange(const T* indices, uint32_t indexCount, uint32_t vertexCount)
+		{
+			return std::all_of(indices, indices + indexCount, [vertexCount](T index) { return index < vertexCount; });
+		}
+	}
+
+	bool GetCookedSourceInfo(const std::filesystem::path& sourcePath, CookedSourceInfo& info)
+	{
+		MappedFile source;
+		if (!source.Open(sourcePath))
+			return false;
+
+		std::error_code error;
+		info.size = source.GetSize();
+		info.writeTime = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+		info.contentHash = HashBytes(source.GetData(), source.GetSize());
+		return !error;
+	}
+
+	bool GetCookedDependencies(const std::filesystem::path& sourcePath, std::vector<CookedDependency>& dependencies)
+	{
+		dependencies.clear();
+
+		// A .glb embeds its buffers and images
+		std::string extension = sourcePath.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (extension != ".gltf")
+			return true;
+
+		std::ifstream file(sourcePath);
+		nlohmann::json json = nlohmann::json::parse(file, nullptr, false);
+		if (json.is_discarded())
+			return true;
+
+		for (const char* section : { "buffers", "images" })
+		{
+			nlohmann::json entries = json.value(section, nlohmann::json::array());
+			for (const auto& entry : entries)
+			{
+				if (!entry.is_object() || !entry.contains("uri") || !entry["uri"].is_string())
+					continue;
+
+				// Embedded data URIs are part of the .gltf itself
+				fastgltf::URI uri(entry["uri"].get<std::string>());
+				if (!uri.valid() || !uri.isLocalPath())
+					continue;
+
+				CookedDependency dependency;
+				dependency.path = uri.fspath().lexically_normal().generic_string();
+				if (!GetCookedSourceInfo(sourcePath.parent_path() / dependency.path, dependency.info))
+				{
+					std::cerr << "Missing dependency " << dependency.path << " of " << sourcePath.string() << std::endl;
+					return false;
+				}
+
+				dependencies.push_back(std::move(dependency));
+			}
+		}
+
+		return true;
+	}
+
+	bool IsCookedSourceCurrent(const CookedSourceInfo& cooked, const std::filesystem::path& sourcePath)
+	{
+		std::error_code error;
+		uint64_t size = std::filesystem::file_size(sourcePath, error);
+		if (error || size != cooked.size)
+			return false;
+
+		int64_t writeTime = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+		if (!error && writeTime == cooked.writeTime)
+			return true;
+
+		// Touched but possibly unchanged, e.g. after a checkout, the content decides
+		CookedSourceInfo info;
+		return GetCookedSourceInfo(sourcePath, info) && info.contentHash == cooked.contentHash;
+	}
+
+	bool WriteCookedModel(const Model& model, const CookedSourceInfo& source, const std::vector<CookedDependency>& dependencies, const std::filesystem::path& path)
+	{
+		FileWriter writer;
+		writer.Allocate(sizeof(FileHeader));
+
+		FileHeader header{};
+		header.magic = Magic;
+		header.version = CookedModelVersion;
+		header.sourceSize = source.size;
+		header.sourceWriteTime = source.writeTime;
+		header.sourceHash = source.contentHash;
+
+		std::vector<FileTexture> textures(model.textureData.size());
+		for (size_t i = 0; i < model.textureData.size(); ++i)
+		{
+			const TextureData& textureData = model.textureData[i];
+
+			FileTexture& texture = textures[i];
+			texture.pixelsOffset = writer.Append(textureData.pixels);
+			texture.pixelsSize = textureData.pixels.size();
+			texture.width = static_cast<uint32_t>(textureData.width);
+			texture.height = static_cast<uint32_t>(textureData.height);
+			texture.channels = static_cast<uint32_t>(textureData.channels);
+			texture.sRGB = textureData.sRGB ? 1 : 0;
+		}
+
+		std::vector<FileMaterial> materials;
+		std::vector<FileMesh> meshes(model.meshData.size());
+		std::vector<FilePrimitive> primitives;
+
+		for (size_t meshIndex = 0; meshIndex < model.meshData.size(); ++meshIndex)
+		{
+			const MeshData& meshData = model.meshData[meshIndex];
+
+			FileMesh& mesh = meshes[meshIndex];
+			mesh.firstPrimitive = static_cast<uint32_t>(primitives.size());
+			mesh.primitiveCount = static_cast<uint32_t>(meshData.primitiveInfo.size());
+
+			if (meshData.collision)
+			{
+				std::vector<uint8_t> collision;
+				meshData.collision->Serialize(collision);
+				mesh.collisionOffset = writer.Append(collision);
+				mesh.collisionSize = collision.size();
+			}
+
+			for (const MeshPrimitiveInfo& info : meshData.primitiveInfo)
+			{
+				// Already cooked data has no float vertices left to pack
+				if (info.packed.vertices)
+				{
+					std::cerr << "Cannot cook a model that was itself loaded from a cooked file" << std::endl;
+					return false;
+				}
+
+				FilePrimitive primitive{};
+
+				// Primitives sharing a material share its table entry
+				FileMaterial material = MakeMaterial(info);
+				size_t materialIndex = 0;
+				while (materialIndex < materials.size() && memcmp(&materials[materialIndex], &material, sizeof(material)) != 0)
+					++materialIndex;
+				if (materialIndex == materials.size())
+					materials.push_back(material);
+				primitive.material = static_cast<uint32_t>(materialIndex);
+
+				primitive.vertexCount = static_cast<uint32_t>(info.vertices.size());
+				primitive.indexCount = static_cast<uint32_t>(info.indices.size());
+
+				std::vector<MeshLod> lods = info.lods;
+				if (lods.empty())
+					lods.push_back(MeshLod{ 0, primitive.indexCount, 0.0f });
+				primitive.lodCount = static_cast<uint32_t>(lods.size());
+				primitive.lodsOffset = writer.Append(lods);
+
+				memcpy(primitive.boundsMin, &info.bounds.min[0], sizeof(primitive.boundsMin));
+				memcpy(primitive.boundsMax, &info.bounds.max[0], sizeof(primitive.boundsMax));
+				memcpy(primitive.sphereCenter, &info.boundingSphere.center[0], sizeof(primitive.sphereCenter));
+				primitive.sphereRadius = info.boundingSphere.radius;
+
+				PackedVertexLayout layout = ComputePackedVertexLayout(info.vertices, info.bounds);
+				memcpy(primitive.positionOffset, &layout.vertexDecode.positionOffset[0], sizeof(primitive.positionOffset));
+				memcpy(primitive.positionScale, &layout.vertexDecode.positionScale[0], sizeof(primitive.positionScale));
+				for (size_t set = 0; set < 3; ++set)
+					primitive.texCoordOffsets[set] = layout.texCoordOffsets[set];
+
+				primitive.vertexSize = layout.size;
+				primitive.vertexOffset = writer.Allocate(static_cast<size_t>(layout.size));
+				WritePackedVertices(info.vertices, layout, writer.bytes.data() + primitive.vertexOffset);
+
+				VkIndexType indexType = GetPackedIndexType(info.vertices.size());
+				primitive.indexType = indexType == VK_INDEX_TYPE_UINT16 ? 0 : 1;
+				primitive.indexSize = GetIndexSize(indexType) * info.indices.size();
+				primitive.indexOffset = writer.Allocate(static_cast<size_t>(primitive.indexSize));
+				WritePackedIndices(info.indices, indexType, writer.bytes.data() + primitive.indexOffset);
+
+				primitives.push_back(primitive);
+			}
+		}
+
+		// Scene only instantiates the first scene's roots, nodes are stored with matrices already decomposed
+		const fastgltf::Asset& asset = model.gltfAsset;
+
+		std::vector<FileNode> nodes(asset.nodes.size());
+		std::vector<uint32_t> children;
+		std::vector<char> strings;
+
+		for (size_t nodeIndex = 0; nodeIndex < asset.nodes.size(); ++nodeIndex)
+		{
+			const fastgltf::Node& gltfNode = asset.nodes[nodeIndex];
+			FileNode& node = nodes[nodeIndex];
+
+			node.nameOffset = static_cast<uint32_t>(strings.size());
+			node.nameLength = static_cast<uint32_t>(gltfNode.name.size());
+			strings.insert(strings.end(), gltfNode.name.begin(), gltfNode.name.end());
+
+			node.mesh = gltfNode.meshIndex.has_value() ? static_cast<int32_t>(gltfNode.meshIndex.value()) : -1;
+
+			node.firstChild = static_cast<uint32_t>(children.size());
+			node.childCount = static_cast<uint32_t>(gltfNode.children.size());
+			for (size_t child : gltfNode.children)
+				children.push_back(static_cast<uint32_t>(child));
+
+			fastgltf::math::fvec3 translation(0.0f, 0.0f, 0.0f);
+			fastgltf::math::fquat rotation;
+			fastgltf::math::fvec3 scale(1.0f, 1.0f, 1.0f);
+
+			if (auto* matrix = std::get_if<fastgltf::math::fmat4x4>(&gltfNode.transform))
+			{
+				fastgltf::math::decomposeTransformMatrix(*matrix, scale, rotation, translation);
+			}
+			else if (auto* trs = std::get_if<fastgltf::TRS>(&gltfNode.transform))
+			{
+				translation = trs->translation;
+				rotation = trs->rotation;
+				scale = trs->scale;
+			}
+
+			for (size_t i = 0; i < 3; ++i)
+			{
+				node.translation[i] = translation[i];
+				node.scale[i] = scale[i];
+			}
+			for (size_t i = 0; i < 4; ++i)
+				node.rotation[i] = rotation[i];
+		}
+
+		std::vector<FileDependency> fileDependencies(dependencies.size());
+		for (size_t i = 0; i < dependencies.size(); ++i)
+		{
+			FileDependency& dependency = fileDependencies[i];
+			dependency.pathOffset = static_cast<uint32_t>(strings.size());
+			dependency.pathLength = static_cast<uint32_t>(dependencies[i].path.size());
+			dependency.size = dependencies[i].info.size;
+			dependency.writeTime = dependencies[i].info.writeTime;
+			dependency.contentHash = dependencies[i].info.contentHash;
+			strings.insert(strings.end(), dependencies[i].path.begin(), dependencies[i].path.end());
+		}
+
+		std::vector<uint32_t> roots;
+		if (!asset.scenes.empty())
+		{
+			for (size_t root : asset.scenes[0].nodeIndices)
+				roots.push_back(static_cast<uint32_t>(root));
+		}
+
+		header.textureCount = static_cast<uint32_t>(textures.size());
+		header.materialCount = static_cast<uint32_t>(materials.size());
+		header.meshCount = static_cast<uint32_t>(meshes.size());
+		header.primitiveCount = static_cast<uint32_t>(primitives.size());
+		header.nodeCount = static_cast<uint32_t>(nodes.size());
+		header.childCount = static_cast<uint32_t>(children.size());
+		header.rootCount = static_cast<uint32_t>(roots.size());
+		header.dependencyCount = static_cast<uint32_t>(fileDependencies.size());
+
+		header.texturesOffset = writer.Append(textures);
+		header.materialsOffset = writer.Append(materials);
+		header.meshesOffset = writer.Append(meshes);
+		header.primitivesOffset = writer.Append(primitives);
+		header.nodesOffset = writer.Append(nodes);
+		header.childrenOffset = writer.Append(children);
+		header.rootsOffset = writer.Append(roots);
+		header.stringsOffset = writer.Append(strings);
+		header.stringsSize = strings.size();
+		header.dependenciesOffset = writer.Append(fileDependencies);
+
+		memcpy(writer.bytes.data(), &header, sizeof(header));
+
+		// Written aside and renamed, so a reader never maps a half written file
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ".tmp";
+
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				std::cerr << "Failed to open cooked model for writing at " << temporaryPath.string() << std::endl;
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(writer.bytes.data()), static_cast<std::streamsize>(writer.bytes.size()));
+			if (!file.good())
+			{
+				std::cerr << "Failed to write cooked model at " << temporaryPath.string() << std::endl;
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error)
+		{
+			std::cerr << "Failed to move cooked model into place at " << path.string() << ": " << error.message() << std::endl;
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	std::shared_ptr<Model> ReadCookedModel(const std::filesystem::path& path, const std::filesystem::path& sourcePath)
+	{
+		auto file = std::make_shared<MappedFile>();
+		if (!file->Open(path))
+			return nullptr;
+
+		FileReader reader(file->GetData(), file->GetSize());
+
+		const FileHeader* header = reader.Get<FileHeader>(0, 1);
+		if (!header || header->magic != Magic)
+		{
+			std::cerr << "Not a cooked model: " << path.string() << std::endl;
+			return nullptr;
+		}
+
+		// Older versions are simply recooked
+		if (header->version != CookedModelVersion)
+			return nullptr;
+
+		if (!sourcePath.empty() && !IsCookedSourceCurrent({ header->sourceSize, header->sourceWriteTime, header->sourceHash }, sourcePath))
+			return nullptr;
+
+		const FileTexture* textures = reader.Get<FileTexture>(header->texturesOffset, header->textureCount);
+		const FileMaterial* materials = reader.Get<FileMaterial>(header->materialsOffset, header->materialCount);
+		const FileMesh* meshes = reader.Get<FileMesh>(header->meshesOffset, header->meshCount);
+		const FilePrimitive* primitives = reader.Get<FilePrimitive>(header->primitivesOffset, header->primitiveCount);
+		const FileNode* nodes = reader.Get<FileNode>(header->nodesOffset, header->nodeCount);
+		const uint32_t* children = reader.Get<uint32_t>(header->childrenOffset, header->childCount);
+		const uint32_t* roots = reader.Get<uint32_t>(header->rootsOffset, header->rootCount);
+		const char* strings = reader.Get<char>(header->stringsOffset, header->stringsSize);
+		const FileDependency* dependencies = reader.Get<FileDependency>(header->dependenciesOffset, header->dependencyCount);
+
+		auto corrupt = [&]()
+			{
+				std::cerr << "Corrupt cooked model: " << path.string() << std::endl;
+				return nullptr;
+			};
+
+		if ((header->textureCount && !textures) || (header->materialCount && !materials) || (header->meshCount && !meshes) ||
+			(header->primitiveCount && !primitives) || (header->nodeCount && !nodes) || (header->childCount && !children) ||
+			(header->rootCount && !roots) || (header->stringsSize && !strings) || (header->dependencyCount && !dependencies))
+			return corrupt();
+
+		for (uint32_t i = 0; i < header->dependencyCount; ++i)
+		{
+			const FileDependency& dependency = dependencies[i];
+			if (dependency.pathOffset > header->stringsSize || dependency.pathLength > header->stringsSize - dependency.pathOffset)
+				return corrupt();
+
+			if (sourcePath.empty())
+				continue;
+
+			std::filesystem::path dependencyPath = sourcePath.parent_path() / std::string(strings + dependency.pathOffset, dependency.pathLength);
+			if (!IsCookedSourceCurrent({ dependency.size, dependency.writeTime, dependency.contentHash }, dependencyPath))
+				return nullptr;
+		}
+
+		auto model = std::make_shared<Model>();
+		model->mappedFile = file;
+
+		model->textureData.resize(header->textureCount);
+		for (uint32_t i = 0; i < header->textureCount; ++i)
+		{
+			const FileTexture& texture = textures[i];
+			if (!reader.Contains(texture.pixelsOffset, texture.pixelsSize) || (texture.pixelsSize != 0 && texture.pixelsSize != uint64_t(texture.width) * texture.height * 4))
+				return corrupt();
+
+			TextureData& textureData = model->textureData[i];
+			textureData.width = static_cast<int>(texture.width);
+			textureData.height = static_cast<int>(texture.height);
+			textureData.channels = static_cast<int>(texture.channels);
+			textureData.sRGB = texture.sRGB != 0;
+			textureData.mappedPixels = texture.pixelsSize != 0 ? reader.At(texture.pixelsOffset) : nullptr;
+		}
+
+		model->meshData.resize(header->meshCount);
+		for (uint32_t meshIndex = 0; meshIndex < header->meshCount; ++meshIndex)
+		{
+			const FileMesh& mesh = meshes[meshIndex];
+			if (mesh.firstPrimitive > header->primitiveCount || mesh.primitiveCount > header->primitiveCount - mesh.firstPrimitive)
+				return corrupt();
+
+			MeshData& meshData = model->meshData[meshIndex];
+
+			if (mesh.collisionSize > 0)
+			{
+				meshData.collision = std::make_shared<TriangleBVH>();
+				if (!reader.Contains(mesh.collisionOffset, mesh.collisionSize) || !meshData.collision->Deserialize(reader.At(mesh.collisionOffset), static_cast<size_t>(mesh.collisionSize)))
+					return corrupt();
+			}
+
+			meshData.primitiveInfo.resize(mesh.primitiveCount);
+			for (uint32_t i = 0; i < mesh.primitiveCount; ++i)
+			{
+				const FilePrimitive& primitive = primitives[mesh.firstPrimitive + i];
+				MeshPrimitiveInfo& info = meshData.primitiveInfo[i];
+
+				if (primitive.material >= header->materialCount || primitive.indexType > 1)
+					return corrupt();
+
+				VkIndexType indexType = primitive.indexType == 0 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+				// Every stream must fit the vertex blob, every index range the index blob
+				bool valid = reader.Contains(primitive.vertexOffset, primitive.vertexSize) && reader.Contains(primitive.indexOffset, primitive.indexSize) &&
+					primitive.vertexSize >= uint64_t(primitive.vertexCount) * sizeof(PackedVertex) &&
+					primitive.indexSize == GetIndexSize(indexType) * primitive.indexCount;
+				for (size_t set = 0; set < 3 && valid; ++set)
+					valid = primitive.texCoordOffsets[set] <= primitive.vertexSize && uint64_t(primitive.vertexCount) * sizeof(PackedTexCoord) <= primitive.vertexSize - primitive.texCoordOffsets[set];
+
+				const MeshLod* lods = reader.Get<MeshLod>(primitive.lodsOffset, primitive.lodCount);
+				valid = valid && lods && primitive.lodCount > 0;
+				for (uint32_t level = 0; level < primitive.lodCount && valid; ++level)
+					valid = lods[level].firstIndex <= primitive.indexCount && lods[level].indexCount <= primitive.indexCount - lods[level].firstIndex;
+
+				if (valid && indexType == VK_INDEX_TYPE_UINT16)
+				{
+					const uint16_t* indices = reader.Get<uint16_t>(primitive.indexOffset, primitive.indexCount);
+					valid = indices && IndicesInRange(indices, primitive.indexCount, primitive.vertexCount);
+				}
+				else if (valid)
+				{
+					const uint32_t* indices = reader.Get<uint32_t>(primitive.indexOffset, primitive.indexCount);
+					valid = indices && IndicesInRange(indices, primitive.indexCount, primitive.vertexCount);
+				}
+
+				if (!valid)
+					return corrupt();
+
+				const FileMaterial& material = materials[primitive.material];
+				info.baseColorFactor = glm::vec4(material.baseColorFactor[0], material.baseColorFactor[1], material.baseColorFactor[2], material.baseColorFactor[3]);
+				info.metallicFactor = material.metallicFactor;
+				info.roughnessFactor = material.roughnessFactor;
+				info.enableTransparency = (material.flags & MaterialTransparent) != 0;
+				info.doubleSided = (material.flags & MaterialDoubleSided) != 0;
+				info.hasBaseColorTexture = (material.flags & MaterialBaseColorTexture) != 0;
+				info.hasMetallicRoughnessTexture = (material.flags & MaterialMetallicRoughnessTexture) != 0;
+				info.hasNormalTexture = (material.flags & MaterialNormalTexture) != 0;
+				info.baseColorTextureIndex = static_cast<size_t>(material.baseColorTexture);
+				info.metallicRoughnessTextureIndex = static_cast<size_t>(material.metallicRoughnessTexture);
+				info.normalTextureIndex = static_cast<size_t>(material.normalTexture);
+
+				info.lods.assign(lods, lods + primitive.lodCount);
+
+				info.bounds.min = glm::vec3(primitive.boundsMin[0], primitive.boundsMin[1], primitive.boundsMin[2]);
+				info.bounds.max = glm::vec3(primitive.boundsMax[0], primitive.boundsMax[1], primitive.boundsMax[2]);
+				info.boundingSphere.center = glm::vec3(primitive.sphereCenter[0], primitive.sphereCenter[1], primitive.sphereCenter[2]);
+				info.boundingSphere.radius = primitive.sphereRadius;
+
+				PackedPrimitiveData& packed = info.packed;
+				packed.vertices = reader.At(primitive.vertexOffset);
+				packed.indices = reader.At(primitive.indexOffset);
+				packed.vertexCount = primitive.vertexCount;
+				packed.indexCount = primitive.indexCount;
+				packed.indexType = indexType;
+				packed.layout.size = primitive.vertexSize;
+				packed.layout.vertexDecode.positionOffset = glm::vec4(primitive.positionOffset[0], primitive.positionOffset[1], primitive.positionOffset[2], primitive.positionOffset[3]);
+				packed.layout.vertexDecode.positionScale = glm::vec4(primitive.positionScale[0], primitive.positionScale[1], primitive.positionScale[2], primitive.positionScale[3]);
+				for (size_t set = 0; set < 3; ++set)
+					packed.layout.texCoordOffsets[set] = primitive.texCoordOffsets[set];
+			}
+		}
+
+		// Rebuilt as glTF nodes so Scene instantiates cooked and imported models the same way
+		fastgltf::Asset& asset = model->gltfAsset;
+		asset.nodes.resize(header->nodeCount);
+		std::vector<uint8_t> hasParent(header->nodeCount, 0);
+		for (uint32_t nodeIndex = 0; nodeIndex < header->nodeCount; ++nodeIndex)
+		{
+			const FileNode& node = nodes[nodeIndex];
+			if (node.nameOffset > header->stringsSize || node.nameLength > header->stringsSize - node.nameOffset ||
+				node.firstChild > header->childCount || node.childCount > header->childCount - node.firstChild ||
+				node.mesh >= static_cast<int32_t>(header->meshCount))
+				return corrupt();
+
+			fastgltf::Node& gltfNode = asset.nodes[nodeIndex];
+			gltfNode.name.assign(strings + node.nameOffset, node.nameLength);
+
+			if (node.mesh >= 0)
+				gltfNode.meshIndex = static_cast<size_t>(node.mesh);
+
+			for (uint32_t i = 0; i < node.childCount; ++i)
+			{
+				uint32_t child = children[node.firstChild + i];
+				if (child >= header->nodeCount || hasParent[child])
+					return corrupt();
+				hasParent[child] = 1;
+				gltfNode.children.push_back(child);
+			}
+
+			fastgltf::TRS trs;
+			trs.translation = fastgltf::math::fvec3(node.translation[0], node.translation[1], node.translation[2]);
+			trs.rotation = fastgltf::math::fquat(node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3]);
+			trs.scale = fastgltf::math::fvec3(node.scale[0], node.scale[1], node.scale[2]);
+			gltfNode.transform = trs;
+		}
+
+		// With one parent per node the hierarchy is a forest exactly when every node is reachable from a parentless one,
+		// anything left over sits on a cycle that would recurse forever when the scene instantiates it
+		std::vector<uint32_t> pending;
+		for (uint32_t nodeIndex = 0; nodeIndex < header->nodeCount; ++nodeIndex)
+		{
+			if (!hasParent[nodeIndex])
+				pending.push_back(nodeIndex);
+		}
+
+		size_t reachedCount = 0;
+		while (!pending.empty())
+		{
+			uint32_t nodeIndex = pending.back();
+			pending.pop_back();
+			++reachedCount;
+
+			for (size_t child : asset.nodes[nodeIndex].children)
+				pending.push_back(static_cast<uint32_t>(child));
+		}
+
+		if (reachedCount != header->nodeCount)
+			return corrupt();
+
+		asset.scenes.resize(1);
+		for (uint32_t i = 0; i < header->rootCount; ++i)
+		{
+			if (roots[i] >= header->nodeCount)
+				return corrupt();
+			asset.scenes[0].nodeIndices.push_back(roots[i]);
+		}
+
+		return model;
+	}
+}
\ No newline at end of file
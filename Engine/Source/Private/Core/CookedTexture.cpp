@@ -0,0 +1,102 @@
+#include "Core/CookedTexture.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Core/MappedFile.h"
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr uint32_t Magic = 0x5854424E; // "NBTX"
+
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t sourceSize;
+			int64_t sourceWriteTime;
+			uint64_t sourceHash;
+			uint32_t width;
+			uint32_t height;
+			uint64_t pixelsSize;
+		};
+	}
+
+	bool WriteCookedTexture(const uint8_t* pixels, uint32_t width, uint32_t height, const CookedSourceInfo& source, const std::filesystem::path& path)
+	{
+		FileHeader header{};
+		header.magic = Magic;
+		header.version = CookedTextureVersion;
+		header.sourceSize = source.size;
+		header.sourceWriteTime = source.writeTime;
+		header.sourceHash = source.contentHash;
+		header.width = width;
+		header.height = height;
+		header.pixelsSize = uint64_t(width) * height * 4;
+
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ".tmp";
+
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				std::cerr << "Failed to open cooked texture for writing at " << temporaryPath.string() << std::endl;
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(header.pixelsSize));
+			if (!file.good())
+			{
+				std::cerr << "Failed to write cooked texture at " << temporaryPath.string() << std::endl;
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error)
+		{
+			std::cerr << "Failed to move cooked texture into place at " << path.string() << ": " << error.message() << std::endl;
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ReadCookedTexture(const std::filesystem::path& path, CookedTexture& texture, const std::filesystem::path& sourcePath)
+	{
+		auto file = std::make_shared<MappedFile>();
+		if (!file->Open(path))
+			return false;
+
+		if (file->GetSize() < sizeof(FileHeader))
+			return false;
+
+		FileHeader header;
+		memcpy(&header, file->GetData(), sizeof(header));
+
+		if (header.magic != Magic || header.version != CookedTextureVersion)
+			return false;
+
+		if (header.pixelsSize != uint64_t(header.width) * header.height * 4 || header.pixelsSize > file->GetSize() - sizeof(FileHeader))
+		{
+			std::cerr << "Corrupt cooked texture: " << path.string() << std::endl;
+			return false;
+		}
+
+		if (!sourcePath.empty() && !IsCookedSourceCurrent({ header.sourceSize, header.sourceWriteTime, header.sourceHash }, sourcePath))
+			return false;
+
+		texture.file = file;
+		texture.pixels = file->GetData() + sizeof(FileHeader);
+		texture.width = header.width;
+		texture.height = header.height;
+		return true;
+	}
+}
\ No newline at end of file
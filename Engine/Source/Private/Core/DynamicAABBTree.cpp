@@ -0,0 +1,352 @@
+#include "Core/DynamicAABBTree.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Nightbird
+{
+	DynamicAABBTree::DynamicAABBTree(float margin)
+		: margin(margin)
+	{
+
+	}
+
+	int32_t DynamicAABBTree::CreateProxy(const AABB& aabb, void* userData, uint32_t category)
+	{
+		int32_t proxyId = AllocateNode();
+
+		Node& node = nodes[proxyId];
+		node.aabb = Fatten(aabb, margin);
+		node.userData = userData;
+		node.category = category;
+		node.height = 0;
+
+		InsertLeaf(proxyId);
+		++proxyCount;
+
+		return proxyId;
+	}
+
+	void DynamicAABBTree::DestroyProxy(int32_t proxyId)
+	{
+		if (proxyId < 0 || proxyId >= static_cast<int32_t>(nodes.size()) || !nodes[proxyId].IsLeaf() || nodes[proxyId].height != 0)
+			return;
+
+		RemoveLeaf(proxyId);
+		FreeNode(proxyId);
+		--proxyCount;
+	}
+
+	bool DynamicAABBTree::MoveProxy(int32_t proxyId, const AABB& aabb)
+	{
+		Node& node = nodes[proxyId];
+
+		// Keep the leaf while it still encloses the bounds and has not grown far larger than them
+		if (Contains(node.aabb, aabb) && Contains(Fatten(aabb, margin * 4.0f), node.aabb))
+			return false;
+
+		RemoveLeaf(proxyId);
+		nodes[proxyId].aabb = Fatten(aabb, margin);
+		InsertLeaf(proxyId);
+
+		return true;
+	}
+
+	void* DynamicAABBTree::GetUserData(int32_t proxyId) const
+	{
+		return nodes[proxyId].userData;
+	}
+
+	uint32_t DynamicAABBTree::GetCategory(int32_t proxyId) const
+	{
+		return nodes[proxyId].category;
+	}
+
+	const AABB& DynamicAABBTree::GetFatAABB(int32_t proxyId) const
+	{
+		return nodes[proxyId].aabb;
+	}
+
+	size_t DynamicAABBTree::GetProxyCount() const
+	{
+		return proxyCount;
+	}
+
+	int32_t DynamicAABBTree::GetHeight() const
+	{
+		return root == NullNode ? 0 : nodes[root].height;
+	}
+
+	void DynamicAABBTree::Clear()
+	{
+		nodes.clear();
+		root = NullNode;
+		freeList = NullNode;
+		proxyCount = 0;
+	}
+
+	int32_t DynamicAABBTree::AllocateNode()
+	{
+		if (freeList == NullNode)
+		{
+			nodes.emplace_back();
+			nodes.back().parent = NullNode;
+			return static_cast<int32_t>(nodes.size() - 1);
+		}
+
+		int32_t nodeId = freeList;
+		freeList = nodes[nodeId].next;
+
+		Node& node = nodes[nodeId];
+		node = Node();
+		node.parent = NullNode;
+		return nodeId;
+	}
+
+	void DynamicAABBTree::FreeNode(int32_t nodeId)
+	{
+		Node& node = nodes[nodeId];
+		node.next = freeList;
+		node.height = -1;
+		node.category = 0;
+		node.userData = nullptr;
+		freeList = nodeId;
+	}
+
+	void DynamicAABBTree::InsertLeaf(int32_t leaf)
+	{
+		if (root == NullNode)
+		{
+			root = leaf;
+			nodes[root].parent = NullNode;
+			return;
+		}
+
+		// Descend towards the sibling with the lowest surface area cost
+		AABB leafAABB = nodes[leaf].aabb;
+		int32_t index = root;
+
+		while (!nodes[index].IsLeaf())
+		{
+			const Node& node = nodes[index];
+
+			float area = SurfaceArea(node.aabb);
+			float combinedArea = SurfaceArea(Union(node.aabb, leafAABB));
+
+			// Pairing with this node creates a parent covering both
+			float cost = 2.0f * combinedArea;
+
+			// Descending pushes the enlargement onto every ancestor
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](int32_t childId)
+				{
+					const Node& child = nodes[childId];
+					float enlarged = SurfaceArea(Union(child.aabb, leafAABB));
+					if (child.IsLeaf())
+						return enlarged + inheritanceCost;
+					return enlarged - SurfaceArea(child.aabb) + inheritanceCost;
+				};
+
+			float cost1 = childCost(node.child1);
+			float cost2 = childCost(node.child2);
+
+			if (cost < cost1 && cost < cost2)
+				break;
+
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		int32_t sibling = index;
+		int32_t oldParent = nodes[sibling].parent;
+
+		int32_t newParent = AllocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+		UpdateNode(newParent);
+
+		if (oldParent != NullNode)
+		{
+			if (nodes[oldParent].child1 == sibling)
+				nodes[oldParent].child1 = newParent;
+			else
+				nodes[oldParent].child2 = newParent;
+		}
+		else
+		{
+			root = newParent;
+		}
+
+		Refit(nodes[leaf].parent);
+	}
+
+	void DynamicAABBTree::RemoveLeaf(int32_t leaf)
+	{
+		if (leaf == root)
+		{
+			root = NullNode;
+			return;
+		}
+
+		int32_t parent = nodes[leaf].parent;
+		int32_t grandParent = nodes[parent].parent;
+		int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grandParent != NullNode)
+		{
+			if (nodes[grandParent].child1 == parent)
+				nodes[grandParent].child1 = sibling;
+			else
+				nodes[grandParent].child2 = sibling;
+
+			nodes[sibling].parent = grandParent;
+			FreeNode(parent);
+
+			Refit(grandParent);
+		}
+		else
+		{
+			root = sibling;
+			nodes[sibling].parent = NullNode;
+			FreeNode(parent);
+		}
+	}
+
+	void DynamicAABBTree::Refit(int32_t nodeId)
+	{
+		while (nodeId != NullNode)
+		{
+			nodeId = Balance(nodeId);
+			UpdateNode(nodeId);
+			nodeId = nodes[nodeId].parent;
+		}
+	}
+
+	void DynamicAABBTree::UpdateNode(int32_t nodeId)
+	{
+		Node& node = nodes[nodeId];
+		const Node& child1 = nodes[node.child1];
+		const Node& child2 = nodes[node.child2];
+
+		node.aabb = Union(child1.aabb, child2.aabb);
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.category = child1.category | child2.category;
+	}
+
+	int32_t DynamicAABBTree::Balance(int32_t nodeA)
+	{
+		if (nodes[nodeA].IsLeaf() || nodes[nodeA].height < 2)
+			return nodeA;
+
+		int32_t nodeB = nodes[nodeA].child1;
+		int32_t nodeC = nodes[nodeA].child2;
+
+		int32_t balance = nodes[nodeC].height - nodes[nodeB].height;
+		if (balance >= -1 && balance <= 1)
+			return nodeA;
+
+		// Rotate the taller child up and hand its shorter grandchild to A
+		bool rotateC = balance > 1;
+		int32_t up = rotateC ? nodeC : nodeB;
+		int32_t grandChild1 = nodes[up].child1;
+		int32_t grandChild2 = nodes[up].child2;
+
+		nodes[up].child1 = nodeA;
+		nodes[up].parent = nodes[nodeA].parent;
+		nodes[nodeA].parent = up;
+
+		int32_t upParent = nodes[up].parent;
+		if (upParent != NullNode)
+		{
+			if (nodes[upParent].child1 == nodeA)
+				nodes[upParent].child1 = up;
+			else
+				nodes[upParent].child2 = up;
+		}
+		else
+		{
+			root = up;
+		}
+
+		int32_t keep = grandChild1;
+		int32_t give = grandChild2;
+		if (nodes[grandChild1].height <= nodes[grandChild2].height)
+			std::swap(keep, give);
+
+		nodes[up].child2 = keep;
+		if (rotateC)
+			nodes[nodeA].child2 = give;
+		else
+			nodes[nodeA].child1 = give;
+		nodes[give].parent = nodeA;
+
+		UpdateNode(nodeA);
+		UpdateNode(up);
+
+		return up;
+	}
+
+	float DynamicAABBTree::SurfaceArea(const AABB& aabb)
+	{
+		glm::vec3 size = aabb.max - aabb.min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	bool DynamicAABBTree::Contains(const AABB& outer, const AABB& inner)
+	{
+		return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+			outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+	}
+
+	AABB DynamicAABBTree::Fatten(const AABB& aabb, float amount)
+	{
+		AABB result;
+		result.min = aabb.min - glm::vec3(amount);
+		result.max = aabb.max + glm::vec3(amount);
+		return result;
+	}
+
+	AABB DynamicAABBTree::Union(const AABB& a, const AABB& b)
+	{
+		AABB result = a;
+		result.Expand(b);
+		return result;
+	}
+
+	DynamicAABBTree::FrustumTest DynamicAABBTree::TestFrustum(const Frustum& frustum, const AABB& aabb)
+	{
+		glm::vec3 center = aabb.GetCenter();
+		glm::vec3 extents = aabb.GetExtents();
+
+		FrustumTest result = FrustumTest::Inside;
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			glm::vec3 normal = glm::vec3(plane);
+			float radius = glm::dot(extents, glm::abs(normal));
+			float distance = glm::dot(normal, center) + plane.w;
+
+			if (distance < -radius)
+				return FrustumTest::Outside;
+			if (distance < radius)
+				result = FrustumTest::Intersect;
+		}
+		return result;
+	}
+
+	bool DynamicAABBTree::RayIntersects(const AABB& aabb, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+	{
+		glm::vec3 t1 = (aabb.min - origin) * inverseDirection;
+		glm::vec3 t2 = (aabb.max - origin) * inverseDirection;
+
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+		return enter <= exit;
+	}
+}
\ No newline at end of file
@@ -7,6 +7,8 @@
 
 #include "Core/GlfwWindow.h"
 #include "Core/ModelManager.h"
+#include "Core/JobSystem.h"
+#include "Core/ResidencyManager.h"
 #include "Core/Scene.h"
 #include "Core/RenderTarget.h"
 #include "Core/Renderer.h"
@@ -28,14 +30,18 @@ namespace Nightbird
 			std::cerr << "Failed to initialize Volk" << std::endl;
 		}
 		
+		jobSystem = std::make_unique<JobSystem>();
+
 		glfwWindow = std::make_unique<GlfwWindow>();
 		Input::Get().Init(glfwWindow->Get());
 		
-		renderer = std::make_unique<Renderer>(glfwWindow.get());
+		renderer = std::make_unique<Renderer>(glfwWindow.get(), jobSystem.get());
 		glfwWindow->SetUserPointer(renderer.get());
 
-		modelManager = std::make_unique<ModelManager>(renderer->GetDevice(), renderer->GetDescriptorSetLayoutManager()->GetMeshDescriptorSetLayout(), renderer->GetDescriptorSetLayoutManager()->GetMaterialDescriptorSetLayout(), renderer->GetDescriptorPool()->Get());
+		modelManager = std::make_unique<ModelManager>(renderer->GetDevice(), jobSystem.get(), renderer->GetDescriptorSetLayoutManager()->GetMeshDescriptorSetLayout(), renderer->GetDescriptorSetLayoutManager()->GetMaterialDescriptorSetLayout(), renderer->GetDescriptorPool()->Get());
 		
+		residencyManager = std::make_unique<ResidencyManager>(renderer->GetDevice(), modelManager.get());
+
 		scene = std::make_unique<Scene>(renderer->GetDevice(), modelManager.get(), renderer->GetGlobalDescriptorSetManager(), renderer->GetDescriptorPool()->Get());
 	}
 	
@@ -49,6 +55,11 @@ namespace Nightbird
 		return glfwWindow.get();
 	}
 
+	JobSystem* Engine::GetJobSystem() const
+	{
+		return jobSystem.get();
+	}
+
 	Renderer* Engine::GetRenderer() const
 	{
 		return renderer.get();
@@ -64,6 +75,11 @@ namespace Nightbird
 		return modelManager.get();
 	}
 
+	ResidencyManager* Engine::GetResidencyManager() const
+	{
+		return residencyManager.get();
+	}
+
 	float Engine::GetDeltaTime() const
 	{
 		return deltaTime;
@@ -85,7 +101,10 @@ namespace Nightbird
 			if (bSimulationRunning)
 				scene->Update(deltaTime);
 
+			jobSystem->UpdateStats();
 			modelManager->ProcessUploadQueue();
+			modelManager->ReleaseRetiredResources(renderer->GetCompletedFrameNumber());
+			residencyManager->Update(renderer->GetFrameNumber());
 			renderer->DrawFrame(scene.get());
 		}
 		vkDeviceWaitIdle(renderer->GetDevice()->GetLogical());
@@ -0,0 +1,93 @@
+#include "Core/FrustumCuller.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define NIGHTBIRD_CULL_SSE
+#endif
+
+#include "Core/Bounds.h"
+
+namespace Nightbird
+{
+	void FrustumCuller::Clear()
+	{
+		centerX.clear();
+		centerY.clear();
+		centerZ.clear();
+		radius.clear();
+	}
+
+	void FrustumCuller::Reserve(size_t count)
+	{
+		centerX.reserve(count);
+		centerY.reserve(count);
+		centerZ.reserve(count);
+		radius.reserve(count);
+	}
+
+	void FrustumCuller::AddSphere(const glm::vec3& center, float sphereRadius)
+	{
+		centerX.push_back(center.x);
+		centerY.push_back(center.y);
+		centerZ.push_back(center.z);
+		radius.push_back(sphereRadius);
+	}
+
+	size_t FrustumCuller::GetCount() const
+	{
+		return radius.size();
+	}
+
+	size_t FrustumCuller::Cull(const Frustum& frustum, std::vector<uint8_t>& visible) const
+	{
+		size_t count = radius.size();
+		visible.resize(count);
+
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+#ifdef NIGHTBIRD_CULL_SSE
+		__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+		for (int p = 0; p < 6; ++p)
+		{
+			planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+			planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+			planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+			planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+		}
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&centerX[i]);
+			__m128 y = _mm_loadu_ps(&centerY[i]);
+			__m128 z = _mm_loadu_ps(&centerZ[i]);
+			__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+			// A sphere is visible while its signed distance to every plane is at least -radius
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; ++p)
+			{
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planeX[p]), _mm_mul_ps(y, planeY[p])), _mm_add_ps(_mm_mul_ps(z, planeZ[p]), planeW[p]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+			}
+
+			int mask = _mm_movemask_ps(inside);
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				uint8_t laneVisible = (mask >> lane) & 1;
+				visible[i + lane] = laneVisible;
+				visibleCount += laneVisible;
+			}
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			bool sphereVisible = frustum.IntersectsSphere(glm::vec3(centerX[i], centerY[i], centerZ[i]), radius[i]);
+			visible[i] = sphereVisible ? 1 : 0;
+			visibleCount += sphereVisible ? 1 : 0;
+		}
+
+		return visibleCount;
+	}
+}
\ No newline at end of file
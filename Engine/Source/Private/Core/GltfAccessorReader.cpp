@@ -0,0 +1,126 @@
+#include "Core/GltfAccessorReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fastgltf/tools.hpp>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Core/Vertex.h"
+
+namespace Nightbird
+{
+	namespace
+	{
+		// Start and stride of the accessor's elements when they can be read as componentType without conversion
+		bool GetRawElements(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, fastgltf::ComponentType componentType, const std::byte*& data, size_t& stride)
+		{
+			if (accessor.sparse || !accessor.bufferViewIndex || accessor.normalized || accessor.componentType != componentType)
+				return false;
+
+			const auto& bufferView = asset.bufferViews[*accessor.bufferViewIndex];
+			size_t elementSize = fastgltf::getElementByteSize(accessor.type, accessor.componentType);
+			stride = bufferView.byteStride.value_or(elementSize);
+
+			auto bytes = fastgltf::DefaultBufferDataAdapter{}(asset, *accessor.bufferViewIndex);
+			if (accessor.count == 0 || accessor.byteOffset + (accessor.count - 1) * stride + elementSize > bytes.size())
+				return false;
+
+			data = bytes.data() + accessor.byteOffset;
+			return true;
+		}
+
+		template<typename T, typename Element>
+		void ReadAttribute(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<Vertex>& vertices, T Vertex::* member)
+		{
+			size_t count = std::min(accessor.count, vertices.size());
+
+			const std::byte* data = nullptr;
+			size_t stride = 0;
+			if (GetRawElements(asset, accessor, fastgltf::ComponentType::Float, data, stride))
+			{
+				// Same layout as the glm vector, a strided copy into the interleaved vertices
+				for (size_t i = 0; i < count; ++i)
+					memcpy(&(vertices[i].*member), data + i * stride, sizeof(T));
+				return;
+			}
+
+			fastgltf::iterateAccessorWithIndex<Element>(asset, accessor, [&](const Element& value, std::size_t index)
+				{
+					if (index < count)
+					{
+						T& destination = vertices[index].*member;
+						for (int c = 0; c < T::length(); ++c)
+							destination[c] = value[c];
+					}
+				});
+		}
+
+		void WidenIndices(const uint16_t* source, uint32_t* destination, size_t count)
+		{
+			size_t i = 0;
+
+#if defined(_M_X64) || defined(__SSE2__)
+			const __m128i zero = _mm_setzero_si128();
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i narrow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi16(narrow, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 4), _mm_unpackhi_epi16(narrow, zero));
+			}
+#endif
+
+			for (; i < count; ++i)
+				destination[i] = source[i];
+		}
+	}
+
+	void ReadVertexAttribute(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<Vertex>& vertices, glm::vec3 Vertex::* member)
+	{
+		ReadAttribute<glm::vec3, fastgltf::math::fvec3>(asset, accessor, vertices, member);
+	}
+
+	void ReadVertexAttribute(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<Vertex>& vertices, glm::vec2 Vertex::* member)
+	{
+		ReadAttribute<glm::vec2, fastgltf::math::fvec2>(asset, accessor, vertices, member);
+	}
+
+	void ReadIndices(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<uint32_t>& indices)
+	{
+		size_t offset = indices.size();
+		indices.resize(offset + accessor.count);
+		uint32_t* destination = indices.data() + offset;
+
+		const std::byte* data = nullptr;
+		size_t stride = 0;
+
+		// Index accessors are tightly packed and aligned to their component size
+		if (GetRawElements(asset, accessor, fastgltf::ComponentType::UnsignedShort, data, stride) && stride == sizeof(uint16_t))
+		{
+			WidenIndices(reinterpret_cast<const uint16_t*>(data), destination, accessor.count);
+			return;
+		}
+
+		if (GetRawElements(asset, accessor, fastgltf::ComponentType::UnsignedInt, data, stride) && stride == sizeof(uint32_t))
+		{
+			memcpy(destination, data, accessor.count * sizeof(uint32_t));
+			return;
+		}
+
+		if (GetRawElements(asset, accessor, fastgltf::ComponentType::UnsignedByte, data, stride) && stride == sizeof(uint8_t))
+		{
+			const uint8_t* source = reinterpret_cast<const uint8_t*>(data);
+			for (size_t i = 0; i < accessor.count; ++i)
+				destination[i] = source[i];
+			return;
+		}
+
+		fastgltf::iterateAccessorWithIndex<std::uint32_t>(asset, accessor, [&](std::uint32_t index, std::size_t i)
+			{
+				destination[i] = index;
+			});
+	}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "Core/Hash.h"
+
+#include <cstring>
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+
+		uint64_t Rotate(uint64_t value, int bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		uint64_t Mix(uint64_t hash, uint64_t word)
+		{
+			return Rotate(hash ^ (word * Prime2), 31) * Prime1;
+		}
+	}
+
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		// Four independent lanes keep the multiplies pipelined on large inputs
+		uint64_t lanes[4] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+
+		size_t offset = 0;
+		for (; offset + 32 <= size; offset += 32)
+		{
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				uint64_t word;
+				memcpy(&word, bytes + offset + lane * 8, sizeof(word));
+				lanes[lane] = Mix(lanes[lane], word);
+			}
+		}
+
+		uint64_t hash = Rotate(lanes[0], 1) + Rotate(lanes[1], 7) + Rotate(lanes[2], 12) + Rotate(lanes[3], 18);
+		hash = Mix(hash, static_cast<uint64_t>(size));
+
+		for (; offset + 8 <= size; offset += 8)
+		{
+			uint64_t word;
+			memcpy(&word, bytes + offset, sizeof(word));
+			hash = Mix(hash, word);
+		}
+
+		for (; offset < size; ++offset)
+			hash = Mix(hash, bytes[offset]);
+
+		// Final avalanche so nearby inputs spread over the whole range
+		hash ^= hash >> 33;
+		hash *= Prime2;
+		hash ^= hash >> 29;
+		return hash;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "Core/JobSystem.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Nightbird
+{
+	struct JobState
+	{
+		std::function<void()> function;
+		std::atomic<bool> cancelled{ false };
+		std::atomic<bool> done{ false };
+	};
+
+	namespace
+	{
+		constexpr size_t NoWorker = std::numeric_limits<size_t>::max();
+
+		thread_local const JobSystem* currentSystem = nullptr;
+		thread_local size_t currentWorkerIndex = NoWorker;
+		thread_local JobState* currentJob = nullptr;
+	}
+
+	JobHandle::JobHandle(std::shared_ptr<JobState> state)
+		: state(std::move(state))
+	{
+	}
+
+	bool JobHandle::IsValid() const
+	{
+		return state != nullptr;
+	}
+
+	bool JobHandle::IsDone() const
+	{
+		return !state || state->done;
+	}
+
+	bool JobHandle::IsCancelled() const
+	{
+		return state && state->cancelled;
+	}
+
+	void JobHandle::Cancel()
+	{
+		if (state)
+			state->cancelled = true;
+	}
+
+	JobSystem::JobSystem(size_t workerCount)
+	{
+		if (workerCount == 0)
+			workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		workers.reserve(workerCount);
+		for (size_t i = 0; i < workerCount; ++i)
+			workers.push_back(std::make_unique<Worker>());
+
+		stats.resize(workerCount);
+		sampleTime = std::chrono::steady_clock::now();
+
+		// Started after every worker exists, so stealing never sees a partial array
+		for (size_t i = 0; i < workerCount; ++i)
+			workers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping = true;
+		}
+		workAvailable.notify_all();
+
+		for (auto& worker : workers)
+			worker->thread.join();
+	}
+
+	JobHandle JobSystem::Schedule(std::function<void()> job, JobPriority priority)
+	{
+		auto state = std::make_shared<JobState>();
+		state->function = std::move(job);
+
+		// Jobs spawned by a worker stay local until someone steals them
+		size_t queueIndex = currentSystem == this ? currentWorkerIndex : nextQueue++ % workers.size();
+
+		{
+			Worker& worker = *workers[queueIndex];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.queues[static_cast<size_t>(priority)].push_back(state);
+		}
+
+		++queuedJobs;
+
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		workAvailable.notify_one();
+		progress.notify_all();
+
+		return JobHandle(std::move(state));
+	}
+
+	void JobSystem::Wait(const JobHandle& handle)
+	{
+		if (!handle.state)
+			return;
+
+		size_t workerIndex = currentSystem == this ? currentWorkerIndex : NoWorker;
+
+		while (!handle.state->done)
+		{
+			if (auto job = TryGetJob(workerIndex))
+			{
+				Execute(job, workerIndex);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			progress.wait(lock, [&]() { return handle.state->done || queuedJobs > 0; });
+		}
+	}
+
+	size_t JobSystem::ParallelFor(size_t count, const std::function<void(size_t)>& function, JobPriority priority)
+	{
+		if (count == 0)
+			return 0;
+
+		// Helpers that start after the caller finished must not touch function, it lives on the caller's stack
+		struct Shared
+		{
+			std::mutex mutex;
+			std::condition_variable idle;
+			std::atomic<size_t> next{ 0 };
+			size_t active = 0;
+			size_t joined = 0;
+			bool finished = false;
+		};
+
+		auto shared = std::make_shared<Shared>();
+		const std::function<void(size_t)>* body = &function;
+
+		size_t helperCount = std::min(workers.size(), count - 1);
+		for (size_t i = 0; i < helperCount; ++i)
+		{
+			Schedule([shared, body, count]()
+				{
+					{
+						std::lock_guard<std::mutex> lock(shared->mutex);
+						if (shared->finished || shared->next >= count)
+							return;
+						++shared->active;
+						++shared->joined;
+					}
+
+					for (size_t index = shared->next++; index < count; index = shared->next++)
+						(*body)(index);
+
+					{
+						std::lock_guard<std::mutex> lock(shared->mutex);
+						--shared->active;
+					}
+					shared->idle.notify_all();
+				}, priority);
+		}
+
+		for (size_t index = shared->next++; index < count; index = shared->next++)
+			function(index);
+
+		std::unique_lock<std::mutex> lock(shared->mutex);
+		shared->finished = true;
+		shared->idle.wait(lock, [&]() { return shared->active == 0; });
+
+		return shared->joined + 1;
+	}
+
+	bool JobSystem::IsCurrentJobCancelled()
+	{
+		return currentJob && currentJob->cancelled;
+	}
+
+	size_t JobSystem::GetWorkerCount() const
+	{
+		return workers.size();
+	}
+
+	void JobSystem::UpdateStats()
+	{
+		auto now = std::chrono::steady_clock::now();
+		double elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sampleTime).count());
+		sampleTime = now;
+
+		for (size_t i = 0; i < workers.size(); ++i)
+		{
+			Worker& worker = *workers[i];
+
+			// Busy time is credited when a job finishes, so long jobs show up in one sample
+			uint64_t busy = worker.busyNanoseconds;
+			double fraction = elapsed > 0.0 ? static_cast<double>(busy - worker.sampledBusyNanoseconds) / elapsed : 0.0;
+			worker.sampledBusyNanoseconds = busy;
+
+			stats[i].jobsExecuted = worker.jobsExecuted;
+			stats[i].jobsStolen = worker.jobsStolen;
+			stats[i].utilization = static_cast<float>(std::min(fraction, 1.0));
+		}
+	}
+
+	const std::vector<JobWorkerStats>& JobSystem::GetWorkerStats() const
+	{
+		return stats;
+	}
+
+	void JobSystem::WorkerLoop(size_t workerIndex)
+	{
+		currentSystem = this;
+		currentWorkerIndex = workerIndex;
+
+		while (true)
+		{
+			if (auto job = TryGetJob(workerIndex))
+			{
+				Execute(job, workerIndex);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			workAvailable.wait(lock, [&]() { return stopping || queuedJobs > 0; });
+
+			// Queued jobs are drained before shutdown so their handles always complete
+			if (stopping && queuedJobs == 0)
+				break;
+		}
+	}
+
+	std::shared_ptr<JobState> JobSystem::TryGetJob(size_t workerIndex)
+	{
+		if (queuedJobs == 0)
+			return nullptr;
+
+		size_t workerCount = workers.size();
+		size_t start = workerIndex == NoWorker ? 0 : workerIndex;
+
+		for (size_t priority = 0; priority < static_cast<size_t>(JobPriority::Count); ++priority)
+		{
+			for (size_t offset = 0; offset < workerCount; ++offset)
+			{
+				size_t victimIndex = (start + offset) % workerCount;
+				bool own = victimIndex == workerIndex;
+
+				Worker& victim = *workers[victimIndex];
+				std::shared_ptr<JobState> job;
+				{
+					std::lock_guard<std::mutex> lock(victim.mutex);
+					auto& queue = victim.queues[priority];
+					if (queue.empty())
+						continue;
+
+					if (own)
+					{
+						job = std::move(queue.back());
+						queue.pop_back();
+					}
+					else
+					{
+						job = std::move(queue.front());
+						queue.pop_front();
+					}
+				}
+
+				--queuedJobs;
+				if (!own && workerIndex != NoWorker)
+					++workers[workerIndex]->jobsStolen;
+
+				return job;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void JobSystem::Execute(const std::shared_ptr<JobState>& job, size_t workerIndex)
+	{
+		if (!job->cancelled)
+		{
+			// Nested jobs run inside a Wait, only the outermost one is timed
+			JobState* parentJob = currentJob;
+			currentJob = job.get();
+
+			auto start = std::chrono::steady_clock::now();
+			job->function();
+			auto busy = std::chrono::steady_clock::now() - start;
+
+			currentJob = parentJob;
+
+			if (workerIndex != NoWorker)
+			{
+				if (!parentJob)
+					workers[workerIndex]->busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count();
+				++workers[workerIndex]->jobsExecuted;
+			}
+		}
+
+		// Drops captured state before waiters resume
+		job->function = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			job->done = true;
+		}
+		progress.notify_all();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "Core/LightClusterGrid.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define NIGHTBIRD_CLUSTER_SSE
+#endif
+
+#include "Core/PointLightData.h"
+
+namespace Nightbird
+{
+	static_assert(CLUSTER_GRID_X % 4 == 0, "Cluster rows are tested four at a time");
+	static_assert(CLUSTER_COUNT < 0xFFFF && MAX_POINT_LIGHTS < 0xFFFF, "Cluster and light indices are packed into 16 bits each");
+
+	LightClusterGrid::LightClusterGrid()
+	{
+		clusters.resize(CLUSTER_COUNT);
+		clusterCounts.resize(CLUSTER_COUNT);
+
+		boundsMinX.resize(CLUSTER_COUNT);
+		boundsMinY.resize(CLUSTER_COUNT);
+		boundsMinZ.resize(CLUSTER_COUNT);
+		boundsMaxX.resize(CLUSTER_COUNT);
+		boundsMaxY.resize(CLUSTER_COUNT);
+		boundsMaxZ.resize(CLUSTER_COUNT);
+
+		metaUBO.gridSize = glm::uvec4(CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z, 0);
+	}
+
+	LightClusterGrid::~LightClusterGrid()
+	{
+
+	}
+
+	const std::vector<LightClusterRange>& LightClusterGrid::GetClusters() const
+	{
+		return clusters;
+	}
+
+	const std::vector<uint32_t>& LightClusterGrid::GetLightIndices() const
+	{
+		return lightIndices;
+	}
+
+	const LightClusterMetaUBO& LightClusterGrid::GetMetaUBO() const
+	{
+		return metaUBO;
+	}
+
+	uint32_t LightClusterGrid::GetSlice(float depth) const
+	{
+		float slice = std::log(depth) * metaUBO.depthParams.x + metaUBO.depthParams.y;
+		return static_cast<uint32_t>(std::clamp(slice, 0.0f, static_cast<float>(CLUSTER_GRID_Z - 1)));
+	}
+
+	void LightClusterGrid::BuildClusterBounds(const glm::mat4& projection, float nearPlane, float farPlane)
+	{
+		float logRatio = std::log(farPlane / nearPlane);
+		metaUBO.depthParams = glm::vec4(CLUSTER_GRID_Z / logRatio, -(CLUSTER_GRID_Z * std::log(nearPlane)) / logRatio, nearPlane, farPlane);
+
+		// View space x = ndc.x * depth / P[0][0], the sign of P[1][1] carries the Vulkan y flip
+		float invScaleX = 1.0f / projection[0][0];
+		float invScaleY = 1.0f / projection[1][1];
+
+		for (uint32_t z = 0; z < CLUSTER_GRID_Z; ++z)
+		{
+			float sliceNear = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / CLUSTER_GRID_Z);
+			float sliceFar = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z + 1) / CLUSTER_GRID_Z);
+
+			for (uint32_t y = 0; y < CLUSTER_GRID_Y; ++y)
+			{
+				float ndcY0 = -1.0f + 2.0f * y / CLUSTER_GRID_Y;
+				float ndcY1 = -1.0f + 2.0f * (y + 1) / CLUSTER_GRID_Y;
+
+				float ys[4] = { ndcY0 * sliceNear * invScaleY, ndcY1 * sliceNear * invScaleY, ndcY0 * sliceFar * invScaleY, ndcY1 * sliceFar * invScaleY };
+
+				for (uint32_t x = 0; x < CLUSTER_GRID_X; ++x)
+				{
+					float ndcX0 = -1.0f + 2.0f * x / CLUSTER_GRID_X;
+					float ndcX1 = -1.0f + 2.0f * (x + 1) / CLUSTER_GRID_X;
+
+					float xs[4] = { ndcX0 * sliceNear * invScaleX, ndcX1 * sliceNear * invScaleX, ndcX0 * sliceFar * invScaleX, ndcX1 * sliceFar * invScaleX };
+
+					uint32_t index = x + y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+
+					boundsMinX[index] = *std::min_element(xs, xs + 4);
+					boundsMaxX[index] = *std::max_element(xs, xs + 4);
+					boundsMinY[index] = *std::min_element(ys, ys + 4);
+					boundsMaxY[index] = *std::max_element(ys, ys + 4);
+					boundsMinZ[index] = -sliceFar;
+					boundsMaxZ[index] = -sliceNear;
+				}
+			}
+		}
+	}
+
+	void LightClusterGrid::Build(const std::vector<PointLightData>& pointLights, const glm::mat4& view, const glm::mat4& projection, VkExtent2D extent, float nearPlane, float farPlane)
+	{
+		metaUBO.tileSize = glm::vec4(extent.width / static_cast<float>(CLUSTER_GRID_X), extent.height / static_cast<float>(CLUSTER_GRID_Y), 0.0f, 0.0f);
+
+		if (projection != cachedProjection || nearPlane != cachedNear || farPlane != cachedFar)
+		{
+			BuildClusterBounds(projection, nearPlane, farPlane);
+			cachedProjection = projection;
+			cachedNear = nearPlane;
+			cachedFar = farPlane;
+		}
+
+		clusterLightPairs.clear();
+		std::fill(clusterCounts.begin(), clusterCounts.end(), 0);
+
+		const float scaleX = projection[0][0];
+		const float scaleY = projection[1][1];
+
+		uint32_t lightCount = static_cast<uint32_t>(std::min<size_t>(pointLights.size(), MAX_POINT_LIGHTS));
+
+		for (uint32_t lightIndex = 0; lightIndex < lightCount; ++lightIndex)
+		{
+			const glm::vec4& positionRadius = pointLights[lightIndex].positionRadius;
+			float radius = positionRadius.w;
+			if (radius <= 0.0f)
+				continue;
+
+			glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(positionRadius), 1.0f));
+
+			float depthMin = -center.z - radius;
+			float depthMax = -center.z + radius;
+			if (depthMax < nearPlane || depthMin > farPlane)
+				continue;
+
+			depthMin = std::max(depthMin, nearPlane);
+			depthMax = std::min(depthMax, farPlane);
+
+			// Conservative screen rect of the sphere's view space box
+			float x0 = center.x - radius, x1 = center.x + radius;
+			float y0 = center.y - radius, y1 = center.y + radius;
+
+			float ndcXMin = scaleX * std::min(x0 / depthMin, x0 / depthMax);
+			float ndcXMax = scaleX * std::max(x1 / depthMin, x1 / depthMax);
+			float ndcYA = scaleY * std::min(y0 / depthMin, y0 / depthMax);
+			float ndcYB = scaleY * std::max(y1 / depthMin, y1 / depthMax);
+			float ndcYMin = std::min(ndcYA, ndcYB);
+			float ndcYMax = std::max(ndcYA, ndcYB);
+
+			if (ndcXMax < -1.0f || ndcXMin > 1.0f || ndcYMax < -1.0f || ndcYMin > 1.0f)
+				continue;
+
+			auto toTile = [](float ndc, uint32_t tileCount)
+				{
+					float tile = std::floor((ndc * 0.5f + 0.5f) * tileCount);
+					return static_cast<uint32_t>(std::clamp(tile, 0.0f, static_cast<float>(tileCount - 1)));
+				};
+
+			uint32_t tileXMin = toTile(ndcXMin, CLUSTER_GRID_X);
+			uint32_t tileXMax = toTile(ndcXMax, CLUSTER_GRID_X);
+			uint32_t tileYMin = toTile(ndcYMin, CLUSTER_GRID_Y);
+			uint32_t tileYMax = toTile(ndcYMax, CLUSTER_GRID_Y);
+
+			uint32_t sliceMin = GetSlice(depthMin);
+			uint32_t sliceMax = GetSlice(depthMax);
+
+			float radiusSquared = radius * radius;
+
+#ifdef NIGHTBIRD_CLUSTER_SSE
+			const __m128 centerX = _mm_set1_ps(center.x);
+			const __m128 centerY = _mm_set1_ps(center.y);
+			const __m128 centerZ = _mm_set1_ps(center.z);
+			const __m128 radius4 = _mm_set1_ps(radiusSquared);
+			const __m128 zero = _mm_setzero_ps();
+#endif
+
+			for (uint32_t z = sliceMin; z <= sliceMax; ++z)
+			{
+				for (uint32_t y = tileYMin; y <= tileYMax; ++y)
+				{
+					uint32_t rowBase = y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+
+#ifdef NIGHTBIRD_CLUSTER_SSE
+					for (uint32_t x = tileXMin & ~3u; x <= tileXMax; x += 4)
+					{
+						uint32_t base = rowBase + x;
+
+						// Squared distance from the light center to each cluster box
+						__m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&boundsMinX[base]), centerX), zero), _mm_max_ps(_mm_sub_ps(centerX, _mm_loadu_ps(&boundsMaxX[base])), zero));
+						__m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&boundsMinY[base]), centerY), zero), _mm_max_ps(_mm_sub_ps(centerY, _mm_loadu_ps(&boundsMaxY[base])), zero));
+						__m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&boundsMinZ[base]), centerZ), zero), _mm_max_ps(_mm_sub_ps(centerZ, _mm_loadu_ps(&boundsMaxZ[base])), zero));
+
+						__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+						int mask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, radius4));
+
+						for (uint32_t lane = 0; lane < 4; ++lane)
+						{
+							uint32_t tileX = x + lane;
+							if ((mask & (1 << lane)) && tileX >= tileXMin && tileX <= tileXMax)
+							{
+								clusterLightPairs.push_back(((base + lane) << 16) | lightIndex);
+								clusterCounts[base + lane]++;
+							}
+						}
+					}
+#else
+					for (uint32_t x = tileXMin; x <= tileXMax; ++x)
+					{
+						uint32_t index = rowBase + x;
+
+						float dx = std::max(boundsMinX[index] - center.x, 0.0f) + std::max(center.x - boundsMaxX[index], 0.0f);
+						float dy = std::max(boundsMinY[index] - center.y, 0.0f) + std::max(center.y - boundsMaxY[index], 0.0f);
+						float dz = std::max(boundsMinZ[index] - center.z, 0.0f) + std::max(center.z - boundsMaxZ[index], 0.0f);
+
+						if (dx * dx + dy * dy + dz * dz <= radiusSquared)
+						{
+							clusterLightPairs.push_back((index << 16) | lightIndex);
+							clusterCounts[index]++;
+						}
+					}
+#endif
+				}
+			}
+		}
+
+		// Counting sort of the pairs into contiguous per cluster ranges
+		uint32_t offset = 0;
+		bool truncated = false;
+		for (uint32_t cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+		{
+			uint32_t count = std::min(clusterCounts[cluster], MAX_CLUSTER_LIGHT_INDICES - offset);
+			truncated |= count < clusterCounts[cluster];
+
+			clusters[cluster] = { offset, count };
+			offset += count;
+			clusterCounts[cluster] = 0;
+		}
+
+		if (truncated && !truncationReported)
+			std::cerr << "Light cluster index list full, some lights were dropped" << std::endl;
+		truncationReported = truncated;
+
+		lightIndices.resize(offset);
+
+		for (uint32_t pair : clusterLightPairs)
+		{
+			uint32_t cluster = pair >> 16;
+			if (clusterCounts[cluster] < clusters[cluster].count)
+				lightIndices[clusters[cluster].offset + clusterCounts[cluster]++] = pair & 0xFFFF;
+		}
+	}
+}
\ No newline at end of file
@@ -1,11 +1,13 @@
 #include "Core/Mesh.h"
 
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 
 #include "Vulkan/Device.h"
 #include "Vulkan/Texture.h"
 #include "Core/MeshPrimitive.h"
+#include "Core/TriangleBVH.h"
 
 #include <stb_image.h>
 
@@ -41,6 +43,85 @@ namespace Nightbird
 
 	void Mesh::AddPrimitive(std::unique_ptr<MeshPrimitive> meshPrimitive)
 	{
+		bounds.Expand(meshPrimitive->GetBounds());
+		boundingSphere.Expand(meshPrimitive->GetBoundingSphere());
 		primitives.push_back(std::move(meshPrimitive));
+
+		size_t lodCount = 0;
+		for (const auto& primitive : primitives)
+			lodCount = std::max(lodCount, primitive->GetLodCount());
+
+		lodErrors.assign(lodCount, 0.0f);
+		for (size_t level = 0; level < lodCount; ++level)
+		{
+			for (const auto& primitive : primitives)
+				lodErrors[level] = std::max(lodErrors[level], primitive->GetLod(level).error);
+		}
+	}
+
+	std::vector<std::unique_ptr<MeshPrimitive>> Mesh::ReleasePrimitives()
+	{
+		resident = false;
+		return std::move(primitives);
+	}
+
+	bool Mesh::IsResident() const
+	{
+		return resident;
+	}
+
+	void Mesh::SetResident(bool value)
+	{
+		resident = value;
+	}
+
+	void Mesh::MarkUsed(uint64_t frame) const
+	{
+		lastUsedFrame = frame;
+	}
+
+	uint64_t Mesh::GetLastUsedFrame() const
+	{
+		return lastUsedFrame;
+	}
+
+	VkDeviceSize Mesh::GetMemorySize() const
+	{
+		VkDeviceSize size = 0;
+		for (const auto& primitive : primitives)
+			size += primitive->GetMemorySize();
+		return size;
+	}
+
+	const AABB& Mesh::GetBounds() const
+	{
+		return bounds;
+	}
+
+	const BoundingSphere& Mesh::GetBoundingSphere() const
+	{
+		return boundingSphere;
+	}
+
+	size_t Mesh::GetLodCount() const
+	{
+		return std::max<size_t>(lodErrors.size(), 1);
+	}
+
+	float Mesh::GetLodError(size_t level) const
+	{
+		if (lodErrors.empty())
+			return 0.0f;
+		return lodErrors[std::min(level, lodErrors.size() - 1)];
+	}
+
+	const TriangleBVH* Mesh::GetCollision() const
+	{
+		return collision.get();
+	}
+
+	void Mesh::SetCollision(std::shared_ptr<const TriangleBVH> triangles)
+	{
+		collision = std::move(triangles);
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Core/MeshInstance.h"
 
 #include <iostream>
+#include <algorithm>
 
 #include "Vulkan/Config.h"
 #include "Vulkan/Device.h"
@@ -89,6 +90,42 @@ namespace Nightbird
 		MeshUBO ubo{};
 		ubo.model = GetWorldMatrix();
 
+		for (uint32_t i = 0; i < pointLightCount; ++i)
+			ubo.pointLightIndices[i / 4][i % 4] = pointLightIndices[i];
+		ubo.pointLightCount = pointLightCount;
+
 		memcpy(uniformBuffers[currentImage].GetMappedData(), &ubo, sizeof(ubo));
 	}
+
+	AABB MeshInstance::GetWorldBounds() const
+	{
+		return mesh->GetBounds().Transform(GetWorldMatrix());
+	}
+
+	void MeshInstance::SetPointLights(const uint32_t* indices, uint32_t count)
+	{
+		pointLightCount = std::min<uint32_t>(count, MAX_OBJECT_POINT_LIGHTS);
+		for (uint32_t i = 0; i < pointLightCount; ++i)
+			pointLightIndices[i] = indices[i];
+	}
+
+	bool MeshInstance::IsOccluder() const
+	{
+		return occluder;
+	}
+
+	void MeshInstance::SetOccluder(bool value)
+	{
+		occluder = value;
+	}
+
+	uint32_t MeshInstance::GetLodLevel() const
+	{
+		return lodLevel;
+	}
+
+	void MeshInstance::SetLodLevel(uint32_t level)
+	{
+		lodLevel = level;
+	}
 }
\ No newline at end of file
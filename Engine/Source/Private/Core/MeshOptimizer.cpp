@@ -0,0 +1,349 @@
+#include "Core/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <glm/glm.hpp>
+
+#include "Core/Vertex.h"
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr size_t CacheSize = 32;
+		constexpr size_t MaxValence = 32;
+
+		// Tuned values from Forsyth's paper, the last triangle's vertices score flat so the strip doesn't double back
+		constexpr float CacheDecayPower = 1.5f;
+		constexpr float LastTriangleScore = 0.75f;
+		constexpr float ValenceBoostScale = 2.0f;
+		constexpr float ValenceBoostPower = 0.5f;
+
+		struct ScoreTables
+		{
+			float cache[CacheSize];
+			float valence[MaxValence + 1];
+
+			ScoreTables()
+			{
+				for (size_t i = 0; i < CacheSize; ++i)
+				{
+					if (i < 3)
+						cache[i] = LastTriangleScore;
+					else
+						cache[i] = std::pow(1.0f - float(i - 3) / float(CacheSize - 3), CacheDecayPower);
+				}
+
+				valence[0] = 0.0f;
+				for (size_t i = 1; i <= MaxValence; ++i)
+					valence[i] = ValenceBoostScale * std::pow(float(i), -ValenceBoostPower);
+			}
+		};
+
+		float VertexScore(const ScoreTables& tables, int32_t cachePosition, uint32_t valence)
+		{
+			// No triangles left to draw
+			if (valence == 0)
+				return -1.0f;
+
+			float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+			score += valence <= MaxValence ? tables.valence[valence] : ValenceBoostScale * std::pow(float(valence), -ValenceBoostPower);
+
+			return score;
+		}
+
+		// FIFO cache simulation, returns the number of vertices transformed
+		size_t CountCacheMisses(const uint32_t* indices, size_t indexCount, std::vector<uint32_t>& timestamps, uint32_t& time, size_t cacheSize)
+		{
+			size_t misses = 0;
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				uint32_t index = indices[i];
+				if (time - timestamps[index] > cacheSize)
+				{
+					timestamps[index] = time++;
+					++misses;
+				}
+			}
+			return misses;
+		}
+
+		// Every entry point indexes per-vertex arrays by index, one out of range would write past them
+		bool IndicesInRange(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+		{
+			return std::all_of(indices, indices + indexCount, [vertexCount](uint32_t index) { return index < vertexCount; });
+		}
+	}
+
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || !IndicesInRange(indices, indexCount, vertexCount))
+			return;
+
+		static const ScoreTables tables;
+
+		// Triangles of each vertex, live ones are kept at the front of each range
+		std::vector<uint32_t> valence(vertexCount, 0);
+		for (size_t i = 0; i < triangleCount * 3; ++i)
+			++valence[indices[i]];
+
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; ++v)
+			offsets[v + 1] = offsets[v] + valence[v];
+
+		std::vector<uint32_t> adjacency(offsets[vertexCount]);
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (uint32_t t = 0; t < triangleCount; ++t)
+			for (int k = 0; k < 3; ++k)
+				adjacency[fill[indices[t * 3 + k]]++] = t;
+
+		std::vector<int32_t> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v)
+			vertexScores[v] = VertexScore(tables, -1, valence[v]);
+
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		std::vector<uint32_t> output;
+		output.reserve(triangleCount * 3);
+
+		// Three extra slots hold the incoming triangle before the tail is evicted
+		uint32_t cache[CacheSize + 3];
+		uint32_t newCache[CacheSize + 3];
+		size_t cacheCount = 0;
+
+		size_t cursor = 0;
+		uint32_t triangle = 0;
+
+		for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+		{
+			emitted[triangle] = 1;
+
+			const uint32_t* corners = &indices[triangle * 3];
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t v = corners[k];
+				output.push_back(v);
+
+				// Swap the triangle out of the live part of the vertex's range
+				uint32_t* begin = &adjacency[offsets[v]];
+				uint32_t* end = begin + valence[v];
+				uint32_t* found = std::find(begin, end, triangle);
+				std::swap(*found, *(end - 1));
+				--valence[v];
+			}
+
+			// Most recent triangle goes to the front, everything else keeps its order
+			size_t newCount = 0;
+			for (int k = 0; k < 3; ++k)
+			{
+				if (std::find(newCache, newCache + newCount, corners[k]) == newCache + newCount)
+					newCache[newCount++] = corners[k];
+			}
+			for (size_t i = 0; i < cacheCount; ++i)
+			{
+				uint32_t v = cache[i];
+				if (v != corners[0] && v != corners[1] && v != corners[2])
+					newCache[newCount++] = v;
+			}
+
+			for (size_t i = CacheSize; i < newCount; ++i)
+			{
+				cachePosition[newCache[i]] = -1;
+				vertexScores[newCache[i]] = VertexScore(tables, -1, valence[newCache[i]]);
+			}
+
+			cacheCount = std::min(newCount, CacheSize);
+			for (size_t i = 0; i < cacheCount; ++i)
+			{
+				uint32_t v = newCache[i];
+				cache[i] = v;
+				cachePosition[v] = static_cast<int32_t>(i);
+				vertexScores[v] = VertexScore(tables, cachePosition[v], valence[v]);
+			}
+
+			// Next triangle is the best scoring one touching the cache
+			float bestScore = -1.0f;
+			uint32_t best = UINT32_MAX;
+			for (size_t i = 0; i < cacheCount; ++i)
+			{
+				uint32_t v = cache[i];
+				for (uint32_t a = offsets[v]; a < offsets[v] + valence[v]; ++a)
+				{
+					uint32_t t = adjacency[a];
+					float score = vertexScores[indices[t * 3 + 0]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+					if (score > bestScore)
+					{
+						bestScore = score;
+						best = t;
+					}
+				}
+			}
+
+			// Cache ran dry, continue with the next triangle in input order
+			if (best == UINT32_MAX)
+			{
+				while (cursor < triangleCount && emitted[cursor])
+					++cursor;
+				best = static_cast<uint32_t>(cursor);
+			}
+
+			triangle = best;
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const std::vector<Vertex>& vertices, float threshold)
+	{
+		// Matches the cache ComputeAcmr reports for
+		constexpr size_t SimulatedCacheSize = 16;
+		// Smaller clusters cost more in cache misses than they save in overdraw
+		constexpr size_t MinClusterTriangles = 64;
+
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount < MinClusterTriangles * 2 || !IndicesInRange(indices, indexCount, vertices.size()))
+			return;
+
+		std::vector<uint32_t> timestamps(vertices.size(), 0);
+		uint32_t time = SimulatedCacheSize + 1;
+
+		// Hard boundaries, where the cache order started over with all three vertices missing
+		std::vector<size_t> hardClusters;
+		for (size_t t = 0; t < triangleCount; ++t)
+		{
+			if (CountCacheMisses(&indices[t * 3], 3, timestamps, time, SimulatedCacheSize) == 3)
+				hardClusters.push_back(t);
+		}
+		hardClusters.push_back(triangleCount);
+
+		// Soft boundaries inside each, starting every cluster with a cold cache since it may be drawn in any order
+		std::vector<size_t> clusters;
+		for (size_t h = 0; h + 1 < hardClusters.size(); ++h)
+		{
+			size_t start = hardClusters[h];
+			size_t end = hardClusters[h + 1];
+
+			time += SimulatedCacheSize + 1;
+			float targetAcmr = float(CountCacheMisses(&indices[start * 3], (end - start) * 3, timestamps, time, SimulatedCacheSize)) / float(end - start) * threshold;
+
+			time += SimulatedCacheSize + 1;
+			size_t clusterStart = start;
+			size_t misses = 0;
+			clusters.push_back(start);
+
+			for (size_t t = start; t < end; ++t)
+			{
+				misses += CountCacheMisses(&indices[t * 3], 3, timestamps, time, SimulatedCacheSize);
+
+				size_t clusterTriangles = t + 1 - clusterStart;
+				if (clusterTriangles >= MinClusterTriangles && end - (t + 1) >= MinClusterTriangles && float(misses) / float(clusterTriangles) <= targetAcmr)
+				{
+					clusterStart = t + 1;
+					misses = 0;
+					time += SimulatedCacheSize + 1;
+					clusters.push_back(clusterStart);
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+
+		size_t clusterCount = clusters.size() - 1;
+		if (clusterCount < 2)
+			return;
+
+		// Area weighted centroid and normal per cluster
+		std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+		std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+		std::vector<float> clusterAreas(clusterCount, 0.0f);
+		glm::vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+			{
+				const glm::vec3& p0 = vertices[indices[t * 3 + 0]].position;
+				const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+				const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+				glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+				clusterCentroids[c] += centroid * area;
+				clusterNormals[c] += normal;
+				clusterAreas[c] += area;
+			}
+
+			meshCentroid += clusterCentroids[c];
+			meshArea += clusterAreas[c];
+		}
+
+		if (meshArea <= 0.0f)
+			return;
+
+		meshCentroid /= meshArea;
+
+		std::vector<float> sortKeys(clusterCount, 0.0f);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			float normalLength = glm::length(clusterNormals[c]);
+			if (clusterAreas[c] <= 0.0f || normalLength <= 0.0f)
+				continue;
+
+			glm::vec3 centroid = clusterCentroids[c] / clusterAreas[c];
+			sortKeys[c] = glm::dot(centroid - meshCentroid, clusterNormals[c] / normalLength);
+		}
+
+		std::vector<uint32_t> order(clusterCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+			{
+				return sortKeys[a] > sortKeys[b];
+			});
+
+		std::vector<uint32_t> output;
+		output.reserve(triangleCount * 3);
+		for (uint32_t c : order)
+			output.insert(output.end(), &indices[clusters[c] * 3], &indices[clusters[c + 1] * 3]);
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		if (!IndicesInRange(indices.data(), indices.size(), vertices.size()))
+			return;
+
+		std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+		std::vector<Vertex> reordered;
+		reordered.reserve(vertices.size());
+
+		for (uint32_t& index : indices)
+		{
+			if (remap[index] == UINT32_MAX)
+			{
+				remap[index] = static_cast<uint32_t>(reordered.size());
+				reordered.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+
+		vertices = std::move(reordered);
+	}
+
+	float ComputeAcmr(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || !IndicesInRange(indices, indexCount, vertexCount))
+			return 0.0f;
+
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t time = static_cast<uint32_t>(cacheSize) + 1;
+
+		return float(CountCacheMisses(indices, triangleCount * 3, timestamps, time, cacheSize)) / float(triangleCount);
+	}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Core/MeshPrimitive.h"
 
 #include <iostream>
+#include <algorithm>
 
 #include "Vulkan/Config.h"
 #include "Vulkan/Helpers.h"
@@ -10,30 +11,64 @@
 #include "Vulkan/UniformBuffer.h"
 #include "Core/MaterialFactorsUBO.h"
 #include "Core/Vertex.h"
+#include "Core/ShaderVariant.h"
 
 namespace Nightbird
 {
 	MeshPrimitive::MeshPrimitive(VulkanDevice* device, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool, const MeshPrimitiveInfo& info)
 		:
-		device(device),
-		materialDescriptorSetLayout(materialDescriptorSetLayout),
 		baseColorFactor(info.baseColorFactor),
 		metallicFactor(info.metallicFactor),
 		roughnessFactor(info.roughnessFactor),
 		baseColorTexture(info.baseColorTexture),
 		metallicRoughnessTexture(info.metallicRoughnessTexture),
 		normalTexture(info.normalTexture),
+		device(device),
 		transparencyEnabled(info.enableTransparency),
-		doubleSided(info.doubleSided)
+		doubleSided(info.doubleSided),
+		lods(info.lods),
+		bounds(info.bounds),
+		boundingSphere(info.boundingSphere),
+		materialDescriptorSetLayout(materialDescriptorSetLayout),
+		descriptorPool(descriptorPool)
 	{
-		CreateVertexBuffer(info.vertices);
-		CreateIndexBuffer(info.indices);
+		if (!bounds.IsValid())
+		{
+			for (const Vertex& vertex : info.vertices)
+				bounds.Expand(vertex.position);
+		}
+
+		size_t indexCount = info.packed.vertices ? info.packed.indexCount : info.indices.size();
+
+		if (!boundingSphere.IsValid())
+			boundingSphere = BoundingSphere::FromAABB(bounds);
+
+		if (info.hasBaseColorTexture)
+			shaderVariantKey |= ShaderVariant::BaseColorTexture;
+		if (info.hasMetallicRoughnessTexture)
+			shaderVariantKey |= ShaderVariant::MetallicRoughnessTexture;
+
+		if (lods.empty())
+			lods.push_back(MeshLod{ 0, static_cast<uint32_t>(indexCount), 0.0f });
+
+		if (info.packed.vertices)
+		{
+			CreateBuffers(info.packed);
+		}
+		else
+		{
+			CreateVertexBuffer(info.vertices);
+			CreateIndexBuffer(info.indices, info.vertices.size());
+		}
 		CreateMaterialFactorsUniformBuffer();
-		CreateMaterialDescriptorSets(descriptorPool);
+		CreateMaterialDescriptorSets();
 	}
 
 	MeshPrimitive::~MeshPrimitive()
 	{
+		if (!materialDescriptorSets.empty())
+			vkFreeDescriptorSets(device->GetLogical(), descriptorPool, static_cast<uint32_t>(materialDescriptorSets.size()), materialDescriptorSets.data());
+
 		delete materialFactorsUniformBuffer;
 		delete indexBuffer;
 		delete vertexBuffer;
@@ -44,6 +79,46 @@ namespace Nightbird
 		return indicesSize;
 	}
 
+	VkIndexType MeshPrimitive::GetIndexType() const
+	{
+		return indexType;
+	}
+
+	size_t MeshPrimitive::GetLodCount() const
+	{
+		return lods.size();
+	}
+
+	const MeshLod& MeshPrimitive::GetLod(size_t level) const
+	{
+		return lods[std::min(level, lods.size() - 1)];
+	}
+
+	VkDeviceSize MeshPrimitive::GetMemorySize() const
+	{
+		return vertexBuffer->GetSize() + indexBuffer->GetSize() + sizeof(MaterialFactorsUBO);
+	}
+
+	const AABB& MeshPrimitive::GetBounds() const
+	{
+		return bounds;
+	}
+
+	const BoundingSphere& MeshPrimitive::GetBoundingSphere() const
+	{
+		return boundingSphere;
+	}
+
+	const VertexDecode& MeshPrimitive::GetVertexDecode() const
+	{
+		return vertexDecode;
+	}
+
+	const std::array<VkDeviceSize, 3>& MeshPrimitive::GetTexCoordOffsets() const
+	{
+		return texCoordOffsets;
+	}
+
 	VkDescriptorImageInfo MeshPrimitive::GetBaseColorInfo() const
 	{
 		VkDescriptorImageInfo baseColorInfo{};
@@ -89,6 +164,11 @@ namespace Nightbird
 		return doubleSided;
 	}
 
+	uint32_t MeshPrimitive::GetShaderVariantKey() const
+	{
+		return shaderVariantKey;
+	}
+
 	void MeshPrimitive::CreateMaterialFactorsUniformBuffer()
 	{
 		VkDeviceSize bufferSize = sizeof(MaterialFactorsUBO);
@@ -104,29 +184,29 @@ namespace Nightbird
 
 	void MeshPrimitive::CreateVertexBuffer(const std::vector<Vertex>& vertices)
 	{
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
+		PackedVertexLayout layout = ComputePackedVertexLayout(vertices, bounds);
+		vertexDecode = layout.vertexDecode;
+		texCoordOffsets = layout.texCoordOffsets;
 
-		VulkanBuffer stagingBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		VulkanBuffer stagingBuffer(device, layout.size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-		void* data = stagingBuffer.Map();
-		memcpy(data, vertices.data(), (size_t)bufferSize);
+		WritePackedVertices(vertices, layout, static_cast<uint8_t*>(stagingBuffer.Map()));
 		stagingBuffer.Unmap();
 
-		vertexBuffer = new VulkanBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		vertexBuffer = new VulkanBuffer(device, layout.size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		CopyBuffer(device, stagingBuffer.Get(), vertexBuffer->Get(), bufferSize);
+		CopyBuffer(device, stagingBuffer.Get(), vertexBuffer->Get(), layout.size);
 	}
 
-	void MeshPrimitive::CreateIndexBuffer(const std::vector<uint16_t>& indices)
+	void MeshPrimitive::CreateIndexBuffer(const std::vector<uint32_t>& indices, size_t vertexCount)
 	{
-		VkDevice logicalDevice = device->GetLogical();
+		indexType = GetPackedIndexType(vertexCount);
 
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+		VkDeviceSize bufferSize = GetIndexSize(indexType) * indices.size();
 
 		VulkanBuffer stagingBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-		void* data = stagingBuffer.Map();
-		memcpy(data, indices.data(), (size_t)bufferSize);
+		WritePackedIndices(indices, indexType, static_cast<uint8_t*>(stagingBuffer.Map()));
 		stagingBuffer.Unmap();
 
 		indexBuffer = new VulkanBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
@@ -137,7 +217,128 @@ namespace Nightbird
 		indicesSize = indices.size();
 	}
 
-	void MeshPrimitive::CreateMaterialDescriptorSets(VkDescriptorPool descriptorPool)
+	void MeshPrimitive::CreateBuffers(const PackedPrimitiveData& packed)
+	{
+		vertexDecode = packed.layout.vertexDecode;
+		texCoordOffsets = packed.layout.texCoordOffsets;
+		indexType = packed.indexType;
+		indicesSize = packed.indexCount;
+
+		VkDeviceSize vertexSize = packed.layout.size;
+		VkDeviceSize indexSize = GetIndexSize(indexType) * packed.indexCount;
+
+		// Already in the GPU layout, one copy from the source memory into a shared staging buffer
+		VulkanBuffer stagingBuffer(device, vertexSize + indexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		uint8_t* data = static_cast<uint8_t*>(stagingBuffer.Map());
+		memcpy(data, packed.vertices, static_cast<size_t>(vertexSize));
+		memcpy(data + vertexSize, packed.indices, static_cast<size_t>(indexSize));
+		stagingBuffer.Unmap();
+
+		vertexBuffer = new VulkanBuffer(device, vertexSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		indexBuffer = new VulkanBuffer(device, indexSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		CopyBuffer(device, stagingBuffer.Get(), vertexBuffer->Get(), vertexSize);
+		CopyBuffer(device, stagingBuffer.Get(), indexBuffer->Get(), indexSize, vertexSize);
+	}
+
+	PackedVertexLayout ComputePackedVertexLayout(const std::vector<Vertex>& vertices, const AABB& bounds)
+	{
+		PackedVertexLayout layout;
+
+		if (bounds.IsValid())
+		{
+			layout.vertexDecode.positionOffset = glm::vec4(bounds.min, 0.0f);
+			layout.vertexDecode.positionScale = glm::vec4(bounds.max - bounds.min, 0.0f);
+		}
+
+		// Texture coordinate sets usually all come from TEXCOORD_0, only distinct ones get a stream
+		const std::array<glm::vec2 Vertex::*, 3> texCoordSets = { &Vertex::baseColorTexCoord, &Vertex::metallicRoughnessTexCoord, &Vertex::normalTexCoord };
+
+		VkDeviceSize positionsSize = sizeof(PackedVertex) * vertices.size();
+		VkDeviceSize streamSize = sizeof(PackedTexCoord) * vertices.size();
+		VkDeviceSize streamOffset = positionsSize;
+
+		for (size_t set = 0; set < texCoordSets.size(); ++set)
+		{
+			layout.streamSource[set] = set;
+			for (size_t previous = 0; previous < set; ++previous)
+			{
+				if (layout.streamSource[previous] != previous)
+					continue;
+
+				bool identical = std::all_of(vertices.begin(), vertices.end(), [&](const Vertex& vertex)
+					{
+						return vertex.*texCoordSets[set] == vertex.*texCoordSets[previous];
+					});
+
+				if (identical)
+				{
+					layout.streamSource[set] = previous;
+					break;
+				}
+			}
+
+			if (layout.streamSource[set] == set)
+			{
+				layout.texCoordOffsets[set] = streamOffset;
+				streamOffset += streamSize;
+			}
+			else
+			{
+				layout.texCoordOffsets[set] = layout.texCoordOffsets[layout.streamSource[set]];
+			}
+		}
+
+		layout.size = streamOffset;
+		return layout;
+	}
+
+	void WritePackedVertices(const std::vector<Vertex>& vertices, const PackedVertexLayout& layout, uint8_t* destination)
+	{
+		const std::array<glm::vec2 Vertex::*, 3> texCoordSets = { &Vertex::baseColorTexCoord, &Vertex::metallicRoughnessTexCoord, &Vertex::normalTexCoord };
+
+		PackedVertex* packedVertices = reinterpret_cast<PackedVertex*>(destination);
+		for (size_t i = 0; i < vertices.size(); ++i)
+			packedVertices[i] = PackVertex(vertices[i], layout.vertexDecode);
+
+		for (size_t set = 0; set < texCoordSets.size(); ++set)
+		{
+			if (layout.streamSource[set] != set)
+				continue;
+
+			PackedTexCoord* packedTexCoords = reinterpret_cast<PackedTexCoord*>(destination + layout.texCoordOffsets[set]);
+			for (size_t i = 0; i < vertices.size(); ++i)
+				packedTexCoords[i] = PackTexCoord(vertices[i].*texCoordSets[set]);
+		}
+	}
+
+	VkIndexType GetPackedIndexType(size_t vertexCount)
+	{
+		// Half the index memory and bandwidth whenever every index fits
+		return vertexCount <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	}
+
+	VkDeviceSize GetIndexSize(VkIndexType indexType)
+	{
+		return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
+	void WritePackedIndices(const std::vector<uint32_t>& indices, VkIndexType indexType, uint8_t* destination)
+	{
+		if (indexType == VK_INDEX_TYPE_UINT16)
+		{
+			uint16_t* narrowed = reinterpret_cast<uint16_t*>(destination);
+			for (size_t i = 0; i < indices.size(); ++i)
+				narrowed[i] = static_cast<uint16_t>(indices[i]);
+		}
+		else
+		{
+			memcpy(destination, indices.data(), indices.size() * sizeof(uint32_t));
+		}
+	}
+
+	void MeshPrimitive::CreateMaterialDescriptorSets()
 	{
 		VkDevice logicalDevice = device->GetLogical();
 
@@ -154,6 +355,7 @@ namespace Nightbird
 		if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, materialDescriptorSets.data()) != VK_SUCCESS)
 		{
 			std::cerr << "Failed to allocate mesh descriptor sets" << std::endl;
+			materialDescriptorSets.clear();
 			return;
 		}
 
@@ -0,0 +1,340 @@
+#include "Core/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "Core/Vertex.h"
+#include "Core/Bounds.h"
+
+namespace Nightbird
+{
+	void MeshSimplifier::Quadric::Add(const Quadric& other)
+	{
+		a00 += other.a00; a11 += other.a11; a22 += other.a22;
+		a01 += other.a01; a02 += other.a02; a12 += other.a12;
+		b0 += other.b0; b1 += other.b1; b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+	}
+
+	float MeshSimplifier::Quadric::Evaluate(const glm::vec3& p) const
+	{
+		float rx = a00 * p.x + a01 * p.y + a02 * p.z;
+		float ry = a01 * p.x + a11 * p.y + a12 * p.z;
+		float rz = a02 * p.x + a12 * p.y + a22 * p.z;
+
+		return rx * p.x + ry * p.y + rz * p.z + 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+	}
+
+	void MeshSimplifier::AttributeQuadric::Add(const AttributeQuadric& other)
+	{
+		gradient.Add(other.gradient);
+		gradientSum += other.gradientSum;
+		offsetSum += other.offsetSum;
+	}
+
+	float MeshSimplifier::AttributeQuadric::Evaluate(const glm::vec3& p, float a) const
+	{
+		return gradient.Evaluate(p) - 2.0f * a * (glm::dot(gradientSum, p) + offsetSum) + a * a * gradient.weight;
+	}
+
+	void MeshSimplifier::VertexQuadric::Add(const VertexQuadric& other)
+	{
+		position.Add(other.position);
+		for (int i = 0; i < AttributeCount; ++i)
+			attributes[i].Add(other.attributes[i]);
+	}
+
+	float MeshSimplifier::VertexQuadric::Evaluate(const glm::vec3& p, const float* a) const
+	{
+		float error = position.Evaluate(p);
+		for (int i = 0; i < AttributeCount; ++i)
+			error += attributes[i].Evaluate(p, a[i]);
+
+		// Area weighted sum to a mean squared distance
+		return position.weight > 0.0f ? std::max(error, 0.0f) / position.weight : 0.0f;
+	}
+
+	MeshSimplifier::MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+		: indices(indices)
+	{
+		AABB bounds;
+		for (const Vertex& vertex : vertices)
+			bounds.Expand(vertex.position);
+
+		glm::vec3 extents = bounds.IsValid() ? bounds.max - bounds.min : glm::vec3(0.0f);
+		float size = std::max(extents.x, std::max(extents.y, extents.z));
+		scale = size > 0.0f ? 1.0f / size : 1.0f;
+
+		positions.resize(vertices.size());
+		attributes.resize(vertices.size() * AttributeCount);
+
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			positions[i] = (vertices[i].position - bounds.min) * scale;
+
+			float* a = &attributes[i * AttributeCount];
+			a[0] = vertices[i].normal.x * NormalWeight;
+			a[1] = vertices[i].normal.y * NormalWeight;
+			a[2] = vertices[i].normal.z * NormalWeight;
+			a[3] = vertices[i].baseColorTexCoord.x * TexCoordWeight;
+			a[4] = vertices[i].baseColorTexCoord.y * TexCoordWeight;
+		}
+
+		locked.assign(vertices.size(), 0);
+
+		// Split vertices along seams must move together, which half edge collapses can't guarantee
+		std::vector<uint32_t> order(vertices.size());
+		for (uint32_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+
+		auto lessPosition = [&](uint32_t a, uint32_t b)
+			{
+				const glm::vec3& pa = vertices[a].position;
+				const glm::vec3& pb = vertices[b].position;
+				if (pa.x != pb.x)
+					return pa.x < pb.x;
+				if (pa.y != pb.y)
+					return pa.y < pb.y;
+				return pa.z < pb.z;
+			};
+		std::sort(order.begin(), order.end(), lessPosition);
+
+		for (size_t i = 1; i < order.size(); ++i)
+		{
+			if (vertices[order[i]].position == vertices[order[i - 1]].position)
+			{
+				locked[order[i]] = 1;
+				locked[order[i - 1]] = 1;
+			}
+		}
+
+		// Edges used by a single triangle form open borders
+		std::unordered_map<uint64_t, uint32_t> edgeUses;
+		edgeUses.reserve(indices.size());
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			for (int e = 0; e < 3; ++e)
+			{
+				uint32_t a = indices[t + e];
+				uint32_t b = indices[t + (e + 1) % 3];
+				++edgeUses[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)];
+			}
+		}
+
+		for (const auto& [edge, uses] : edgeUses)
+		{
+			if (uses == 1)
+			{
+				locked[static_cast<uint32_t>(edge >> 32)] = 1;
+				locked[static_cast<uint32_t>(edge)] = 1;
+			}
+		}
+
+		BuildQuadrics();
+	}
+
+	std::vector<uint32_t> MeshSimplifier::Simplify(size_t targetIndexCount, float maxError, float& error) const
+	{
+		error = 0.0f;
+
+		std::vector<uint32_t> result = indices;
+		if (result.size() % 3 != 0 || result.size() <= targetIndexCount)
+			return result;
+
+		std::vector<VertexQuadric> vertexQuadrics = quadrics;
+
+		float maxCost = maxError * scale * maxError * scale;
+		float largestError = 0.0f;
+
+		std::vector<uint32_t> adjacency;
+		std::vector<uint32_t> adjacencyOffsets;
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> remap(positions.size());
+		std::vector<uint8_t> touched(positions.size());
+
+		while (result.size() > targetIndexCount)
+		{
+			size_t triangleCount = result.size() / 3;
+
+			// Triangles around each vertex, as offsets into one flat list
+			adjacencyOffsets.assign(positions.size() + 1, 0);
+			for (uint32_t index : result)
+				++adjacencyOffsets[index + 1];
+			for (size_t i = 1; i < adjacencyOffsets.size(); ++i)
+				adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+
+			adjacency.resize(result.size());
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); ++i)
+				adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); ++i)
+			{
+				uint32_t from = result[i];
+				uint32_t to = result[i - i % 3 + (i + 1) % 3];
+
+				// Each edge in both directions, the cheaper one wins in the sort
+				if (!locked[from])
+					collapses.push_back({ from, to, vertexQuadrics[from].Evaluate(positions[to], &attributes[to * AttributeCount]) });
+				if (!locked[to])
+					collapses.push_back({ to, from, vertexQuadrics[to].Evaluate(positions[from], &attributes[from * AttributeCount]) });
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+			for (uint32_t i = 0; i < remap.size(); ++i)
+				remap[i] = i;
+			std::fill(touched.begin(), touched.end(), 0);
+
+			// An interior collapse removes two triangles
+			size_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+			size_t removed = 0;
+			bool anyCollapse = false;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.cost > maxCost || removed >= trianglesToRemove)
+					break;
+
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+
+				if (FlipsTriangle(result, adjacency, adjacencyOffsets, collapse.from, collapse.to))
+					continue;
+
+				remap[collapse.from] = collapse.to;
+				vertexQuadrics[collapse.to].Add(vertexQuadrics[collapse.from]);
+				// Attributes steer the order, the reported error is geometric only
+				const Quadric& position = vertexQuadrics[collapse.from].position;
+				if (position.weight > 0.0f)
+					largestError = std::max(largestError, position.Evaluate(positions[collapse.to]) / position.weight);
+
+				// Keep the one ring stable for the rest of the pass so flip tests stay valid
+				for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; ++a)
+				{
+					uint32_t triangle = adjacency[a];
+					bool degenerate = false;
+					for (int k = 0; k < 3; ++k)
+					{
+						touched[result[triangle * 3 + k]] = 1;
+						degenerate |= result[triangle * 3 + k] == collapse.to;
+					}
+					removed += degenerate ? 1 : 0;
+				}
+
+				anyCollapse = true;
+			}
+
+			if (!anyCollapse)
+				break;
+
+			size_t write = 0;
+			for (size_t t = 0; t < result.size(); t += 3)
+			{
+				uint32_t a = remap[result[t]];
+				uint32_t b = remap[result[t + 1]];
+				uint32_t c = remap[result[t + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+			result.resize(write);
+		}
+
+		error = std::sqrt(std::max(largestError, 0.0f)) / scale;
+		return result;
+	}
+
+	void MeshSimplifier::BuildQuadrics()
+	{
+		quadrics.assign(positions.size(), VertexQuadric{});
+
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			uint32_t i0 = indices[t], i1 = indices[t + 1], i2 = indices[t + 2];
+			const glm::vec3& p0 = positions[i0];
+
+			glm::vec3 e1 = positions[i1] - p0;
+			glm::vec3 e2 = positions[i2] - p0;
+			glm::vec3 normal = glm::cross(e1, e2);
+
+			float length = glm::length(normal);
+			if (length <= 0.0f)
+				continue;
+
+			float area = length * 0.5f;
+			normal /= length;
+			float distance = -glm::dot(normal, p0);
+
+			VertexQuadric triangle;
+
+			Quadric& plane = triangle.position;
+			plane.a00 = area * normal.x * normal.x; plane.a11 = area * normal.y * normal.y; plane.a22 = area * normal.z * normal.z;
+			plane.a01 = area * normal.x * normal.y; plane.a02 = area * normal.x * normal.z; plane.a12 = area * normal.y * normal.z;
+			plane.b0 = area * normal.x * distance; plane.b1 = area * normal.y * distance; plane.b2 = area * normal.z * distance;
+			plane.c = area * distance * distance;
+			plane.weight = area;
+
+			// Gradient g in the triangle plane with g.e1 = a1 - a0 and g.e2 = a2 - a0
+			float d00 = glm::dot(e1, e1), d01 = glm::dot(e1, e2), d11 = glm::dot(e2, e2);
+			float denominator = d00 * d11 - d01 * d01;
+			float inverse = denominator != 0.0f ? 1.0f / denominator : 0.0f;
+
+			for (int k = 0; k < AttributeCount; ++k)
+			{
+				float a0 = attributes[i0 * AttributeCount + k];
+				float da1 = attributes[i1 * AttributeCount + k] - a0;
+				float da2 = attributes[i2 * AttributeCount + k] - a0;
+
+				float u = (d11 * da1 - d01 * da2) * inverse;
+				float v = (d00 * da2 - d01 * da1) * inverse;
+				glm::vec3 g = e1 * u + e2 * v;
+				float d = a0 - glm::dot(g, p0);
+
+				AttributeQuadric& attribute = triangle.attributes[k];
+				attribute.gradient.a00 = area * g.x * g.x; attribute.gradient.a11 = area * g.y * g.y; attribute.gradient.a22 = area * g.z * g.z;
+				attribute.gradient.a01 = area * g.x * g.y; attribute.gradient.a02 = area * g.x * g.z; attribute.gradient.a12 = area * g.y * g.z;
+				attribute.gradient.b0 = area * g.x * d; attribute.gradient.b1 = area * g.y * d; attribute.gradient.b2 = area * g.z * d;
+				attribute.gradient.c = area * d * d;
+				attribute.gradient.weight = area;
+				attribute.gradientSum = g * area;
+				attribute.offsetSum = d * area;
+			}
+
+			quadrics[i0].Add(triangle);
+			quadrics[i1].Add(triangle);
+			quadrics[i2].Add(triangle);
+		}
+	}
+
+	bool MeshSimplifier::FlipsTriangle(const std::vector<uint32_t>& triangleIndices, const std::vector<uint32_t>& adjacency, const std::vector<uint32_t>& adjacencyOffsets, uint32_t from, uint32_t to) const
+	{
+		for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a)
+		{
+			const uint32_t* triangle = &triangleIndices[adjacency[a] * 3];
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				continue;
+
+			glm::vec3 p[3] = { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+			glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+			for (int k = 0; k < 3; ++k)
+			{
+				if (triangle[k] == from)
+					p[k] = positions[to];
+			}
+
+			glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+			if (glm::dot(before, after) <= 0.0f)
+				return true;
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,514 @@
+#include "Core/MeshoptDecoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define NIGHTBIRD_MESHOPT_SSE2
+#endif
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr uint8_t VertexHeader = 0xa0;
+		constexpr uint8_t IndexHeader = 0xe0;
+		constexpr uint8_t SequenceHeader = 0xd0;
+
+		constexpr size_t ByteGroupSize = 16;
+		// Largest group, 16 bytes of 8 bit values plus the header's worst case share
+		constexpr size_t ByteGroupDecodeLimit = 24;
+		constexpr size_t VertexBlockSizeBytes = 8192;
+		constexpr size_t VertexBlockMaxSize = 256;
+		constexpr size_t TailMaxSize = 32;
+
+		size_t GetVertexBlockSize(size_t stride)
+		{
+			size_t result = VertexBlockSizeBytes / stride;
+			result &= ~(ByteGroupSize - 1);
+
+			return std::min(result, VertexBlockMaxSize);
+		}
+
+		// 16 values of 0, 2, 4 or 8 bits, the all ones value escapes to a full byte stored after the group
+		const uint8_t* DecodeBytesGroup(const uint8_t* data, uint8_t* destination, int bitsLog2)
+		{
+			if (bitsLog2 == 0)
+			{
+				memset(destination, 0, ByteGroupSize);
+				return data;
+			}
+
+			if (bitsLog2 == 3)
+			{
+				memcpy(destination, data, ByteGroupSize);
+				return data + ByteGroupSize;
+			}
+
+			int bits = bitsLog2 == 1 ? 2 : 4;
+			uint8_t escape = static_cast<uint8_t>((1 << bits) - 1);
+			size_t packedSize = ByteGroupSize * bits / 8;
+
+			const uint8_t* escaped = data + packedSize;
+			for (size_t i = 0; i < packedSize; ++i)
+			{
+				uint8_t byte = data[i];
+				for (int shift = 8 - bits; shift >= 0; shift -= bits)
+				{
+					uint8_t value = (byte >> shift) & escape;
+					*destination++ = value == escape ? *escaped++ : value;
+				}
+			}
+
+			return escaped;
+		}
+
+		const uint8_t* DecodeBytes(const uint8_t* data, const uint8_t* dataEnd, uint8_t* destination, size_t size)
+		{
+			// Two header bits per group
+			size_t headerSize = (size / ByteGroupSize + 3) / 4;
+			if (size_t(dataEnd - data) < headerSize)
+				return nullptr;
+
+			const uint8_t* header = data;
+			data += headerSize;
+
+			for (size_t i = 0; i < size; i += ByteGroupSize)
+			{
+				if (size_t(dataEnd - data) < ByteGroupDecodeLimit)
+					return nullptr;
+
+				size_t group = i / ByteGroupSize;
+				int bitsLog2 = (header[group / 4] >> ((group % 4) * 2)) & 3;
+
+				data = DecodeBytesGroup(data, destination + i, bitsLog2);
+			}
+
+			return data;
+		}
+
+		uint8_t Unzigzag8(uint8_t value)
+		{
+			return static_cast<uint8_t>(-(value & 1) ^ (value >> 1));
+		}
+
+#ifdef NIGHTBIRD_MESHOPT_SSE2
+		__m128i Unzigzag8(__m128i value)
+		{
+			__m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi8(1)));
+			__m128i magnitude = _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(127));
+			return _mm_xor_si128(sign, magnitude);
+		}
+
+		// Running byte wise sum over the four 32 bit vertex lanes, seeded with the previous vertex
+		__m128i PrefixSum(__m128i deltas, __m128i previous)
+		{
+			deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 4));
+			deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 8));
+			return _mm_add_epi8(deltas, _mm_shuffle_epi32(previous, _MM_SHUFFLE(3, 3, 3, 3)));
+		}
+
+		void StoreVertices(__m128i values, uint8_t* destination, size_t stride, size_t count)
+		{
+			alignas(16) uint8_t lanes[16];
+			_mm_store_si128(reinterpret_cast<__m128i*>(lanes), values);
+
+			for (size_t i = 0; i < count; ++i)
+				memcpy(destination + i * stride, lanes + i * 4, 4);
+		}
+#endif
+
+		// Deltas are byte wise, per attribute byte along the vertices of the block
+		void ReconstructBlock(const uint8_t* deltas, size_t alignedCount, uint8_t* vertices, size_t count, size_t stride, const uint8_t* lastVertex)
+		{
+#ifdef NIGHTBIRD_MESHOPT_SSE2
+			// Four attribute bytes of 16 vertices at a time, transposed so each vertex is one 32 bit lane
+			for (size_t k = 0; k < stride; k += 4)
+			{
+				int32_t seed;
+				memcpy(&seed, lastVertex + k, 4);
+				__m128i previous = _mm_set1_epi32(seed);
+
+				for (size_t i = 0; i < count; i += 16)
+				{
+					__m128i b0 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + (k + 0) * alignedCount + i)));
+					__m128i b1 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + (k + 1) * alignedCount + i)));
+					__m128i b2 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + (k + 2) * alignedCount + i)));
+					__m128i b3 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + (k + 3) * alignedCount + i)));
+
+					__m128i b01Low = _mm_unpacklo_epi8(b0, b1);
+					__m128i b01High = _mm_unpackhi_epi8(b0, b1);
+					__m128i b23Low = _mm_unpacklo_epi8(b2, b3);
+					__m128i b23High = _mm_unpackhi_epi8(b2, b3);
+
+					__m128i groups[4] =
+					{
+						_mm_unpacklo_epi16(b01Low, b23Low),
+						_mm_unpackhi_epi16(b01Low, b23Low),
+						_mm_unpacklo_epi16(b01High, b23High),
+						_mm_unpackhi_epi16(b01High, b23High)
+					};
+
+					for (size_t g = 0; g < 4 && i + g * 4 < count; ++g)
+					{
+						previous = PrefixSum(groups[g], previous);
+						StoreVertices(previous, vertices + (i + g * 4) * stride + k, stride, std::min<size_t>(4, count - (i + g * 4)));
+					}
+				}
+			}
+#else
+			for (size_t k = 0; k < stride; ++k)
+			{
+				uint8_t previous = lastVertex[k];
+				for (size_t i = 0; i < count; ++i)
+				{
+					previous = static_cast<uint8_t>(Unzigzag8(deltas[k * alignedCount + i]) + previous);
+					vertices[i * stride + k] = previous;
+				}
+			}
+#endif
+		}
+
+		uint32_t DecodeVByte(const uint8_t*& data)
+		{
+			uint8_t lead = *data++;
+			if (lead < 128)
+				return lead;
+
+			uint32_t result = lead & 127;
+			uint32_t shift = 7;
+			for (int i = 0; i < 4; ++i)
+			{
+				uint8_t group = *data++;
+				result |= uint32_t(group & 127) << shift;
+				shift += 7;
+
+				if (group < 128)
+					break;
+			}
+
+			return result;
+		}
+
+		uint32_t DecodeIndex(const uint8_t*& data, uint32_t last)
+		{
+			uint32_t value = DecodeVByte(data);
+			uint32_t delta = (value >> 1) ^ (0u - (value & 1));
+
+			return last + delta;
+		}
+
+		void WriteIndex(void* destination, size_t offset, size_t indexSize, uint32_t index)
+		{
+			if (indexSize == 2)
+				static_cast<uint16_t*>(destination)[offset] = static_cast<uint16_t>(index);
+			else
+				static_cast<uint32_t*>(destination)[offset] = index;
+		}
+
+		void PushEdge(uint32_t fifo[16][2], uint32_t a, uint32_t b, size_t& offset)
+		{
+			fifo[offset][0] = a;
+			fifo[offset][1] = b;
+			offset = (offset + 1) & 15;
+		}
+
+		void PushVertex(uint32_t fifo[16], uint32_t v, size_t& offset, bool condition = true)
+		{
+			fifo[offset] = v;
+			offset = (offset + (condition ? 1 : 0)) & 15;
+		}
+
+		template<typename T>
+		void DecodeOctahedral(T* data, size_t count, float maxValue)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				T* n = data + i * 4;
+
+				// Third component stores 1.0 at the encoded precision
+				float one = float(n[2]);
+				float x = float(n[0]) / one;
+				float y = float(n[1]) / one;
+				float z = 1.0f - std::abs(x) - std::abs(y);
+
+				float t = std::min(z, 0.0f);
+				x -= std::copysign(t, x);
+				y -= std::copysign(t, y);
+
+				float length = std::sqrt(x * x + y * y + z * z);
+
+				n[0] = static_cast<T>(std::lround(x / length * maxValue));
+				n[1] = static_cast<T>(std::lround(y / length * maxValue));
+				n[2] = static_cast<T>(std::lround(z / length * maxValue));
+			}
+		}
+
+		void DecodeQuaternion(int16_t* data, size_t count)
+		{
+			const float range = 1.0f / std::sqrt(2.0f);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				int16_t* q = data + i * 4;
+
+				// Low two bits pick the dropped largest component, the rest hold 1.0 at the encoded precision
+				float one = float(q[3] | 3);
+				float x = float(q[0]) / one * range;
+				float y = float(q[1]) / one * range;
+				float z = float(q[2]) / one * range;
+				float w = std::sqrt(std::max(1.0f - x * x - y * y - z * z, 0.0f));
+
+				int largest = q[3] & 3;
+				q[(largest + 1) & 3] = static_cast<int16_t>(std::lround(x * 32767.0f));
+				q[(largest + 2) & 3] = static_cast<int16_t>(std::lround(y * 32767.0f));
+				q[(largest + 3) & 3] = static_cast<int16_t>(std::lround(z * 32767.0f));
+				q[(largest + 0) & 3] = static_cast<int16_t>(std::lround(w * 32767.0f));
+			}
+		}
+
+		void DecodeExponential(uint32_t* data, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				// 24 bit signed mantissa, 8 bit signed exponent
+				int32_t mantissa = int32_t(data[i] << 8) >> 8;
+				int32_t exponent = int32_t(data[i]) >> 24;
+
+				float value = std::ldexp(float(mantissa), exponent);
+				memcpy(&data[i], &value, sizeof(value));
+			}
+		}
+	}
+
+	bool DecodeMeshoptVertexBuffer(void* destination, size_t count, size_t stride, const uint8_t* buffer, size_t size)
+	{
+		if (stride == 0 || stride > 256 || stride % 4 != 0)
+			return false;
+
+		// Only version 0 is allowed by EXT_meshopt_compression
+		if (size < 1 || buffer[0] != VertexHeader)
+			return false;
+
+		const uint8_t* data = buffer + 1;
+		const uint8_t* dataEnd = buffer + size;
+
+		// The first vertex is stored at the end, padded so group decoding never reads past the buffer
+		size_t tailSize = std::max(stride, TailMaxSize);
+		if (size_t(dataEnd - data) < tailSize)
+			return false;
+
+		uint8_t lastVertex[256];
+		memcpy(lastVertex, dataEnd - stride, stride);
+
+		size_t blockSize = GetVertexBlockSize(stride);
+
+		uint8_t deltas[VertexBlockSizeBytes];
+		uint8_t* vertices = static_cast<uint8_t*>(destination);
+
+		for (size_t offset = 0; offset < count; offset += blockSize)
+		{
+			size_t blockCount = std::min(blockSize, count - offset);
+			size_t alignedCount = (blockCount + ByteGroupSize - 1) & ~(ByteGroupSize - 1);
+
+			for (size_t k = 0; k < stride; ++k)
+			{
+				data = DecodeBytes(data, dataEnd, deltas + k * alignedCount, alignedCount);
+				if (!data)
+					return false;
+			}
+
+			uint8_t* blockVertices = vertices + offset * stride;
+			ReconstructBlock(deltas, alignedCount, blockVertices, blockCount, stride, lastVertex);
+
+			memcpy(lastVertex, blockVertices + (blockCount - 1) * stride, stride);
+		}
+
+		return size_t(dataEnd - data) == tailSize;
+	}
+
+	bool DecodeMeshoptIndexBuffer(void* destination, size_t count, size_t indexSize, const uint8_t* buffer, size_t size)
+	{
+		if (count % 3 != 0 || (indexSize != 2 && indexSize != 4))
+			return false;
+
+		// Header, one code per triangle and the 16 byte auxiliary code table at the end
+		if (size < 1 + count / 3 + 16)
+			return false;
+
+		int version = buffer[0] & 15;
+		if ((buffer[0] & 0xf0) != IndexHeader || version != 1)
+			return false;
+
+		uint32_t edgeFifo[16][2];
+		uint32_t vertexFifo[16];
+		memset(edgeFifo, -1, sizeof(edgeFifo));
+		memset(vertexFifo, -1, sizeof(vertexFifo));
+
+		size_t edgeOffset = 0;
+		size_t vertexOffset = 0;
+
+		uint32_t next = 0;
+		uint32_t last = 0;
+
+		// Version 1 spends codes 13 and 14 on last -1 and last +1
+		const int fecMax = 13;
+
+		const uint8_t* code = buffer + 1;
+		const uint8_t* data = code + count / 3;
+		const uint8_t* dataSafeEnd = buffer + size - 16;
+		const uint8_t* codeAuxTable = dataSafeEnd;
+
+		for (size_t i = 0; i < count; i += 3)
+		{
+			if (data > dataSafeEnd)
+				return false;
+
+			uint8_t codeTriangle = *code++;
+
+			if (codeTriangle < 0xf0)
+			{
+				// Triangle sharing an edge from the fifo, third vertex is next, from the vertex fifo or free
+				int fe = codeTriangle >> 4;
+				uint32_t a = edgeFifo[(edgeOffset - 1 - fe) & 15][0];
+				uint32_t b = edgeFifo[(edgeOffset - 1 - fe) & 15][1];
+
+				int fec = codeTriangle & 15;
+				uint32_t c;
+
+				if (fec < fecMax)
+				{
+					c = fec == 0 ? next++ : vertexFifo[(vertexOffset - 1 - fec) & 15];
+					PushVertex(vertexFifo, c, vertexOffset, fec == 0);
+				}
+				else
+				{
+					// fec - (fec ^ 3) maps 13 and 14 to -1 and +1
+					last = c = fec != 15 ? last + (fec - (fec ^ 3)) : DecodeIndex(data, last);
+					PushVertex(vertexFifo, c, vertexOffset);
+				}
+
+				WriteIndex(destination, i + 0, indexSize, a);
+				WriteIndex(destination, i + 1, indexSize, b);
+				WriteIndex(destination, i + 2, indexSize, c);
+
+				PushEdge(edgeFifo, c, b, edgeOffset);
+				PushEdge(edgeFifo, a, c, edgeOffset);
+			}
+			else
+			{
+				int fea;
+				int feb;
+				int fec;
+
+				if (codeTriangle < 0xfe)
+				{
+					uint8_t codeAux = codeAuxTable[codeTriangle & 15];
+					fea = 0;
+					feb = codeAux >> 4;
+					fec = codeAux & 15;
+				}
+				else
+				{
+					uint8_t codeAux = *data++;
+					fea = codeTriangle == 0xfe ? 0 : 15;
+					feb = codeAux >> 4;
+					fec = codeAux & 15;
+
+					// Restart code
+					if (codeAux == 0)
+						next = 0;
+				}
+
+				// next is claimed for all three vertices before any free index is read, matching the encoder
+				uint32_t a = fea == 0 ? next++ : 0;
+				uint32_t b = feb == 0 ? next++ : vertexFifo[(vertexOffset - feb) & 15];
+				uint32_t c = fec == 0 ? next++ : vertexFifo[(vertexOffset - fec) & 15];
+
+				if (fea == 15)
+					last = a = DecodeIndex(data, last);
+				if (feb == 15)
+					last = b = DecodeIndex(data, last);
+				if (fec == 15)
+					last = c = DecodeIndex(data, last);
+
+				WriteIndex(destination, i + 0, indexSize, a);
+				WriteIndex(destination, i + 1, indexSize, b);
+				WriteIndex(destination, i + 2, indexSize, c);
+
+				PushVertex(vertexFifo, a, vertexOffset);
+				PushVertex(vertexFifo, b, vertexOffset, feb == 0 || feb == 15);
+				PushVertex(vertexFifo, c, vertexOffset, fec == 0 || fec == 15);
+
+				PushEdge(edgeFifo, b, a, edgeOffset);
+				PushEdge(edgeFifo, c, b, edgeOffset);
+				PushEdge(edgeFifo, a, c, edgeOffset);
+			}
+		}
+
+		return data == dataSafeEnd;
+	}
+
+	bool DecodeMeshoptIndexSequence(void* destination, size_t count, size_t indexSize, const uint8_t* buffer, size_t size)
+	{
+		if (indexSize != 2 && indexSize != 4)
+			return false;
+
+		// Header, at least a byte per index and a 4 byte tail
+		if (size < 1 + count + 4)
+			return false;
+
+		int version = buffer[0] & 15;
+		if ((buffer[0] & 0xf0) != SequenceHeader || version != 1)
+			return false;
+
+		const uint8_t* data = buffer + 1;
+		const uint8_t* dataSafeEnd = buffer + size - 4;
+
+		// Two baselines, the low bit of each code picks which one the delta applies to
+		uint32_t last[2] = {};
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (data >= dataSafeEnd)
+				return false;
+
+			uint32_t value = DecodeVByte(data);
+
+			uint32_t baseline = value & 1;
+			value >>= 1;
+
+			uint32_t delta = (value >> 1) ^ (0u - (value & 1));
+			last[baseline] += delta;
+
+			WriteIndex(destination, i, indexSize, last[baseline]);
+		}
+
+		return data == dataSafeEnd;
+	}
+
+	void ApplyMeshoptFilter(void* data, size_t count, size_t stride, MeshoptFilter filter)
+	{
+		switch (filter)
+		{
+		case MeshoptFilter::Octahedral:
+			if (stride == 4)
+				DecodeOctahedral(static_cast<int8_t*>(data), count, 127.0f);
+			else if (stride == 8)
+				DecodeOctahedral(static_cast<int16_t*>(data), count, 32767.0f);
+			break;
+		case MeshoptFilter::Quaternion:
+			if (stride == 8)
+				DecodeQuaternion(static_cast<int16_t*>(data), count);
+			break;
+		case MeshoptFilter::Exponential:
+			if (stride % 4 == 0)
+				DecodeExponential(static_cast<uint32_t*>(data), count * stride / 4);
+			break;
+		case MeshoptFilter::None:
+			break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,730 @@
+#include "Core/ModelImporter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <utility>
+#include <variant>
+
+#include <stb_image.h>
+
+#include "Core/Model.h"
+#include "Core/MeshPrimitive.h"
+#include "Core/TriangleBVH.h"
+#include "Core/MeshSimplifier.h"
+#include "Core/MeshOptimizer.h"
+#include "Core/MeshoptDecoder.h"
+#include "Core/GltfAccessorReader.h"
+#include "Core/JobSystem.h"
+#include "Vulkan/Texture.h"
+
+namespace Nightbird
+{
+	ModelImporter::ModelImporter(JobSystem* jobSystem, const ModelImportSettings& settings)
+		: jobSystem(jobSystem), settings(settings)
+	{
+	}
+
+	std::shared_ptr<Model> ModelImporter::Import(const std::filesystem::path& path, ModelImportStats* importStats) const
+	{
+		std::string pathKey = path.string();
+
+		// Quantized attributes need no special handling, fastgltf converts normalized and integer components on access
+		fastgltf::Parser parser(fastgltf::Extensions::KHR_mesh_quantization | fastgltf::Extensions::EXT_meshopt_compression);
+
+		auto data = fastgltf::GltfDataBuffer::FromPath(path);
+		if (data.error() != fastgltf::Error::None)
+		{
+			std::cout << "fastgltf get buffer error: " << fastgltf::getErrorMessage(data.error()) << std::endl;
+			return nullptr;
+		}
+
+		// Detects GLB and glTF, external buffers and images of a .gltf are read into memory like GLB chunks
+		auto asset = parser.loadGltf(data.get(), path.parent_path(), fastgltf::Options::LoadExternalBuffers | fastgltf::Options::LoadExternalImages);
+		if (asset.error() != fastgltf::Error::None)
+		{
+			std::cout << "fastgltf get data error: " << fastgltf::getErrorMessage(asset.error()) << std::endl;
+			return nullptr;
+		}
+
+		std::shared_ptr<Model> model = std::make_shared<Model>();
+		model->path = pathKey;
+		model->gltfAsset = std::move(asset.get());
+
+		auto& gltfAsset = model->gltfAsset;
+
+		if (!DecodeCompressedBufferViews(gltfAsset))
+			return nullptr;
+
+		LoadTextures(model);
+
+		if (JobSystem::IsCurrentJobCancelled())
+			return nullptr;
+
+		// Every primitive gets a preallocated slot, so workers never touch shared containers
+		struct PrimitiveJob
+		{
+			size_t meshIndex;
+			size_t primitiveIndex;
+			size_t vertexCount;
+		};
+
+		struct PrimitiveStats
+		{
+			double acmrBefore = 0.0;
+			double acmrAfter = 0.0;
+			size_t triangles = 0;
+			std::chrono::steady_clock::duration readTime{};
+		};
+
+		std::vector<PrimitiveJob> jobs;
+		model->meshData.resize(gltfAsset.meshes.size());
+		for (size_t meshIndex = 0; meshIndex < gltfAsset.meshes.size(); ++meshIndex)
+		{
+			const fastgltf::Mesh& gltfMesh = gltfAsset.meshes[meshIndex];
+			model->meshData[meshIndex].primitiveInfo.resize(gltfMesh.primitives.size());
+
+			for (size_t primitiveIndex = 0; primitiveIndex < gltfMesh.primitives.size(); ++primitiveIndex)
+			{
+				const fastgltf::Primitive& primitive = gltfMesh.primitives[primitiveIndex];
+
+				auto positionIt = primitive.findAttribute("POSITION");
+				size_t vertexCount = positionIt != primitive.attributes.end() ? gltfAsset.accessors[positionIt->accessorIndex].count : 0;
+
+				jobs.push_back({ meshIndex, primitiveIndex, vertexCount });
+			}
+		}
+
+		// Largest first, so one big primitive doesn't start last and hold up the rest
+		std::stable_sort(jobs.begin(), jobs.end(), [](const PrimitiveJob& a, const PrimitiveJob& b)
+			{
+				return a.vertexCount > b.vertexCount;
+			});
+
+		std::vector<PrimitiveStats> stats(jobs.size());
+
+		jobSystem->ParallelFor(jobs.size(), [&](size_t jobIndex)
+			{
+				const PrimitiveJob& job = jobs[jobIndex];
+				const fastgltf::Primitive& primitive = gltfAsset.meshes[job.meshIndex].primitives[job.primitiveIndex];
+				MeshPrimitiveInfo& primitiveInfo = model->meshData[job.meshIndex].primitiveInfo[job.primitiveIndex];
+				PrimitiveStats& primitiveStats = stats[jobIndex];
+
+				auto readStart = std::chrono::steady_clock::now();
+				bool extracted = ExtractPrimitive(gltfAsset, primitive, primitiveInfo);
+				primitiveStats.readTime = std::chrono::steady_clock::now() - readStart;
+
+				// Rejected primitives are left empty and never reach the optimizer or LOD generation
+				if (!extracted)
+				{
+					primitiveInfo = {};
+					return;
+				}
+
+				OptimizePrimitive(primitiveInfo, primitiveStats.acmrBefore, primitiveStats.acmrAfter, primitiveStats.triangles);
+			});
+
+		// Rejected primitives go before collision and upload, so those and the LODs only ever see range checked indices
+		for (MeshData& meshData : model->meshData)
+		{
+			auto& primitives = meshData.primitiveInfo;
+			primitives.erase(std::remove_if(primitives.begin(), primitives.end(), [](const MeshPrimitiveInfo& primitiveInfo)
+				{
+					return primitiveInfo.vertices.empty() || primitiveInfo.indices.empty();
+				}), primitives.end());
+		}
+
+		jobSystem->ParallelFor(model->meshData.size(), [&](size_t meshIndex)
+			{
+				BuildCollision(model->meshData[meshIndex]);
+			});
+
+		double acmrBefore = 0.0;
+		double acmrAfter = 0.0;
+		size_t optimizedTriangles = 0;
+		std::chrono::steady_clock::duration readTime{};
+		size_t readVertices = 0;
+
+		for (size_t jobIndex = 0; jobIndex < jobs.size(); ++jobIndex)
+		{
+			acmrBefore += stats[jobIndex].acmrBefore;
+			acmrAfter += stats[jobIndex].acmrAfter;
+			optimizedTriangles += stats[jobIndex].triangles;
+			readTime += stats[jobIndex].readTime;
+			readVertices += jobs[jobIndex].vertexCount;
+		}
+
+		if (importStats)
+		{
+			importStats->readVertices = readVertices;
+			importStats->readSeconds = std::chrono::duration<double>(readTime).count();
+		}
+
+		if (optimizedTriangles > 0)
+			std::cout << "Optimized " << pathKey << ": ACMR " << acmrBefore / optimizedTriangles << " -> " << acmrAfter / optimizedTriangles << std::endl;
+
+		return model;
+	}
+
+	bool ModelImporter::ExtractPrimitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, MeshPrimitiveInfo& primitiveInfo) const
+	{
+		auto positionIt = primitive.findAttribute("POSITION");
+		auto normalIt = primitive.findAttribute("NORMAL");
+
+		primitiveInfo = {};
+
+		// glTF leaves POSITION optional and asks loaders to skip primitives without it
+		if (positionIt == primitive.attributes.end())
+			return false;
+
+		const auto& positionAccessor = asset.accessors[positionIt->accessorIndex];
+		primitiveInfo.vertices.resize(positionAccessor.count);
+
+		ReadVertexAttribute(asset, positionAccessor, primitiveInfo.vertices, &Vertex::position);
+
+		// glTF requires POSITION min/max, so the box normally costs no extra pass
+		const auto* boundsMin = std::get_if<1>(&positionAccessor.min);
+		const auto* boundsMax = std::get_if<1>(&positionAccessor.max);
+		if (boundsMin && boundsMax && boundsMin->size() >= 3 && boundsMax->size() >= 3 && !positionAccessor.normalized)
+		{
+			primitiveInfo.bounds.min = glm::vec3((*boundsMin)[0], (*boundsMin)[1], (*boundsMin)[2]);
+			primitiveInfo.bounds.max = glm::vec3((*boundsMax)[0], (*boundsMax)[1], (*boundsMax)[2]);
+		}
+		else
+		{
+			for (const Vertex& vertex : primitiveInfo.vertices)
+				primitiveInfo.bounds.Expand(vertex.position);
+		}
+
+		// Sphere around the box center, sized by the farthest vertex
+		if (primitiveInfo.bounds.IsValid())
+		{
+			glm::vec3 center = primitiveInfo.bounds.GetCenter();
+			float radiusSquared = 0.0f;
+			for (const Vertex& vertex : primitiveInfo.vertices)
+			{
+				glm::vec3 delta = vertex.position - center;
+				radiusSquared = std::max(radiusSquared, glm::dot(delta, delta));
+			}
+
+			primitiveInfo.boundingSphere.center = center;
+			primitiveInfo.boundingSphere.radius = std::sqrt(radiusSquared);
+		}
+
+		if (normalIt != primitive.attributes.end())
+		{
+			auto& normalAccessor = asset.accessors[normalIt->accessorIndex];
+			ReadVertexAttribute(asset, normalAccessor, primitiveInfo.vertices, &Vertex::normal);
+		}
+
+		// TANGENT is skipped until the vertex format carries tangents
+
+		if (primitive.indicesAccessor.has_value())
+		{
+			const auto& indexAccessor = asset.accessors[primitive.indicesAccessor.value()];
+			ReadIndices(asset, indexAccessor, primitiveInfo.indices);
+		}
+		else
+		{
+			// Non indexed primitives draw their vertices in order
+			primitiveInfo.indices.resize(primitiveInfo.vertices.size());
+			std::iota(primitiveInfo.indices.begin(), primitiveInfo.indices.end(), 0u);
+		}
+
+		// The one range check on import, the optimizer, LODs and collision all index vertices with these
+		auto& indices = primitiveInfo.indices;
+		size_t vertexCount = primitiveInfo.vertices.size();
+		auto inRange = [vertexCount](uint32_t index) { return index < vertexCount; };
+		if (!std::all_of(indices.begin(), indices.end(), inRange))
+		{
+			// A triangle list only loses the triangles that reference missing vertices, other topologies can't be split safely
+			if (primitive.type != fastgltf::PrimitiveType::Triangles || indices.size() % 3 != 0)
+			{
+				std::cerr << "Skipping primitive with indices past its " << vertexCount << " vertices" << std::endl;
+				return false;
+			}
+
+			size_t kept = 0;
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				if (inRange(indices[i]) && inRange(indices[i + 1]) && inRange(indices[i + 2]))
+				{
+					indices[kept++] = indices[i];
+					indices[kept++] = indices[i + 1];
+					indices[kept++] = indices[i + 2];
+				}
+			}
+
+			std::cerr << "Dropped " << (indices.size() - kept) / 3 << " triangles with indices past their primitive's " << vertexCount << " vertices" << std::endl;
+			indices.resize(kept);
+
+			if (indices.empty())
+				return false;
+		}
+
+		std::size_t baseColorTexcoordIndex = 0;
+		std::size_t metallicRoughnessTexcoordIndex = 0;
+		std::size_t normalTexcoordIndex = 0;
+		if (primitive.materialIndex.has_value())
+		{
+			auto& material = asset.materials[primitive.materialIndex.value()];
+
+			primitiveInfo.enableTransparency = (material.alphaMode == fastgltf::AlphaMode::Blend);
+			primitiveInfo.doubleSided = material.doubleSided;
+
+			const auto& baseColorFactor = material.pbrData.baseColorFactor;
+			primitiveInfo.baseColorFactor = glm::vec4(baseColorFactor.x(), baseColorFactor.y(), baseColorFactor.z(), baseColorFactor.w());
+
+			auto& baseColorTexture = material.pbrData.baseColorTexture;
+			if (baseColorTexture.has_value())
+			{
+				auto& texture = asset.textures[baseColorTexture->textureIndex];
+				if (texture.imageIndex.has_value())
+				{
+					if (baseColorTexture->transform && baseColorTexture->transform->texCoordIndex.has_value())
+					{
+						baseColorTexcoordIndex = baseColorTexture->transform->texCoordIndex.value();
+					}
+					else
+					{
+						baseColorTexcoordIndex = material.pbrData.baseColorTexture->texCoordIndex;
+					}
+				}
+			}
+
+			primitiveInfo.metallicFactor = material.pbrData.metallicFactor;
+			primitiveInfo.roughnessFactor = material.pbrData.roughnessFactor;
+
+			auto& metallicRoughnessTexture = material.pbrData.metallicRoughnessTexture;
+			if (metallicRoughnessTexture.has_value())
+			{
+				auto& texture = asset.textures[metallicRoughnessTexture->textureIndex];
+				if (texture.imageIndex.has_value())
+				{
+					if (metallicRoughnessTexture->transform && metallicRoughnessTexture->transform->texCoordIndex.has_value())
+					{
+						metallicRoughnessTexcoordIndex = metallicRoughnessTexture->transform->texCoordIndex.value();
+					}
+					else
+					{
+						metallicRoughnessTexcoordIndex = material.pbrData.baseColorTexture->texCoordIndex;
+					}
+				}
+			}
+
+			auto& normalTexture = material.normalTexture;
+			if (normalTexture.has_value())
+			{
+				auto& texture = asset.textures[normalTexture->textureIndex];
+				if (texture.imageIndex.has_value())
+				{
+					if (normalTexture->transform && normalTexture->transform->texCoordIndex.has_value())
+					{
+						normalTexcoordIndex = normalTexture->transform->texCoordIndex.value();
+					}
+					else
+					{
+						normalTexcoordIndex = material.normalTexture->texCoordIndex;
+					}
+				}
+			}
+		}
+
+		auto baseColorTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(baseColorTexcoordIndex);
+		if (const auto* texcoord = primitive.findAttribute(baseColorTexcoordAttribute); texcoord != primitive.attributes.end())
+		{
+			auto& texcoordAccessor = asset.accessors[texcoord->accessorIndex];
+			if (texcoordAccessor.bufferViewIndex.has_value())
+			{
+				ReadVertexAttribute(asset, texcoordAccessor, primitiveInfo.vertices, &Vertex::baseColorTexCoord);
+			}
+		}
+
+		auto metallicRoughnessTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(metallicRoughnessTexcoordIndex);
+		if (const auto* texcoord = primitive.findAttribute(metallicRoughnessTexcoordAttribute); texcoord != primitive.attributes.end())
+		{
+			auto& texcoordAccessor = asset.accessors[texcoord->accessorIndex];
+			if (texcoordAccessor.bufferViewIndex.has_value())
+			{
+				ReadVertexAttribute(asset, texcoordAccessor, primitiveInfo.vertices, &Vertex::metallicRoughnessTexCoord);
+			}
+		}
+
+		auto normalTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(normalTexcoordIndex);
+		if (const auto* texcoord = primitive.findAttribute(normalTexcoordAttribute); texcoord != primitive.attributes.end())
+		{
+			auto& texcoordAccessor = asset.accessors[texcoord->accessorIndex];
+			if (texcoordAccessor.bufferViewIndex.has_value())
+			{
+				ReadVertexAttribute(asset, texcoordAccessor, primitiveInfo.vertices, &Vertex::normalTexCoord);
+			}
+		}
+
+		if (primitive.materialIndex.has_value())
+		{
+			const auto& material = asset.materials[primitive.materialIndex.value()];
+
+			if (material.pbrData.baseColorTexture.has_value())
+			{
+				const auto& texture = asset.textures[material.pbrData.baseColorTexture->textureIndex];
+				if (texture.imageIndex.has_value())
+				{
+					auto imageIndex = texture.imageIndex.value();
+					primitiveInfo.baseColorTextureIndex = imageIndex;
+					primitiveInfo.hasBaseColorTexture = true;
+				}
+			}
+			if (material.pbrData.metallicRoughnessTexture.has_value())
+			{
+				const auto& texture = asset.textures[material.pbrData.metallicRoughnessTexture->textureIndex];
+				if (texture.imageIndex.has_value())
+				{
+					auto imageIndex = texture.imageIndex.value();
+					primitiveInfo.metallicRoughnessTextureIndex = imageIndex;
+					primitiveInfo.hasMetallicRoughnessTexture = true;
+				}
+			}
+			if (material.normalTexture.has_value())
+			{
+				const auto& texture = asset.textures[material.normalTexture->textureIndex];
+				if (texture.imageIndex.has_value())
+				{
+					auto imageIndex = texture.imageIndex.value();
+					primitiveInfo.normalTextureIndex = imageIndex;
+					primitiveInfo.hasNormalTexture = true;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool ModelImporter::DecodeCompressedBufferViews(fastgltf::Asset& asset) const
+	{
+		// Far past any real mesh, stops a bogus count or stride from turning into a huge allocation
+		constexpr size_t MAX_DECODED_VIEW_SIZE = size_t(1) << 30;
+
+		for (auto& bufferView : asset.bufferViews)
+		{
+			if (!bufferView.meshoptCompression)
+				continue;
+
+			const fastgltf::CompressedBufferView& compression = *bufferView.meshoptCompression;
+
+			// fastgltf validates the view's own buffer index but not the compressed one
+			if (compression.bufferIndex >= asset.buffers.size())
+			{
+				std::cerr << "Meshopt compressed buffer view references a missing buffer" << std::endl;
+				return false;
+			}
+
+			// Visited as const, a non-const source would bind to the catch-all before the const overloads
+			auto source = std::visit(fastgltf::visitor {
+				[](const auto&) -> fastgltf::span<const std::byte> {
+					return {};
+				},
+				[](const fastgltf::sources::Array& array) -> fastgltf::span<const std::byte> {
+					return fastgltf::span(reinterpret_cast<const std::byte*>(array.bytes.data()), array.bytes.size_bytes());
+				},
+				[](const fastgltf::sources::Vector& vector) -> fastgltf::span<const std::byte> {
+					return fastgltf::span(reinterpret_cast<const std::byte*>(vector.bytes.data()), vector.bytes.size());
+				},
+				[](const fastgltf::sources::ByteView& byteView) -> fastgltf::span<const std::byte> {
+					return byteView.bytes;
+				},
+			}, std::as_const(asset.buffers[compression.bufferIndex].data));
+
+			if (compression.byteOffset > source.size() || compression.byteLength > source.size() - compression.byteOffset)
+			{
+				std::cerr << "Meshopt compressed buffer view points outside its buffer" << std::endl;
+				return false;
+			}
+
+			const uint8_t* encoded = reinterpret_cast<const uint8_t*>(source.data() + compression.byteOffset);
+
+			if (compression.byteStride == 0 || compression.count > MAX_DECODED_VIEW_SIZE / compression.byteStride)
+			{
+				std::cerr << "Meshopt compressed buffer view decodes to an implausible size" << std::endl;
+				return false;
+			}
+
+			fastgltf::sources::Vector decoded;
+			decoded.bytes.resize(compression.count * compression.byteStride);
+
+			bool success = false;
+			switch (compression.mode)
+			{
+			case fastgltf::MeshoptCompressionMode::Attributes:
+				success = DecodeMeshoptVertexBuffer(decoded.bytes.data(), compression.count, compression.byteStride, encoded, compression.byteLength);
+				break;
+			case fastgltf::MeshoptCompressionMode::Triangles:
+				success = DecodeMeshoptIndexBuffer(decoded.bytes.data(), compression.count, compression.byteStride, encoded, compression.byteLength);
+				break;
+			case fastgltf::MeshoptCompressionMode::Indices:
+				success = DecodeMeshoptIndexSequence(decoded.bytes.data(), compression.count, compression.byteStride, encoded, compression.byteLength);
+				break;
+			}
+
+			if (!success)
+			{
+				std::cerr << "Failed to decode meshopt compressed buffer view" << std::endl;
+				return false;
+			}
+
+			if (compression.mode == fastgltf::MeshoptCompressionMode::Attributes)
+			{
+				MeshoptFilter filter = MeshoptFilter::None;
+				if (compression.filter == fastgltf::MeshoptCompressionFilter::Octahedral)
+					filter = MeshoptFilter::Octahedral;
+				else if (compression.filter == fastgltf::MeshoptCompressionFilter::Quaternion)
+					filter = MeshoptFilter::Quaternion;
+				else if (compression.filter == fastgltf::MeshoptCompressionFilter::Exponential)
+					filter = MeshoptFilter::Exponential;
+
+				ApplyMeshoptFilter(decoded.bytes.data(), compression.count, compression.byteStride, filter);
+			}
+
+			// Repoint the view at its own decoded buffer, so accessors read it like uncompressed data
+			fastgltf::Buffer buffer;
+			buffer.byteLength = decoded.bytes.size();
+			buffer.data = std::move(decoded);
+
+			bufferView.bufferIndex = asset.buffers.size();
+			bufferView.byteOffset = 0;
+			bufferView.byteLength = buffer.byteLength;
+			bufferView.meshoptCompression.reset();
+
+			asset.buffers.push_back(std::move(buffer));
+		}
+
+		return true;
+	}
+
+	void ModelImporter::OptimizePrimitive(MeshPrimitiveInfo& primitiveInfo, double& acmrBefore, double& acmrAfter, size_t& triangleCount) const
+	{
+		auto& indices = primitiveInfo.indices;
+		size_t vertexCount = primitiveInfo.vertices.size();
+
+		// Only triangle lists are reordered, anything else is uploaded as authored
+		if (!settings.optimizeMeshes || indices.empty() || indices.size() % 3 != 0)
+		{
+			GenerateLods(primitiveInfo);
+			return;
+		}
+
+		size_t triangles = indices.size() / 3;
+		acmrBefore += ComputeAcmr(indices.data(), indices.size(), vertexCount) * triangles;
+
+		OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+
+		// Blended surfaces draw every fragment regardless of order
+		if (!primitiveInfo.enableTransparency)
+			OptimizeOverdraw(indices.data(), indices.size(), primitiveInfo.vertices);
+
+		acmrAfter += ComputeAcmr(indices.data(), indices.size(), vertexCount) * triangles;
+		triangleCount += triangles;
+
+		GenerateLods(primitiveInfo);
+
+		// After the LODs so every level shares one first use order, full detail vertices come first
+		OptimizeVertexFetch(primitiveInfo.vertices, indices);
+	}
+
+	void ModelImporter::GenerateLods(MeshPrimitiveInfo& primitiveInfo) const
+	{
+		constexpr size_t MAX_LOD_COUNT = 4;
+		// Below this many triangles the extra draws cost more than the vertices saved
+		constexpr size_t MIN_LOD_TRIANGLES = 256;
+		// Relative to the primitive size, stops simplification before the silhouette breaks down
+		constexpr float MAX_RELATIVE_ERROR = 0.05f;
+
+		size_t indexCount = primitiveInfo.indices.size();
+		primitiveInfo.lods = { MeshLod{ 0, static_cast<uint32_t>(indexCount), 0.0f } };
+
+		if (!settings.generateLods || indexCount % 3 != 0 || indexCount / 3 < MIN_LOD_TRIANGLES || !primitiveInfo.bounds.IsValid())
+			return;
+
+		MeshSimplifier simplifier(primitiveInfo.vertices, primitiveInfo.indices);
+
+		glm::vec3 extents = primitiveInfo.bounds.max - primitiveInfo.bounds.min;
+		float maxError = std::max(extents.x, std::max(extents.y, extents.z)) * MAX_RELATIVE_ERROR;
+
+		size_t previousCount = indexCount;
+		for (size_t level = 1; level < MAX_LOD_COUNT; ++level)
+		{
+			size_t target = (indexCount >> level) / 3 * 3;
+
+			float error = 0.0f;
+			std::vector<uint32_t> lodIndices = simplifier.Simplify(target, maxError, error);
+
+			// Not worth a level when the error bound stopped it close to the previous one
+			if (lodIndices.size() / 3 < MIN_LOD_TRIANGLES / 4 || lodIndices.size() > previousCount * 4 / 5)
+				break;
+
+			MeshLod lod;
+			lod.firstIndex = static_cast<uint32_t>(primitiveInfo.indices.size());
+			lod.indexCount = static_cast<uint32_t>(lodIndices.size());
+			lod.error = std::max(error, primitiveInfo.lods.back().error);
+			primitiveInfo.lods.push_back(lod);
+
+			OptimizeVertexCache(lodIndices.data(), lodIndices.size(), primitiveInfo.vertices.size());
+
+			primitiveInfo.indices.insert(primitiveInfo.indices.end(), lodIndices.begin(), lodIndices.end());
+
+			previousCount = lodIndices.size();
+		}
+	}
+
+	void ModelImporter::BuildCollision(MeshData& meshData) const
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<uint32_t> indices;
+
+		for (const auto& primitiveInfo : meshData.primitiveInfo)
+		{
+			uint32_t baseVertex = static_cast<uint32_t>(positions.size());
+
+			for (const auto& vertex : primitiveInfo.vertices)
+				positions.push_back(vertex.position);
+
+			// Full detail level only
+			size_t indexCount = primitiveInfo.lods.empty() ? primitiveInfo.indices.size() : primitiveInfo.lods[0].indexCount;
+			for (size_t i = 0; i < indexCount; ++i)
+				indices.push_back(baseVertex + primitiveInfo.indices[i]);
+		}
+
+		if (indices.empty())
+			return;
+
+		meshData.collision = std::make_shared<TriangleBVH>();
+		meshData.collision->Build(positions, indices);
+	}
+
+	void ModelImporter::LoadTextures(std::shared_ptr<Model>& model) const
+	{
+		fastgltf::Asset& asset = model->gltfAsset;
+
+		// Workers write disjoint slots, results are gathered by image index
+		std::vector<ImageData> decodedImages(asset.images.size());
+		std::vector<uint8_t> decodedFlags(asset.images.size(), 0);
+
+		jobSystem->ParallelFor(asset.images.size(), [&](size_t imageIndex)
+			{
+				ImageData& data = decodedImages[imageIndex];
+				decodedFlags[imageIndex] = DecodeImage(asset, asset.images[imageIndex], data.pixels, data.width, data.height, data.channels);
+			});
+
+		for (size_t imageIndex = 0; imageIndex < asset.images.size(); ++imageIndex)
+		{
+			if (!decodedFlags[imageIndex])
+				std::cerr << "Failed to decode image at index " << imageIndex << std::endl;
+		}
+
+		// Base color textures are the only sRGB ones, one pass over the materials
+		std::vector<uint8_t> sRGBTextures(asset.textures.size(), 0);
+		for (const auto& material : asset.materials)
+		{
+			if (material.pbrData.baseColorTexture.has_value() && material.pbrData.baseColorTexture->textureIndex < sRGBTextures.size())
+				sRGBTextures[material.pbrData.baseColorTexture->textureIndex] = 1;
+		}
+
+		// Images shared by several textures are copied, the last user takes the pixels
+		std::vector<size_t> imageUsers(asset.images.size(), 0);
+		for (const auto& texture : asset.textures)
+		{
+			if (texture.imageIndex.has_value() && texture.imageIndex.value() < imageUsers.size())
+				++imageUsers[texture.imageIndex.value()];
+		}
+
+		model->textureData.clear();
+		model->textureData.resize(asset.textures.size());
+
+		for (size_t textureIndex = 0; textureIndex < asset.textures.size(); ++textureIndex)
+		{
+			const auto& texture = asset.textures[textureIndex];
+
+			auto imageIndex = texture.imageIndex;
+
+			if (!imageIndex.has_value() || imageIndex.value() >= decodedImages.size() || !decodedFlags[imageIndex.value()])
+			{
+				std::cerr << "Texture " << textureIndex << " references a missing image." << std::endl;
+				continue;
+			}
+
+			auto& imageData = decodedImages[imageIndex.value()];
+
+			model->textureData[textureIndex] = TextureData
+			{
+				--imageUsers[imageIndex.value()] == 0 ? std::move(imageData.pixels) : imageData.pixels,
+				imageData.width,
+				imageData.height,
+				imageData.channels,
+				sRGBTextures[textureIndex] != 0
+			};
+		}
+	}
+
+	bool ModelImporter::DecodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight, int& outChannels) const
+	{
+		bool decoded = false;
+
+		auto decodeBytes = [&](const std::byte* bytes, size_t size)
+			{
+				// Per thread, so standalone texture loads on other threads cannot flip model images
+				stbi_set_flip_vertically_on_load_thread(false);
+
+				unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(bytes), static_cast<int>(size), &outWidth, &outHeight, &outChannels, 4);
+				if (pixels)
+				{
+					outPixels.assign(pixels, pixels + (outWidth * outHeight * 4));
+
+					outChannels = 4;
+
+					stbi_image_free(pixels);
+
+					decoded = true;
+				}
+				else
+				{
+					std::cerr << "STB Image failed to decode image." << std::endl;
+				}
+			};
+
+		std::visit(fastgltf::visitor
+			{
+				[&](const fastgltf::sources::URI& filePath)
+				{
+					std::cerr << "External image could not be loaded: " << filePath.uri.string() << std::endl;
+				},
+				[&](const fastgltf::sources::Array& vector)
+				{
+					decodeBytes(vector.bytes.data(), vector.bytes.size());
+				},
+				[&](const fastgltf::sources::BufferView& view)
+				{
+					if (view.bufferViewIndex >= asset.bufferViews.size())
+					{
+						std::cerr << "Invalid buffer view index in image." << std::endl;
+						return;
+					}
+
+					auto& bufferView = asset.bufferViews[view.bufferViewIndex];
+					auto& buffer = asset.buffers[bufferView.bufferIndex];
+
+					std::visit(fastgltf::visitor
+						{
+							[&](const fastgltf::sources::Array& vector)
+							{
+								decodeBytes(vector.bytes.data() + bufferView.byteOffset, bufferView.byteLength);
+							},
+							[](auto& arg) {}
+						}, buffer.data);
+				},
+				[](auto& arg) {}
+			}, image.data);
+
+		return decoded;
+	}
+}
\ No newline at end of file
@@ -1,68 +1,151 @@
 #include "Core/ModelManager.h"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-
-#include <stb_image.h>
+#include <limits>
+#include <thread>
 
 #include "Core/Transform.h"
 #include "Core/Model.h"
+#include "Core/CookedModel.h"
 #include "Core/Mesh.h"
 #include "Core/MeshPrimitive.h"
 #include "Core/MeshInstance.h"
+#include "Core/TriangleBVH.h"
+#include "Core/JobSystem.h"
+#include "Vulkan/Device.h"
 #include "Vulkan/Texture.h"
 
 namespace Nightbird
 {
-	ModelManager::ModelManager(VulkanDevice* device, VkDescriptorSetLayout uniformDescriptorSetLayout, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool)
-		: device(device), uniformDescriptorSetLayout(uniformDescriptorSetLayout), materialDescriptorSetLayout(materialDescriptorSetLayout), descriptorPool(descriptorPool)
+	ModelManager::ModelManager(VulkanDevice* device, JobSystem* jobSystem, VkDescriptorSetLayout uniformDescriptorSetLayout, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool)
+		: device(device), jobSystem(jobSystem), uniformDescriptorSetLayout(uniformDescriptorSetLayout), materialDescriptorSetLayout(materialDescriptorSetLayout), descriptorPool(descriptorPool), models(std::make_shared<ModelMap>()), importer(jobSystem)
 	{
 		fallbackTexture = CreateFallbackTexture(glm::vec4(1.0f));
 	}
 
 	ModelManager::~ModelManager()
 	{
+		// Queued loads are skipped, running ones stop at their next cancellation check
+		for (auto& [path, pending] : pendingLoads)
+			pending.job.Cancel();
 
+		for (auto& [path, pending] : pendingLoads)
+			jobSystem->Wait(pending.job);
 	}
 
-	const std::unordered_map<std::string, std::shared_ptr<Model>>& ModelManager::GetModels()
+	std::shared_ptr<const ModelManager::ModelMap> ModelManager::GetModels() const
 	{
-		return models;
+		return std::atomic_load(&models);
 	}
 
-	std::shared_ptr<Model> ModelManager::GetModel(const std::string& path)
+	std::shared_ptr<Model> ModelManager::GetModel(const std::string& path) const
 	{
-		return models[path];
+		auto snapshot = GetModels();
+
+		auto it = snapshot->find(path);
+		return it != snapshot->end() ? it->second : nullptr;
 	}
 
 	std::shared_ptr<Model> ModelManager::LoadModel(const std::filesystem::path& path)
 	{
-		auto model = LoadModelInternal(path);
-		if (model)
+		std::string pathKey = path.string();
+
+		auto existing = GetModel(pathKey);
+		if (existing && existing->resident)
+			return existing;
+
+		// Finish the async load instead of parsing the file a second time
+		if (auto pending = pendingLoads.find(pathKey); pending != pendingLoads.end())
 		{
-			UploadModel(model);
-			models[path.string()] = model;
+			jobSystem->Wait(pending->second.job);
+
+			// The caller blocks anyway, so this load and any queued before it upload without a budget
+			while (pendingLoads.count(pathKey) > 0)
+				ProcessUploads(std::numeric_limits<double>::max(), std::numeric_limits<VkDeviceSize>::max());
+
+			auto model = GetModel(pathKey);
+			return model && model->resident ? model : nullptr;
 		}
+
+		auto model = LoadModelInternal(path);
+		if (!model)
+			return nullptr;
+
+		model = PrepareUpload(model);
+		if (!model)
+			return nullptr;
+
+		UploadModel(model);
+		FinishUpload(model);
 		return model;
 	}
 
-	void ModelManager::LoadModelAsync(const std::filesystem::path& path, LoadCallback callback)
+	std::shared_future<std::shared_ptr<Model>> ModelManager::LoadModelAsync(const std::filesystem::path& path, LoadCallback callback, JobPriority priority)
 	{
-		modelFutures[path.string()] = std::async(std::launch::async, [this, path, callback]()
+		std::string pathKey = path.string();
+
+		auto existing = GetModel(pathKey);
+		if (existing && existing->resident)
+		{
+			if (callback)
+				callback(existing);
+
+			std::promise<std::shared_ptr<Model>> ready;
+			ready.set_value(existing);
+			return ready.get_future().share();
+		}
+
+		// Later requests for the same path wait on the first one
+		auto pending = pendingLoads.find(pathKey);
+		if (pending != pendingLoads.end())
+		{
+			if (callback)
+				pending->second.callbacks.push_back(std::move(callback));
+			return pending->second.future;
+		}
+
+		auto promise = std::make_shared<std::promise<std::shared_ptr<Model>>>();
+
+		PendingLoad& load = pendingLoads[pathKey];
+		load.future = promise->get_future().share();
+		if (callback)
+			load.callbacks.push_back(std::move(callback));
+
+		load.job = jobSystem->Schedule([this, path, promise]()
 			{
 				auto model = LoadModelInternal(path);
 				if (model)
 				{
 					std::lock_guard<std::mutex> lock(uploadQueueMutex);
-					pendingCallbacks[model->path] = callback;
 					uploadQueue.push(model);
 				}
-				return model;
-			});
+				promise->set_value(model);
+			}, priority);
+
+		return load.future;
 	}
 
 	void ModelManager::ProcessUploadQueue()
+	{
+		ProcessUploads(uploadBudgetMilliseconds, uploadBudgetBytes);
+	}
+
+	void ModelManager::SetUploadBudget(double milliseconds, VkDeviceSize bytes)
+	{
+		uploadBudgetMilliseconds = milliseconds;
+		uploadBudgetBytes = bytes;
+	}
+
+	void ModelManager::SetCookOnImport(bool enabled)
+	{
+		cookOnImport = enabled;
+	}
+
+	void ModelManager::ProcessUploads(double budgetMilliseconds, VkDeviceSize budgetBytes)
 	{
 		static std::thread::id mainThreadId = std::this_thread::get_id();
 
@@ -72,419 +155,283 @@ namespace Nightbird
 			return;
 		}
 
-		std::lock_guard<std::mutex> lock(uploadQueueMutex);
-		while (!uploadQueue.empty())
+		// The lock only covers the swap, loader threads never wait on an upload
+		std::queue<std::shared_ptr<Model>> readyModels;
 		{
-			auto model = uploadQueue.front();
-			uploadQueue.pop();
+			std::lock_guard<std::mutex> lock(uploadQueueMutex);
+			std::swap(readyModels, uploadQueue);
+		}
 
-			UploadModel(model);
-			models[model->path] = model;
+		while (!readyModels.empty())
+		{
+			std::string path = readyModels.front()->path;
+			auto model = PrepareUpload(readyModels.front());
+			readyModels.pop();
 
-			auto it = pendingCallbacks.find(model->path);
-			if (it != pendingCallbacks.end())
-			{
-				if (it->second)
-					it->second(model);
-				pendingCallbacks.erase(it);
-			}
+			if (model)
+				uploadTasks.push_back({ model });
+			else
+				pendingLoads.erase(path);
 		}
-	}
-
-	std::shared_ptr<Model> ModelManager::LoadModelInternal(const std::filesystem::path& path)
-	{
-		std::string pathKey = path.string();
 
-		auto it = models.find(pathKey);
-		if (it != models.end())
+		// At least one step per call, so a single large texture cannot stall the queue
+		auto start = std::chrono::steady_clock::now();
+		VkDeviceSize uploadedBytes = 0;
+		for (size_t steps = 0; !uploadTasks.empty(); ++steps)
 		{
-			return it->second;
-		}
+			double elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (steps > 0 && (uploadedBytes >= budgetBytes || elapsedMilliseconds >= budgetMilliseconds))
+				break;
 
-		fastgltf::Parser parser;
+			UploadTask& task = uploadTasks.front();
+			if (UploadStep(task, uploadedBytes))
+			{
+				auto model = task.model;
+				uploadTasks.pop_front();
+				FinishUpload(model);
+			}
+		}
 
-		auto data = fastgltf::GltfDataBuffer::FromPath(path);
-		if (data.error() != fastgltf::Error::None)
+		// Failed loads never reach the upload queue, drop them once their result is in
+		for (auto it = pendingLoads.begin(); it != pendingLoads.end();)
 		{
-			std::cout << "fastgltf get buffer error: " << fastgltf::getErrorMessage(data.error()) << std::endl;
-			return nullptr;
+			const auto& future = it->second.future;
+			if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready && !future.get())
+			{
+				std::cerr << "Failed to load model at " << it->first << std::endl;
+				it = pendingLoads.erase(it);
+			}
+			else
+			{
+				++it;
+			}
 		}
+	}
 
-		auto asset = parser.loadGltfBinary(data.get(), path.parent_path(), fastgltf::Options::None);
-		if (asset.error() != fastgltf::Error::None)
+	std::shared_ptr<Model> ModelManager::PrepareUpload(std::shared_ptr<Model> model)
+	{
+		auto existing = GetModel(model->path);
+		if (existing && !existing->resident)
 		{
-			std::cout << "fastgltf get data error: " << fastgltf::getErrorMessage(asset.error()) << std::endl;
-			return nullptr;
+			// Reload of an evicted model, rebuild into the Mesh objects instances already hold
+			if (!RestoreModel(existing, model))
+				return nullptr;
+			return existing;
 		}
 
-		std::shared_ptr<Model> model = std::make_shared<Model>();
-		model->path = pathKey;
-		model->gltfAsset = std::move(asset.get());
-
-		auto& gltfAsset = model->gltfAsset;
-
-		LoadTextures(model);
+		return model;
+	}
 
-		for (size_t meshIndex = 0; meshIndex < gltfAsset.meshes.size(); ++meshIndex)
+	void ModelManager::FinishUpload(std::shared_ptr<Model> model)
+	{
+		if (!GetModel(model->path))
 		{
-			const fastgltf::Mesh& gltfMesh = gltfAsset.meshes[meshIndex];
-
-			MeshData meshData;
-
-			for (size_t primitiveIndex = 0; primitiveIndex < gltfMesh.primitives.size(); ++primitiveIndex)
-			{
-				const fastgltf::Primitive& primitive = gltfMesh.primitives[primitiveIndex];
-
-				auto positionIt = primitive.findAttribute("POSITION");
-				auto normalIt = primitive.findAttribute("NORMAL");
-				auto tangentIt = primitive.findAttribute("TANGENT");
-
-				MeshPrimitiveInfo primitiveInfo{};
-
-				if (positionIt != primitive.attributes.end())
-				{
-					const auto& positionAccessor = gltfAsset.accessors[positionIt->accessorIndex];
-					primitiveInfo.vertices.resize(positionAccessor.count);
-
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(gltfAsset, positionAccessor, [&](fastgltf::math::fvec3 position, std::size_t verticeIndex)
-						{
-							primitiveInfo.vertices[verticeIndex].position = glm::vec3(position.x(), position.y(), position.z());
-						});
-				}
+			auto next = std::make_shared<ModelMap>(*GetModels());
+			(*next)[model->path] = model;
+			std::atomic_store(&models, std::shared_ptr<const ModelMap>(std::move(next)));
+		}
 
-				if (normalIt != primitive.attributes.end())
-				{
-					auto& normalAccessor = gltfAsset.accessors[normalIt->accessorIndex];
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(gltfAsset, normalAccessor, [&](fastgltf::math::fvec3 normal, std::size_t verticeIndex)
-						{
-							primitiveInfo.vertices[verticeIndex].normal = glm::vec3(normal.x(), normal.y(), normal.z());
-						});
-				}
+		auto pending = pendingLoads.find(model->path);
+		if (pending == pendingLoads.end())
+			return;
 
-				if (tangentIt != primitive.attributes.end())
-				{
-					auto& tangentAccessor = gltfAsset.accessors[tangentIt->accessorIndex];
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(gltfAsset, tangentAccessor, [&](fastgltf::math::fvec4 tangent, std::size_t verticeIndex)
-						{
-							//primitiveInfo.vertices[verticeIndex].tangent = glm::vec4(tangent.x(), tangent.y(), tangent.z(), tangent.w());
-						});
-				}
+		// Taken out first, callbacks may start new loads
+		std::vector<LoadCallback> callbacks = std::move(pending->second.callbacks);
+		pendingLoads.erase(pending);
 
-				if (primitive.indicesAccessor.has_value())
-				{
-					const auto& indexAccessor = gltfAsset.accessors[primitive.indicesAccessor.value()];
-					fastgltf::iterateAccessorWithIndex<std::uint16_t>(gltfAsset, indexAccessor, [&](std::uint16_t index, std::size_t verticeIndex)
-						{
-							primitiveInfo.indices.push_back(index);
-						});
-				}
+		for (auto& callback : callbacks)
+			callback(model);
+	}
 
-				std::size_t baseColorTexcoordIndex = 0;
-				std::size_t metallicRoughnessTexcoordIndex = 0;
-				std::size_t normalTexcoordIndex = 0;
-				if (primitive.materialIndex.has_value())
-				{
-					auto& material = gltfAsset.materials[primitive.materialIndex.value()];
-
-					primitiveInfo.enableTransparency = (material.alphaMode == fastgltf::AlphaMode::Blend);
-					primitiveInfo.doubleSided = material.doubleSided;
-
-					const auto& baseColorFactor = material.pbrData.baseColorFactor;
-					primitiveInfo.baseColorFactor = glm::vec4(baseColorFactor.x(), baseColorFactor.y(), baseColorFactor.z(), baseColorFactor.w());
-
-					auto& baseColorTexture = material.pbrData.baseColorTexture;
-					if (baseColorTexture.has_value())
-					{
-						auto& texture = gltfAsset.textures[baseColorTexture->textureIndex];
-						if (texture.imageIndex.has_value())
-						{
-							if (baseColorTexture->transform && baseColorTexture->transform->texCoordIndex.has_value())
-							{
-								baseColorTexcoordIndex = baseColorTexture->transform->texCoordIndex.value();
-							}
-							else
-							{
-								baseColorTexcoordIndex = material.pbrData.baseColorTexture->texCoordIndex;
-							}
-						}
-					}
-
-					primitiveInfo.metallicFactor = material.pbrData.metallicFactor;
-					primitiveInfo.roughnessFactor = material.pbrData.roughnessFactor;
-
-					auto& metallicRoughnessTexture = material.pbrData.metallicRoughnessTexture;
-					if (metallicRoughnessTexture.has_value())
-					{
-						auto& texture = gltfAsset.textures[metallicRoughnessTexture->textureIndex];
-						if (texture.imageIndex.has_value())
-						{
-							if (metallicRoughnessTexture->transform && metallicRoughnessTexture->transform->texCoordIndex.has_value())
-							{
-								metallicRoughnessTexcoordIndex = metallicRoughnessTexture->transform->texCoordIndex.value();
-							}
-							else
-							{
-								metallicRoughnessTexcoordIndex = material.pbrData.baseColorTexture->texCoordIndex;
-							}
-						}
-					}
-
-					auto& normalTexture = material.normalTexture;
-					if (normalTexture.has_value())
-					{
-						auto& texture = gltfAsset.textures[normalTexture->textureIndex];
-						if (texture.imageIndex.has_value())
-						{
-							if (normalTexture->transform && normalTexture->transform->texCoordIndex.has_value())
-							{
-								normalTexcoordIndex = normalTexture->transform->texCoordIndex.value();
-							}
-							else
-							{
-								normalTexcoordIndex = material.normalTexture->texCoordIndex;
-							}
-						}
-					}
-				}
+	std::shared_ptr<Model> ModelManager::LoadModelInternal(const std::filesystem::path& path)
+	{
+		std::string pathKey = path.string();
 
-				auto baseColorTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(baseColorTexcoordIndex);
-				if (const auto* texcoord = primitive.findAttribute(baseColorTexcoordAttribute); texcoord != primitive.attributes.end())
-				{
-					auto& texcoordAccessor = gltfAsset.accessors[texcoord->accessorIndex];
-					if (texcoordAccessor.bufferViewIndex.has_value())
-					{
-						fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(gltfAsset, texcoordAccessor, [&](fastgltf::math::fvec2 uv, std::size_t idx)
-							{
-								primitiveInfo.vertices[idx].baseColorTexCoord = glm::vec2(uv.x(), uv.y());
-							});
-					}
-				}
+		// A cooked sibling next to the source is used as long as the source hasn't changed since
+		std::filesystem::path cookedPath = path;
+		if (path.extension() != CookedModelExtension)
+			cookedPath += CookedModelExtension;
 
-				auto metallicRoughnessTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(metallicRoughnessTexcoordIndex);
-				if (const auto* texcoord = primitive.findAttribute(metallicRoughnessTexcoordAttribute); texcoord != primitive.attributes.end())
-				{
-					auto& texcoordAccessor = gltfAsset.accessors[texcoord->accessorIndex];
-					if (texcoordAccessor.bufferViewIndex.has_value())
-					{
-						fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(gltfAsset, texcoordAccessor, [&](fastgltf::math::fvec2 uv, std::size_t idx)
-							{
-								primitiveInfo.vertices[idx].metallicRoughnessTexCoord = glm::vec2(uv.x(), uv.y());
-							});
-					}
-				}
+		std::error_code error;
+		if (std::filesystem::exists(cookedPath, error))
+		{
+			// Shipped builds may carry only the cooked file, it is then taken as is
+			bool checkSource = cookedPath != path && std::filesystem::exists(path, error);
+			auto cookedModel = ReadCookedModel(cookedPath, checkSource ? path : std::filesystem::path());
+			if (cookedModel)
+			{
+				cookedModel->path = pathKey;
+				return cookedModel;
+			}
+		}
 
-				auto normalTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(normalTexcoordIndex);
-				if (const auto* texcoord = primitive.findAttribute(normalTexcoordAttribute); texcoord != primitive.attributes.end())
-				{
-					auto& texcoordAccessor = gltfAsset.accessors[texcoord->accessorIndex];
-					if (texcoordAccessor.bufferViewIndex.has_value())
-					{
-						fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(gltfAsset, texcoordAccessor, [&](fastgltf::math::fvec2 uv, std::size_t idx)
-							{
-								primitiveInfo.vertices[idx].normalTexCoord = glm::vec2(uv.x(), uv.y());
-							});
-					}
-				}
+		if (cookedPath == path)
+		{
+			std::cerr << "Failed to read cooked model at " << pathKey << std::endl;
+			return nullptr;
+		}
 
-				if (primitive.materialIndex.has_value())
-				{
-					const auto& material = gltfAsset.materials[primitive.materialIndex.value()];
-
-					if (material.pbrData.baseColorTexture.has_value())
-					{
-						const auto& texture = gltfAsset.textures[material.pbrData.baseColorTexture->textureIndex];
-						if (texture.imageIndex.has_value())
-						{
-							auto imageIndex = texture.imageIndex.value();
-							primitiveInfo.baseColorTextureIndex = imageIndex;
-							primitiveInfo.hasBaseColorTexture = true;
-						}
-					}
-					if (material.pbrData.metallicRoughnessTexture.has_value())
-					{
-						const auto& texture = gltfAsset.textures[material.pbrData.metallicRoughnessTexture->textureIndex];
-						if (texture.imageIndex.has_value())
-						{
-							auto imageIndex = texture.imageIndex.value();
-							primitiveInfo.metallicRoughnessTextureIndex = imageIndex;
-							primitiveInfo.hasMetallicRoughnessTexture = true;
-						}
-					}
-					if (material.normalTexture.has_value())
-					{
-						const auto& texture = gltfAsset.textures[material.normalTexture->textureIndex];
-						if (texture.imageIndex.has_value())
-						{
-							auto imageIndex = texture.imageIndex.value();
-							primitiveInfo.normalTextureIndex = imageIndex;
-							primitiveInfo.hasNormalTexture = true;
-						}
-					}
-				}
+		// Taken before the import, so a source saved during it shows up as changed on the next load
+		CookedSourceInfo sourceInfo;
+		std::vector<CookedDependency> dependencies;
+		bool cook = cookOnImport && GetCookedSourceInfo(path, sourceInfo) && GetCookedDependencies(path, dependencies);
 
-				meshData.primitiveInfo.push_back(std::move(primitiveInfo));
-			}
+		auto model = importer.Import(path);
+		if (!model)
+			return nullptr;
 
-			model->meshData.push_back(std::move(meshData));
-		}
+		// A failed write only costs the next load a full import
+		if (cook && !JobSystem::IsCurrentJobCancelled() && !WriteCookedModel(*model, sourceInfo, dependencies, cookedPath))
+			std::cerr << "Failed to cook " << pathKey << std::endl;
 
 		return model;
 	}
 
 	void ModelManager::UploadModel(std::shared_ptr<Model>& model)
 	{
-		model->textures.reserve(model->textureData.size());
+		UploadTask task{ model };
+		VkDeviceSize uploadedBytes = 0;
+		while (!UploadStep(task, uploadedBytes))
+		{
+		}
+	}
 
-		for (size_t i = 0; i < model->textureData.size(); ++i)
+	bool ModelManager::UploadStep(UploadTask& task, VkDeviceSize& uploadedBytes)
+	{
+		Model& model = *task.model;
+
+		// Textures first, primitives bind them when created
+		if (task.textureIndex < model.textureData.size())
 		{
-			auto& textureData = model->textureData[i];
+			auto& textureData = model.textureData[task.textureIndex];
 
-			if (!textureData.pixels.empty())
+			const uint8_t* pixels = textureData.pixels.empty() ? textureData.mappedPixels : textureData.pixels.data();
+			if (pixels)
 			{
-				model->textures[i] = std::make_shared<VulkanTexture>(device, textureData.pixels.data(), textureData.width, textureData.height, textureData.sRGB);
+				auto texture = std::make_shared<VulkanTexture>(device, pixels, textureData.width, textureData.height, textureData.sRGB);
+				uploadedBytes += texture->GetMemorySize();
+				model.textures[task.textureIndex] = texture;
 			}
+
+			++task.textureIndex;
+			return false;
 		}
 
-		for (auto& meshData : model->meshData)
+		if (task.meshIndex < model.meshData.size())
 		{
-			auto mesh = std::make_shared<Mesh>(device, uniformDescriptorSetLayout);
+			auto& meshData = model.meshData[task.meshIndex];
+
+			// Restored models already hold their Mesh objects
+			if (task.meshIndex >= model.meshes.size())
+				model.meshes.push_back(std::make_shared<Mesh>(device, uniformDescriptorSetLayout));
+
+			auto& mesh = model.meshes[task.meshIndex];
 
-			for (auto& primitiveInfo : meshData.primitiveInfo)
+			if (task.primitiveIndex < meshData.primitiveInfo.size())
 			{
-				if (primitiveInfo.hasBaseColorTexture && model->textures.count(primitiveInfo.baseColorTextureIndex))
-					primitiveInfo.baseColorTexture = model->textures[primitiveInfo.baseColorTextureIndex];
+				auto& primitiveInfo = meshData.primitiveInfo[task.primitiveIndex];
+
+				if (primitiveInfo.hasBaseColorTexture && model.textures.count(primitiveInfo.baseColorTextureIndex))
+					primitiveInfo.baseColorTexture = model.textures[primitiveInfo.baseColorTextureIndex];
 				else
 					primitiveInfo.baseColorTexture = fallbackTexture;
 
-				if (primitiveInfo.hasMetallicRoughnessTexture && model->textures.count(primitiveInfo.metallicRoughnessTextureIndex))
-					primitiveInfo.metallicRoughnessTexture = model->textures[primitiveInfo.metallicRoughnessTextureIndex];
+				if (primitiveInfo.hasMetallicRoughnessTexture && model.textures.count(primitiveInfo.metallicRoughnessTextureIndex))
+					primitiveInfo.metallicRoughnessTexture = model.textures[primitiveInfo.metallicRoughnessTextureIndex];
 				else
 					primitiveInfo.metallicRoughnessTexture = fallbackTexture;
 
-				if (primitiveInfo.hasNormalTexture && model->textures.count(primitiveInfo.normalTextureIndex))
-					primitiveInfo.normalTexture = model->textures[primitiveInfo.normalTextureIndex];
+				if (primitiveInfo.hasNormalTexture && model.textures.count(primitiveInfo.normalTextureIndex))
+					primitiveInfo.normalTexture = model.textures[primitiveInfo.normalTextureIndex];
 				else
 					primitiveInfo.normalTexture = fallbackTexture;
 
 				auto meshPrimitive = std::make_unique<MeshPrimitive>(device, materialDescriptorSetLayout, descriptorPool, primitiveInfo);
+				uploadedBytes += meshPrimitive->GetMemorySize();
 				mesh->AddPrimitive(std::move(meshPrimitive));
+
+				++task.primitiveIndex;
 			}
 
-			model->meshes.push_back(mesh);
-		}
-	}
+			if (task.primitiveIndex >= meshData.primitiveInfo.size())
+			{
+				if (meshData.collision)
+					mesh->SetCollision(meshData.collision);
 
-	void ModelManager::LoadTextures(std::shared_ptr<Model>& model)
-	{
-		fastgltf::Asset& asset = model->gltfAsset;
+				mesh->SetResident(true);
 
-		std::unordered_map<size_t, ImageData> decodedImages;
+				++task.meshIndex;
+				task.primitiveIndex = 0;
+			}
 
-		for (size_t imageIndex = 0; imageIndex < asset.images.size(); ++imageIndex)
-		{
-			auto& image = asset.images[imageIndex];
+			return false;
+		}
 
-			ImageData data;
+		model.gpuMemorySize = 0;
+		for (const auto& [index, texture] : model.textures)
+			model.gpuMemorySize += texture->GetMemorySize();
+		for (const auto& mesh : model.meshes)
+			model.gpuMemorySize += mesh->GetMemorySize();
 
-			if (DecodeImage(asset, image, data.pixels, data.width, data.height, data.channels))
-				decodedImages[imageIndex] = std::move(data);
-			else
-				std::cerr << "Failed to decode image at index " << imageIndex << std::endl;
+		model.resident = true;
+		return true;
+	}
+
+	bool ModelManager::RestoreModel(std::shared_ptr<Model>& evictedModel, std::shared_ptr<Model>& loadedModel)
+	{
+		if (loadedModel->meshData.size() != evictedModel->meshes.size())
+		{
+			std::cerr << "Model changed on disk since eviction, cannot restore: " << evictedModel->path << std::endl;
+			return false;
 		}
 
-		model->textureData.clear();
-		model->textureData.resize(asset.textures.size());
+		evictedModel->textureData = std::move(loadedModel->textureData);
+		evictedModel->meshData = std::move(loadedModel->meshData);
+		evictedModel->mappedFile = std::move(loadedModel->mappedFile);
 
-		for (size_t textureIndex = 0; textureIndex < asset.textures.size(); ++textureIndex)
-		{
-			const auto& texture = asset.textures[textureIndex];
+		return true;
+	}
 
-			auto imageIndex = texture.imageIndex;
+	void ModelManager::EvictModel(const std::string& path, uint64_t frameNumber)
+	{
+		auto model = GetModel(path);
+		if (!model || !model->resident)
+			return;
 
-			if (!imageIndex.has_value() || decodedImages.count(imageIndex.value()) == 0)
-			{
-				std::cerr << "Texture " << textureIndex << " references a missing image." << std::endl;
-				continue;
-			}
+		// Primitives may still be referenced by command buffers in flight
+		RetiredResources retired;
+		retired.frameNumber = frameNumber;
+		for (auto& mesh : model->meshes)
+		{
+			for (auto& primitive : mesh->ReleasePrimitives())
+				retired.primitives.push_back(std::move(primitive));
+		}
+		retired.textures = std::move(model->textures);
+		retiredResources.push_back(std::move(retired));
 
-			bool sRGB = false;
-			for (auto& material : asset.materials)
-			{
-				if (material.pbrData.baseColorTexture.has_value() && material.pbrData.baseColorTexture->textureIndex == textureIndex)
-				{
-					sRGB = true;
-					break;
-				}
-			}
+		model->textures.clear();
+		model->textureData.clear();
+		model->meshData.clear();
+		model->mappedFile.reset();
 
-			auto& imageData = decodedImages[imageIndex.value()];
+		model->gpuMemorySize = 0;
+		model->resident = false;
+	}
 
-			model->textureData[textureIndex] = TextureData
-			{
-				std::move(imageData.pixels),
-				imageData.width,
-				imageData.height,
-				imageData.channels,
-				sRGB
-			};
-		}
+	void ModelManager::ReleaseRetiredResources(uint64_t completedFrameNumber)
+	{
+		while (!retiredResources.empty() && retiredResources.front().frameNumber <= completedFrameNumber)
+			retiredResources.pop_front();
 	}
 
-	bool ModelManager::DecodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight, int& outChannels)
+	void ModelManager::ReloadModel(const std::string& path)
 	{
-		bool decoded = false;
+		auto model = GetModel(path);
+		if (!model || model->resident || pendingLoads.count(path) > 0)
+			return;
 
-		std::visit(fastgltf::visitor
-			{
-				[&](const fastgltf::sources::URI& filePath)
-				{
-					std::cout << "External GLTF textures not yet supported. Please use GLB models." << std::endl;
-				},
-				[&](const fastgltf::sources::Array& vector)
-				{
-					std::cout << "GLTF textures not yet supported. Please use GLB models." << std::endl;
-				},
-				[&](const fastgltf::sources::BufferView& view)
-				{
-					if (view.bufferViewIndex >= asset.bufferViews.size())
-					{
-						std::cerr << "Invalid buffer view index in image." << std::endl;
-						return;
-					}
-
-					auto& bufferView = asset.bufferViews[view.bufferViewIndex];
-					auto& buffer = asset.buffers[bufferView.bufferIndex];
-
-					stbi_set_flip_vertically_on_load(false);
-
-					std::visit(fastgltf::visitor
-						{
-							[&](const fastgltf::sources::Array& vector)
-							{
-								unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(vector.bytes.data() + bufferView.byteOffset),
-																			static_cast<int>(bufferView.byteLength), &outWidth, &outHeight, &outChannels, 4);
-								if (pixels)
-								{
-									outPixels.assign(pixels, pixels + (outWidth * outHeight * 4));
-
-									outChannels = 4;
-
-									stbi_image_free(pixels);
-
-									decoded = true;
-								}
-								else
-								{
-									std::cerr << "STB Image failed to decode image." << std::endl;
-								}
-							},
-							[](auto& arg) {}
-						}, buffer.data);
-				},
-				[](auto& arg) {}
-			}, image.data);
-
-		return decoded;
+		// Evicted models are usually back in view, so they go ahead of new loads
+		LoadModelAsync(path, nullptr, JobPriority::High);
 	}
 
 	std::shared_ptr<VulkanTexture> ModelManager::CreateFallbackTexture(glm::vec4 color)
@@ -0,0 +1,275 @@
+#include "Core/OcclusionCuller.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define NIGHTBIRD_OCCLUSION_SSE
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Core/Bounds.h"
+#include "Core/JobSystem.h"
+#include "Core/TriangleBVH.h"
+
+namespace Nightbird
+{
+	OcclusionCuller::OcclusionCuller(JobSystem* jobSystem)
+		: jobSystem(jobSystem)
+	{
+		depth.resize(Width * Height, std::numeric_limits<float>::max());
+	}
+
+	void OcclusionCuller::Begin(const glm::mat4& matrix)
+	{
+		viewProjection = matrix;
+
+		std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::max());
+
+		triangles.clear();
+		for (auto& bin : tileBins)
+			bin.clear();
+	}
+
+	void OcclusionCuller::AddOccluder(const glm::mat4& worldMatrix, const TriangleBVH& occluderTriangles)
+	{
+		glm::mat4 worldViewProjection = viewProjection * worldMatrix;
+
+		occluderTriangles.ForEachTriangle([&](const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+			{
+				ScreenTriangle triangle;
+				if (!ToScreen(worldViewProjection * glm::vec4(p0, 1.0f), triangle.v0) ||
+					!ToScreen(worldViewProjection * glm::vec4(p1, 1.0f), triangle.v1) ||
+					!ToScreen(worldViewProjection * glm::vec4(p2, 1.0f), triangle.v2))
+					return;
+
+				float minX = std::min(triangle.v0.x, std::min(triangle.v1.x, triangle.v2.x));
+				float maxX = std::max(triangle.v0.x, std::max(triangle.v1.x, triangle.v2.x));
+				float minY = std::min(triangle.v0.y, std::min(triangle.v1.y, triangle.v2.y));
+				float maxY = std::max(triangle.v0.y, std::max(triangle.v1.y, triangle.v2.y));
+
+				if (maxX < 0.0f || maxY < 0.0f || minX >= Width || minY >= Height)
+					return;
+
+				uint32_t tileMinX = static_cast<uint32_t>(std::max(minX, 0.0f)) / TileWidth;
+				uint32_t tileMaxX = std::min(static_cast<uint32_t>(maxX) / TileWidth, TilesX - 1);
+				uint32_t tileMinY = static_cast<uint32_t>(std::max(minY, 0.0f)) / TileHeight;
+				uint32_t tileMaxY = std::min(static_cast<uint32_t>(maxY) / TileHeight, TilesY - 1);
+
+				uint32_t index = static_cast<uint32_t>(triangles.size());
+				triangles.push_back(triangle);
+
+				for (uint32_t tileY = tileMinY; tileY <= tileMaxY; ++tileY)
+				{
+					for (uint32_t tileX = tileMinX; tileX <= tileMaxX; ++tileX)
+						tileBins[tileY * TilesX + tileX].push_back(index);
+				}
+			});
+	}
+
+	void OcclusionCuller::Rasterize()
+	{
+		constexpr uint32_t tileCount = TilesX * TilesY;
+
+		// Scheduling costs more than a handful of triangles
+		if (triangles.size() < 1024)
+		{
+			for (uint32_t tile = 0; tile < tileCount; ++tile)
+				RasterizeTile(tile);
+			return;
+		}
+
+		// Tiles own disjoint pixels, so workers never touch the same depth values
+		jobSystem->ParallelFor(tileCount, [this](size_t tile)
+			{
+				RasterizeTile(static_cast<uint32_t>(tile));
+			});
+	}
+
+	bool OcclusionCuller::IsVisible(const AABB& worldBounds) const
+	{
+		if (triangles.empty())
+			return true;
+
+		glm::vec3 screenMin(std::numeric_limits<float>::max());
+		glm::vec3 screenMax(std::numeric_limits<float>::lowest());
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			glm::vec3 point(
+				(corner & 1) ? worldBounds.max.x : worldBounds.min.x,
+				(corner & 2) ? worldBounds.max.y : worldBounds.min.y,
+				(corner & 4) ? worldBounds.max.z : worldBounds.min.z);
+
+			// Boxes crossing the near plane are treated as visible
+			glm::vec3 screen;
+			if (!ToScreen(viewProjection * glm::vec4(point, 1.0f), screen))
+				return true;
+
+			screenMin = glm::min(screenMin, screen);
+			screenMax = glm::max(screenMax, screen);
+		}
+
+		int minX = std::max(static_cast<int>(std::floor(screenMin.x)), 0);
+		int maxX = std::min(static_cast<int>(std::ceil(screenMax.x)), static_cast<int>(Width));
+		int minY = std::max(static_cast<int>(std::floor(screenMin.y)), 0);
+		int maxY = std::min(static_cast<int>(std::ceil(screenMax.y)), static_cast<int>(Height));
+
+		if (minX >= maxX || minY >= maxY)
+			return true;
+
+		float nearestDepth = screenMin.z;
+
+		for (int y = minY; y < maxY; ++y)
+		{
+			const float* row = depth.data() + y * Width;
+
+#ifdef NIGHTBIRD_OCCLUSION_SSE
+			__m128 boxDepth = _mm_set1_ps(nearestDepth);
+			__m128 rangeMin = _mm_set1_ps(static_cast<float>(minX));
+			__m128 rangeMax = _mm_set1_ps(static_cast<float>(maxX));
+
+			for (int x = minX & ~3; x < maxX; x += 4)
+			{
+				__m128 lanes = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+				__m128 inRange = _mm_and_ps(_mm_cmpge_ps(lanes, rangeMin), _mm_cmplt_ps(lanes, rangeMax));
+
+				// Any pixel where the occluders are not in front lets the box show through
+				__m128 open = _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepth), inRange);
+				if (_mm_movemask_ps(open))
+					return true;
+			}
+#else
+			for (int x = minX; x < maxX; ++x)
+			{
+				if (row[x] >= nearestDepth)
+					return true;
+			}
+#endif
+		}
+
+		return false;
+	}
+
+	size_t OcclusionCuller::GetOccluderTriangleCount() const
+	{
+		return triangles.size();
+	}
+
+	void OcclusionCuller::RasterizeTile(uint32_t tile)
+	{
+		uint32_t tileX = tile % TilesX;
+		uint32_t tileY = tile / TilesX;
+
+		for (uint32_t index : tileBins[tile])
+			RasterizeTriangle(triangles[index], tileX, tileY);
+	}
+
+	void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& triangle, uint32_t tileX, uint32_t tileY)
+	{
+		glm::vec3 v0 = triangle.v0;
+		glm::vec3 v1 = triangle.v1;
+		glm::vec3 v2 = triangle.v2;
+
+		// Occluders are rasterized regardless of facing
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+		if (std::abs(area) < 1e-6f)
+			return;
+		if (area < 0.0f)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+
+		int tileMinX = static_cast<int>(tileX * TileWidth);
+		int tileMinY = static_cast<int>(tileY * TileHeight);
+
+		int minX = std::max(static_cast<int>(std::floor(std::min(v0.x, std::min(v1.x, v2.x)))), tileMinX);
+		int maxX = std::min(static_cast<int>(std::ceil(std::max(v0.x, std::max(v1.x, v2.x)))), tileMinX + static_cast<int>(TileWidth));
+		int minY = std::max(static_cast<int>(std::floor(std::min(v0.y, std::min(v1.y, v2.y)))), tileMinY);
+		int maxY = std::min(static_cast<int>(std::ceil(std::max(v0.y, std::max(v1.y, v2.y)))), tileMinY + static_cast<int>(TileHeight));
+
+		if (minX >= maxX || minY >= maxY)
+			return;
+
+		// Edge functions A * x + B * y + C, each weighting the opposite vertex
+		glm::vec3 a = glm::vec3(v1.y - v2.y, v2.y - v0.y, v0.y - v1.y);
+		glm::vec3 b = glm::vec3(v2.x - v1.x, v0.x - v2.x, v1.x - v0.x);
+		glm::vec3 c = glm::vec3(
+			-(a.x * v1.x + b.x * v1.y),
+			-(a.y * v2.x + b.y * v2.y),
+			-(a.z * v0.x + b.z * v0.y));
+
+		float inverseArea = 1.0f / area;
+		glm::vec3 z = glm::vec3(v0.z, v1.z, v2.z) * inverseArea;
+
+		// Tile edges are multiples of 4, so aligning down stays inside this tile
+		int startX = minX & ~3;
+
+		for (int y = minY; y < maxY; ++y)
+		{
+			float* row = depth.data() + y * Width;
+			float pixelY = static_cast<float>(y) + 0.5f;
+
+#ifdef NIGHTBIRD_OCCLUSION_SSE
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(startX) + 0.5f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.x), pixelX), _mm_set1_ps(b.x * pixelY + c.x));
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.y), pixelX), _mm_set1_ps(b.y * pixelY + c.y));
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.z), pixelX), _mm_set1_ps(b.z * pixelY + c.z));
+
+			__m128 step0 = _mm_set1_ps(a.x * 4.0f);
+			__m128 step1 = _mm_set1_ps(a.y * 4.0f);
+			__m128 step2 = _mm_set1_ps(a.z * 4.0f);
+
+			__m128 z0 = _mm_set1_ps(z.x);
+			__m128 z1 = _mm_set1_ps(z.y);
+			__m128 z2 = _mm_set1_ps(z.z);
+			__m128 zero = _mm_setzero_ps();
+
+			for (int x = startX; x < maxX; x += 4)
+			{
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+
+				if (_mm_movemask_ps(inside))
+				{
+					__m128 pixelDepth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e0, z0), _mm_mul_ps(e1, z1)), _mm_mul_ps(e2, z2));
+					__m128 current = _mm_loadu_ps(row + x);
+					__m128 nearest = _mm_min_ps(current, pixelDepth);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+				}
+
+				e0 = _mm_add_ps(e0, step0);
+				e1 = _mm_add_ps(e1, step1);
+				e2 = _mm_add_ps(e2, step2);
+			}
+#else
+			for (int x = minX; x < maxX; ++x)
+			{
+				float pixelX = static_cast<float>(x) + 0.5f;
+				float e0 = a.x * pixelX + b.x * pixelY + c.x;
+				float e1 = a.y * pixelX + b.y * pixelY + c.y;
+				float e2 = a.z * pixelX + b.z * pixelY + c.z;
+
+				if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f)
+					continue;
+
+				row[x] = std::min(row[x], e0 * z.x + e1 * z.y + e2 * z.z);
+			}
+#endif
+		}
+	}
+
+	bool OcclusionCuller::ToScreen(const glm::vec4& clip, glm::vec3& screen) const
+	{
+		if (clip.w <= 1e-5f)
+			return false;
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		screen.x = (ndc.x * 0.5f + 0.5f) * Width;
+		screen.y = (ndc.y * 0.5f + 0.5f) * Height;
+		screen.z = ndc.z;
+		return true;
+	}
+}
\ No newline at end of file
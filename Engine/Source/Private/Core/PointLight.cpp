@@ -17,18 +17,29 @@ namespace Nightbird
 	PointLightData PointLight::GetData() const
 	{
 		PointLightData data;
-		data.positionRadius = glm::vec4(transform.position, radius);
+		data.positionRadius = glm::vec4(glm::vec3(GetWorldMatrix()[3]), radius);
 		data.colorIntensity = glm::vec4(color, intensity);
 
 		return data;
 	}
+
+	float PointLight::GetRadius() const
+	{
+		return radius;
+	}
+
+	void PointLight::SetRadius(float value)
+	{
+		radius = value;
+		MarkTransformDirty();
+	}
 }
 
 RTTR_REGISTRATION
 {
 	rttr::registration::class_<Nightbird::PointLight>("PointLight")
 	.constructor<std::string>()
-	.property("Radius", &Nightbird::PointLight::radius)
+	.property("Radius", &Nightbird::PointLight::GetRadius, &Nightbird::PointLight::SetRadius)
 	.property("Intensity", &Nightbird::PointLight::intensity)
 	.property("Color", &Nightbird::PointLight::color);
 
@@ -1,5 +1,7 @@
 #include "Core/PrefabInstance.h"
 
+#include "Core/MeshInstance.h"
+
 namespace Nightbird
 {
 	PrefabInstance::PrefabInstance(const char* name, const char* prefabPath)
@@ -24,6 +26,29 @@ namespace Nightbird
 		return prefabPath;
 	}
 
+	bool PrefabInstance::IsOccluder() const
+	{
+		return occluder;
+	}
+
+	void PrefabInstance::SetOccluder(bool value)
+	{
+		occluder = value;
+
+		std::vector<SceneObject*> stack = { this };
+		while (!stack.empty())
+		{
+			SceneObject* object = stack.back();
+			stack.pop_back();
+
+			if (auto* meshInstance = dynamic_cast<MeshInstance*>(object))
+				meshInstance->SetOccluder(value);
+
+			for (const auto& child : object->GetChildren())
+				stack.push_back(child.get());
+		}
+	}
+
 	void PrefabInstance::Serialize(json& out) const
 	{
 		SerializeBase(out);
@@ -39,7 +64,8 @@ RTTR_REGISTRATION
 {
 	rttr::registration::class_<Nightbird::PrefabInstance>("PrefabInstance")
 	.constructor<std::string>()
-	.property("PrefabPath", &Nightbird::PrefabInstance::prefabPath);
+	.property("PrefabPath", &Nightbird::PrefabInstance::prefabPath)
+	.property("Occluder", &Nightbird::PrefabInstance::IsOccluder, &Nightbird::PrefabInstance::SetOccluder);
 
 	rttr::registration::method("CreatePrefabInstance", [](const std::string& name) -> Nightbird::SceneObject*
 	{
@@ -21,6 +21,8 @@ namespace rttr
 				return variant.get_value<bool>();
 			if (type == rttr::type::get<int>())
 				return variant.get_value<int>();
+			if (type == rttr::type::get<uint32_t>())
+				return variant.get_value<uint32_t>();
 			if (type == rttr::type::get<float>())
 				return variant.get_value<float>();
 			if (type == rttr::type::get<double>())
@@ -79,6 +81,8 @@ namespace rttr
 					variant = propJson.get<bool>();
 				if (propType == rttr::type::get<int>())
 					variant = propJson.get<int>();
+				if (propType == rttr::type::get<uint32_t>())
+					variant = propJson.get<uint32_t>();
 				if (propType == rttr::type::get<float>())
 					variant = propJson.get<float>();
 				if (propType == rttr::type::get<double>())
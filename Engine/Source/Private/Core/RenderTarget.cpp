@@ -11,4 +11,64 @@ namespace Nightbird
 	{
 
 	}
+
+	void RenderTarget::SetRenderSettings(const RenderSettings& settings)
+	{
+		renderSettings = settings;
+	}
+
+	const RenderSettings& RenderTarget::GetRenderSettings() const
+	{
+		return renderSettings;
+	}
+
+	void RenderTarget::SetDepthPrepassEnabled(bool enabled)
+	{
+		renderSettings.depthPrepass = enabled;
+	}
+
+	bool RenderTarget::IsDepthPrepassEnabled() const
+	{
+		return renderSettings.depthPrepass;
+	}
+
+	void RenderTarget::SetOcclusionCullingEnabled(bool enabled)
+	{
+		renderSettings.occlusionCulling = enabled;
+	}
+
+	bool RenderTarget::IsOcclusionCullingEnabled() const
+	{
+		return renderSettings.occlusionCulling;
+	}
+
+	void RenderTarget::SetGpuOcclusionCullingEnabled(bool enabled)
+	{
+		renderSettings.gpuOcclusionCulling = enabled;
+	}
+
+	bool RenderTarget::IsGpuOcclusionCullingEnabled() const
+	{
+		return renderSettings.gpuOcclusionCulling;
+	}
+
+	void RenderTarget::SetLodErrorThreshold(float pixels)
+	{
+		renderSettings.lodErrorThreshold = pixels;
+	}
+
+	float RenderTarget::GetLodErrorThreshold() const
+	{
+		return renderSettings.lodErrorThreshold;
+	}
+
+	void RenderTarget::SetTransparencyMode(TransparencyMode mode)
+	{
+		renderSettings.transparencyMode = mode;
+	}
+
+	TransparencyMode RenderTarget::GetTransparencyMode() const
+	{
+		return renderSettings.transparencyMode;
+	}
 }
\ No newline at end of file
@@ -11,6 +11,8 @@
 #include "Vulkan/GlobalDescriptorSetManager.h"
 #include "Vulkan/Pipeline.h"
 #include "Vulkan/DescriptorPool.h"
+#include "Vulkan/OitTargets.h"
+#include "Vulkan/HiZCuller.h"
 #include "Vulkan/Sync.h"
 #include "Core/GlfwWindow.h"
 #include "Core/Scene.h"
@@ -22,23 +24,28 @@
 #include "Core/Camera.h"
 #include "Core/CameraUBO.h"
 #include "Core/RenderTarget.h"
+#include "Core/ShaderVariant.h"
+#include "Core/Bounds.h"
+#include "Core/SpatialCategory.h"
+#include "Core/TriangleBVH.h"
 
 namespace Nightbird
 {
-	Renderer::Renderer(GlfwWindow* glfwWindow)
-		: glfwWindow(glfwWindow)
+	Renderer::Renderer(GlfwWindow* glfwWindow, JobSystem* jobSystem)
+		: glfwWindow(glfwWindow), jobSystem(jobSystem)
 	{
 		instance = std::make_unique<VulkanInstance>(glfwWindow->Get());
 		device = std::make_unique<VulkanDevice>(instance->Get(), instance->GetSurface());
 
 		swapChain = std::make_unique<VulkanSwapChain>(device.get(), instance->GetSurface(), glfwWindow->Get());
 		renderPass = std::make_unique<VulkanRenderPass>(device.get(), swapChain->GetColorFormat(), FindDepthFormat(device->GetPhysical()), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-		swapChain->CreateFramebuffers(renderPass->Get());
 
 		descriptorSetLayoutManager = std::make_unique<VulkanDescriptorSetLayoutManager>(device.get());
 
 		descriptorPool = std::make_unique<VulkanDescriptorPool>(device.get(), 1024);
 
+		CreateSwapChainFramebuffers();
+
 		globalDescriptorSetManager = std::make_unique<GlobalDescriptorSetManager>(device.get(), descriptorSetLayoutManager->GetGlobalDescriptorSetLayout(), descriptorPool->Get());
 
 		opaquePipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::Opaque, false);
@@ -46,10 +53,26 @@ namespace Nightbird
 		opaqueDoubleSidedPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::Opaque, true);
 		transparentDoubleSidedPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::Transparent, true);
 
+		depthPrepassPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::DepthPrepass, false);
+		depthPrepassDoubleSidedPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::DepthPrepass, true);
+		opaqueDepthEqualPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::OpaqueDepthEqual, false);
+		opaqueDepthEqualDoubleSidedPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::OpaqueDepthEqual, true);
+
+		transparentAccumulatePipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::TransparentAccumulate, false);
+		transparentAccumulateDoubleSidedPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::TransparentAccumulate, true);
+		transparentCompositePipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), globalDescriptorSetManager.get(), PipelineType::TransparentComposite, false);
+
 		opaquePipeline->SetDescriptorPool(descriptorPool->Get());
 		transparentPipeline->SetDescriptorPool(descriptorPool->Get());
 		opaqueDoubleSidedPipeline->SetDescriptorPool(descriptorPool->Get());
 		transparentDoubleSidedPipeline->SetDescriptorPool(descriptorPool->Get());
+		depthPrepassPipeline->SetDescriptorPool(descriptorPool->Get());
+		depthPrepassDoubleSidedPipeline->SetDescriptorPool(descriptorPool->Get());
+		opaqueDepthEqualPipeline->SetDescriptorPool(descriptorPool->Get());
+		opaqueDepthEqualDoubleSidedPipeline->SetDescriptorPool(descriptorPool->Get());
+		transparentAccumulatePipeline->SetDescriptorPool(descriptorPool->Get());
+		transparentAccumulateDoubleSidedPipeline->SetDescriptorPool(descriptorPool->Get());
+		transparentCompositePipeline->SetDescriptorPool(descriptorPool->Get());
 
 		sync = std::make_unique<VulkanSync>(device->GetLogical());
 	}
@@ -94,6 +117,11 @@ namespace Nightbird
 		return descriptorPool.get();
 	}
 
+	VulkanOitTargets* Renderer::GetOitTargets() const
+	{
+		return oitTargets.get();
+	}
+
 	void Renderer::SetRenderTarget(RenderTarget* target)
 	{
 		renderTarget = target;
@@ -102,10 +130,14 @@ namespace Nightbird
 	void Renderer::DrawFrame(Scene* scene)
 	{
 		vkWaitForFences(device->GetLogical(), 1, &sync->inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+		completedFrameNumber = std::max(completedFrameNumber, submittedFrameNumbers[currentFrame]);
 
 		VkCommandBuffer commandBuffer = device->commandBuffers[currentFrame];
 		vkResetCommandBuffer(commandBuffer, 0);
 
+		frameNumber++;
+		device->SetFrameIndex(static_cast<uint32_t>(frameNumber));
+
 		uint32_t imageIndex;
 		VkResult result = vkAcquireNextImageKHR(device->GetLogical(), swapChain->Get(), UINT64_MAX, sync->imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
@@ -148,6 +180,7 @@ namespace Nightbird
 			std::cerr << "Failed to submit draw command buffer" << std::endl;
 			return;
 		}
+		submittedFrameNumbers[currentFrame] = frameNumber;
 
 		VkPresentInfoKHR presentInfo{};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -174,21 +207,221 @@ namespace Nightbird
 		currentFrame = (currentFrame + 1) % VulkanConfig::MAX_FRAMES_IN_FLIGHT;
 	}
 
-	void Renderer::DrawScene(Scene* scene, Camera* camera, VkCommandBuffer commandBuffer, VkExtent2D extent)
+	void Renderer::DrawScene(Scene* scene, Camera* camera, VkCommandBuffer commandBuffer, VulkanRenderPass* renderPass, VkFramebuffer framebuffer, VulkanOitTargets* oitTargets, VulkanImage* depthImage, VkExtent2D extent, const RenderSettings& settings)
 	{
-		scene->UpdateBuffers(currentFrame, extent);
-		globalDescriptorSetManager->UpdateCamera(currentFrame, camera->GetUBO(extent));
+		scene->UpdateBuffers(currentFrame, extent, camera);
+
+		CameraUBO cameraUBO = camera->GetUBO(extent);
+		globalDescriptorSetManager->UpdateCamera(currentFrame, cameraUBO);
 		
+		Frustum frustum = Frustum::FromMatrix(cameraUBO.projection * cameraUBO.view);
+
+		// The spatial index rejects whole instances, primitive spheres are then tested in one batch
+		visibleObjects.clear();
+		scene->QueryFrustum(frustum, SpatialCategory::MeshInstance, visibleObjects);
+
+		std::vector<Renderable> candidateRenderables;
+		frustumCuller.Clear();
+
+		glm::vec3 cameraWorldPos = glm::vec3(camera->GetWorldMatrix()[3]);
+
+		// Pixels covered by one world unit at distance one
+		float lodScale = std::abs(cameraUBO.projection[1][1]) * 0.5f * static_cast<float>(extent.height);
+
+		for (SpatialObject* object : visibleObjects)
+		{
+			auto* instance = static_cast<MeshInstance*>(object);
+			SelectLod(instance, cameraWorldPos, lodScale, settings.lodErrorThreshold);
+			CollectRenderables(instance, candidateRenderables);
+		}
+
+		size_t visibleCount = frustumCuller.Cull(frustum, cullVisibility);
+
+		renderStats.totalDraws = static_cast<uint32_t>(candidateRenderables.size());
+		renderStats.occludedDraws = 0;
+
+		if (settings.occlusionCulling)
+		{
+			if (!occlusionCuller)
+				occlusionCuller = std::make_unique<OcclusionCuller>(jobSystem);
+
+			occlusionCuller->Begin(cameraUBO.projection * cameraUBO.view);
+
+			for (SpatialObject* object : visibleObjects)
+			{
+				auto* instance = static_cast<MeshInstance*>(object);
+				const TriangleBVH* collision = instance->GetMesh()->GetCollision();
+				if (instance->IsOccluder() && collision)
+					occlusionCuller->AddOccluder(instance->GetWorldMatrix(), *collision);
+			}
+
+			occlusionCuller->Rasterize();
+
+			for (size_t i = 0; i < candidateRenderables.size(); ++i)
+			{
+				const Renderable& renderable = candidateRenderables[i];
+
+				// Occluders always draw, testing them against their own depth would be wasted work
+				if (!cullVisibility[i] || renderable.instance->IsOccluder())
+					continue;
+
+				AABB bounds = renderable.primitive->GetBounds().Transform(renderable.instance->GetWorldMatrix());
+				if (!occlusionCuller->IsVisible(bounds))
+				{
+					cullVisibility[i] = 0;
+					++renderStats.occludedDraws;
+				}
+			}
+		}
+
+		renderStats.visibleDraws = static_cast<uint32_t>(visibleCount) - renderStats.occludedDraws;
+		renderStats.gpuOccludedDraws = 0;
+
+		bool hiZActive = false;
+		if (settings.gpuOcclusionCulling && depthImage)
+		{
+			if (!hiZCuller)
+				hiZCuller = std::make_unique<VulkanHiZCuller>(device.get());
+
+			if (hiZCuller->IsSupported())
+			{
+				renderStats.gpuOccludedDraws = hiZCuller->Begin(currentFrame, frameNumber, cameraUBO.projection * cameraUBO.view, extent, candidateRenderables.size());
+
+				// Everything in view is tested again after the first pass, including draws the last test skipped
+				for (size_t i = 0; i < candidateRenderables.size(); ++i)
+				{
+					if (!cullVisibility[i])
+						continue;
+
+					Renderable& renderable = candidateRenderables[i];
+					AABB bounds = renderable.primitive->GetBounds();
+					if (bounds.IsValid())
+						hiZCuller->AddDraw(renderable, bounds.Transform(renderable.instance->GetWorldMatrix()));
+				}
+
+				hiZActive = true;
+			}
+		}
+
 		std::vector<Renderable> opaqueRenderables;
 		std::vector<Renderable> opaqueDoubleSidedRenderables;
 		std::vector<Renderable> transparentRenderables;
 
-		for (const auto& object : scene->GetRootObject()->GetChildren())
+		renderStats.drawnTriangles = 0;
+		renderStats.lodTrianglesSaved = 0;
+
+		for (size_t i = 0; i < candidateRenderables.size(); ++i)
 		{
-			CollectRenderables(object.get(), opaqueRenderables, opaqueDoubleSidedRenderables, transparentRenderables);
+			if (!cullVisibility[i])
+				continue;
+
+			const Renderable& renderable = candidateRenderables[i];
+
+			uint32_t fullTriangles = renderable.primitive->GetLod(0).indexCount / 3;
+			uint32_t lodTriangles = renderable.primitive->GetLod(renderable.lod).indexCount / 3;
+			renderStats.drawnTriangles += lodTriangles;
+			renderStats.lodTrianglesSaved += fullTriangles - lodTriangles;
+
+			if (renderable.primitive->GetTransparencyEnabled())
+				transparentRenderables.push_back(renderable);
+			else if (renderable.primitive->GetDoubleSided())
+				opaqueDoubleSidedRenderables.push_back(renderable);
+			else
+				opaqueRenderables.push_back(renderable);
 		}
 
-		glm::vec3 cameraWorldPos = glm::vec3(camera->GetWorldMatrix()[3]);
+		uint32_t sceneVariantKey = 0;
+		if (scene->HasDirectionalLights())
+			sceneVariantKey |= ShaderVariant::DirectionalLights;
+		if (scene->HasPointLights())
+			sceneVariantKey |= ShaderVariant::PointLights;
+
+		// Group opaque draws by material variant so each pipeline is bound once
+		auto byVariant = [](const Renderable& a, const Renderable& b)
+			{
+				return a.primitive->GetShaderVariantKey() < b.primitive->GetShaderVariantKey();
+			};
+		std::stable_sort(opaqueRenderables.begin(), opaqueRenderables.end(), byVariant);
+		std::stable_sort(opaqueDoubleSidedRenderables.begin(), opaqueDoubleSidedRenderables.end(), byVariant);
+
+		auto drawOpaque = [&](const std::vector<Renderable>& singleSided, const std::vector<Renderable>& doubleSided)
+			{
+				if (settings.depthPrepass)
+				{
+					// Depth only first, then shade each visible pixel once against the resolved depth
+					depthPrepassPipeline->Render(commandBuffer, currentFrame, singleSided, camera, sceneVariantKey);
+					depthPrepassDoubleSidedPipeline->Render(commandBuffer, currentFrame, doubleSided, camera, sceneVariantKey);
+
+					opaqueDepthEqualPipeline->Render(commandBuffer, currentFrame, singleSided, camera, sceneVariantKey);
+					opaqueDepthEqualDoubleSidedPipeline->Render(commandBuffer, currentFrame, doubleSided, camera, sceneVariantKey);
+				}
+				else
+				{
+					opaquePipeline->Render(commandBuffer, currentFrame, singleSided, camera, sceneVariantKey);
+					opaqueDoubleSidedPipeline->Render(commandBuffer, currentFrame, doubleSided, camera, sceneVariantKey);
+				}
+			};
+
+		drawOpaque(opaqueRenderables, opaqueDoubleSidedRenderables);
+
+		if (hiZActive)
+		{
+			// The pyramid is built from the depth just drawn, draws the last frame rejected and now visible follow in the same frame
+			renderPass->End(commandBuffer);
+			bool tested = hiZCuller->Dispatch(commandBuffer, depthImage);
+			renderPass->Resume(commandBuffer, framebuffer, extent);
+
+			// Without a test the late commands are stale, draws that went through the old results are drawn directly
+			VkBuffer lateCommandBuffer = tested ? hiZCuller->GetLateCommandBuffer() : VK_NULL_HANDLE;
+			auto collectLate = [lateCommandBuffer](const std::vector<Renderable>& renderables)
+				{
+					std::vector<Renderable> lateRenderables;
+					for (const auto& renderable : renderables)
+					{
+						if (renderable.indirectBuffer == VK_NULL_HANDLE)
+							continue;
+
+						lateRenderables.push_back(renderable);
+						lateRenderables.back().indirectBuffer = lateCommandBuffer;
+					}
+
+					return lateRenderables;
+				};
+
+			drawOpaque(collectLate(opaqueRenderables), collectLate(opaqueDoubleSidedRenderables));
+
+			// Transparent draws come after the test and read its fresh results
+			if (!tested)
+			{
+				for (auto& renderable : transparentRenderables)
+					renderable.indirectBuffer = VK_NULL_HANDLE;
+			}
+		}
+
+		if (settings.transparencyMode == TransparencyMode::WeightedBlended && oitTargets)
+		{
+			// Order independent, so transparent draws batch like opaque ones without a sort
+			std::vector<Renderable> transparentSingleSidedRenderables;
+			std::vector<Renderable> transparentDoubleSidedRenderables;
+
+			for (const auto& renderable : transparentRenderables)
+			{
+				if (renderable.primitive->GetDoubleSided())
+					transparentDoubleSidedRenderables.push_back(renderable);
+				else
+					transparentSingleSidedRenderables.push_back(renderable);
+			}
+
+			renderPass->NextSubpass(commandBuffer);
+			transparentAccumulatePipeline->Render(commandBuffer, currentFrame, transparentSingleSidedRenderables, camera, sceneVariantKey);
+			transparentAccumulateDoubleSidedPipeline->Render(commandBuffer, currentFrame, transparentDoubleSidedRenderables, camera, sceneVariantKey);
+
+			renderPass->NextSubpass(commandBuffer);
+			if (!transparentRenderables.empty())
+				transparentCompositePipeline->RenderFullscreen(commandBuffer, oitTargets->GetCompositeDescriptorSet());
+
+			return;
+		}
 
 		std::sort(transparentRenderables.begin(), transparentRenderables.end(),
 			[&](const Renderable& a, const Renderable& b)
@@ -200,17 +433,14 @@ namespace Nightbird
 				float distB = glm::length(cameraWorldPos - posB);
 				return distA > distB;
 			});
-		
-		opaquePipeline->Render(commandBuffer, currentFrame, opaqueRenderables, camera);
-		opaqueDoubleSidedPipeline->Render(commandBuffer, currentFrame, opaqueDoubleSidedRenderables, camera);
 
 		for (const auto& renderable : transparentRenderables)
 		{
 			bool doubleSided = renderable.primitive->GetDoubleSided();
 			if (doubleSided)
-				transparentDoubleSidedPipeline->RenderSingle(commandBuffer, currentFrame, renderable, camera);
+				transparentDoubleSidedPipeline->RenderSingle(commandBuffer, currentFrame, renderable, camera, sceneVariantKey);
 			else
-				transparentPipeline->RenderSingle(commandBuffer, currentFrame, renderable, camera);
+				transparentPipeline->RenderSingle(commandBuffer, currentFrame, renderable, camera, sceneVariantKey);
 		}
 	}
 
@@ -219,6 +449,21 @@ namespace Nightbird
 		framebufferResized = true;
 	}
 
+	uint64_t Renderer::GetFrameNumber() const
+	{
+		return frameNumber;
+	}
+
+	uint64_t Renderer::GetCompletedFrameNumber() const
+	{
+		return completedFrameNumber;
+	}
+
+	const RenderStats& Renderer::GetRenderStats() const
+	{
+		return renderStats;
+	}
+
 	void Renderer::RecreateSwapChain()
 	{
 		int width = 0, height = 0;
@@ -237,38 +482,72 @@ namespace Nightbird
 
 		swapChain->CreateSwapChain();
 		swapChain->CreateDepthResources();
-		swapChain->CreateFramebuffers(renderPass->Get());
+		CreateSwapChainFramebuffers();
 		sync->CreateSyncObjects();
 	}
 
-	void Renderer::CollectRenderables(SceneObject* object, std::vector<Renderable>& opaque, std::vector<Renderable>& opaqueDoubleSided, std::vector<Renderable>& transparent)
+	void Renderer::CreateSwapChainFramebuffers()
 	{
-		if (!object)
-			return;
+		// Release the old composite descriptor set before allocating the new one
+		oitTargets.reset();
+		oitTargets = std::make_unique<VulkanOitTargets>(device.get(), swapChain->extent.width, swapChain->extent.height, descriptorSetLayoutManager->GetOitCompositeDescriptorSetLayout(), descriptorPool->Get());
+
+		swapChain->CreateFramebuffers(renderPass->Get(), {oitTargets->GetAccumImageView(), oitTargets->GetRevealageImageView()});
+	}
+
+	void Renderer::CollectRenderables(MeshInstance* instance, std::vector<Renderable>& renderables)
+	{
+		auto mesh = instance->GetMesh();
 
-		if (auto* instance = dynamic_cast<MeshInstance*>(object))
+		// Stamped even when evicted (no primitives) so the residency manager brings it back
+		mesh->MarkUsed(frameNumber);
+
+		glm::mat4 worldMatrix = instance->GetWorldMatrix();
+
+		for (size_t i = 0; i < mesh->GetPrimitiveCount(); ++i)
 		{
-			auto mesh = instance->GetMesh();
+			MeshPrimitive* primitive = mesh->GetPrimitive(i);
 
-			for (size_t i = 0; i < mesh->GetPrimitiveCount(); ++i)
-			{
-				MeshPrimitive* primitive = mesh->GetPrimitive(i);
+			BoundingSphere sphere = primitive->GetBoundingSphere().Transform(worldMatrix);
+			frustumCuller.AddSphere(sphere.center, sphere.radius);
 
-				Renderable renderable{ instance, primitive };
+			renderables.push_back(Renderable{ instance, primitive, instance->GetLodLevel() });
+		}
+	}
 
-				bool transparencyEnabled = primitive->GetTransparencyEnabled();
-				bool doubleSided = primitive->GetDoubleSided();
-				
-				if (transparencyEnabled)
-					transparent.push_back(renderable);
-				else if (doubleSided)
-					opaqueDoubleSided.push_back(renderable);
-				else
-					opaque.push_back(renderable);
-			}
+	void Renderer::SelectLod(MeshInstance* instance, const glm::vec3& cameraPosition, float lodScale, float errorThreshold)
+	{
+		// Fraction of the threshold a coarser level has to stay under, keeps instances near a switch distance from flickering
+		constexpr float LOD_HYSTERESIS = 0.25f;
+
+		auto mesh = instance->GetMesh();
+		uint32_t lodCount = static_cast<uint32_t>(mesh->GetLodCount());
+
+		glm::mat4 worldMatrix = instance->GetWorldMatrix();
+		BoundingSphere sphere = mesh->GetBoundingSphere().Transform(worldMatrix);
+		float distance = glm::length(sphere.center - cameraPosition) - sphere.radius;
+
+		if (lodCount <= 1 || errorThreshold <= 0.0f || distance <= 0.0f)
+		{
+			instance->SetLodLevel(0);
+			return;
 		}
 
-		for (const auto& child : object->GetChildren())
-			CollectRenderables(child.get(), opaque, opaqueDoubleSided, transparent);
+		float maxScale = std::max(glm::length(glm::vec3(worldMatrix[0])), std::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
+		float pixelsPerUnit = lodScale * maxScale / distance;
+
+		auto screenError = [&](uint32_t level)
+			{
+				return mesh->GetLodError(level) * pixelsPerUnit;
+			};
+
+		// Finer as soon as the current level is over the threshold, coarser only with a margin
+		uint32_t level = std::min(instance->GetLodLevel(), lodCount - 1);
+		while (level > 0 && screenError(level) > errorThreshold)
+			--level;
+		while (level + 1 < lodCount && screenError(level + 1) <= errorThreshold * (1.0f - LOD_HYSTERESIS))
+			++level;
+
+		instance->SetLodLevel(level);
 	}
 }
\ No newline at end of file
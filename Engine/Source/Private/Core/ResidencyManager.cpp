@@ -0,0 +1,129 @@
+#include "Core/ResidencyManager.h"
+
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Vulkan/Device.h"
+#include "Core/ModelManager.h"
+#include "Core/Model.h"
+#include "Core/Mesh.h"
+
+namespace Nightbird
+{
+	ResidencyManager::ResidencyManager(VulkanDevice* device, ModelManager* modelManager)
+		: device(device), modelManager(modelManager)
+	{
+		if (!device->IsMemoryBudgetSupported())
+			std::cout << "VK_EXT_memory_budget not supported, residency will use VMA's budget estimate" << std::endl;
+	}
+
+	ResidencyManager::~ResidencyManager()
+	{
+
+	}
+
+	void ResidencyManager::Update(uint64_t frameNumber)
+	{
+		stats = ResidencyStats{};
+
+		std::vector<VmaBudget> budgets = device->GetHeapBudgets();
+		for (uint32_t heapIndex = 0; heapIndex < budgets.size(); ++heapIndex)
+		{
+			if (!device->IsHeapDeviceLocal(heapIndex))
+				continue;
+
+			stats.deviceLocalUsage += budgets[heapIndex].usage;
+			stats.deviceLocalBudget += budgets[heapIndex].budget;
+		}
+
+		struct EvictionCandidate
+		{
+			std::string path;
+			uint64_t lastUsedFrame;
+			VkDeviceSize memorySize;
+		};
+
+		std::vector<EvictionCandidate> candidates;
+
+		// Held for the whole loop, ReloadModel publishes a new map while it runs
+		auto snapshot = modelManager->GetModels();
+		for (const auto& [path, model] : *snapshot)
+		{
+			if (!model)
+				continue;
+
+			uint64_t lastUsedFrame = 0;
+			for (const auto& mesh : model->meshes)
+				lastUsedFrame = std::max(lastUsedFrame, mesh->GetLastUsedFrame());
+
+			if (!model->resident)
+			{
+				stats.evictedModels++;
+
+				// An evicted mesh was reached by the last frame, bring the model back
+				if (lastUsedFrame != 0 && lastUsedFrame + 1 >= frameNumber)
+					modelManager->ReloadModel(path);
+				continue;
+			}
+
+			stats.residentModels++;
+			stats.residentAssetMemory += model->gpuMemorySize;
+
+			if (lastUsedFrame + minIdleFrames <= frameNumber)
+				candidates.push_back({path, lastUsedFrame, model->gpuMemorySize});
+		}
+
+		VkDeviceSize overBudget = 0;
+		if (budgetOverride > 0)
+		{
+			if (stats.residentAssetMemory > budgetOverride)
+				overBudget = stats.residentAssetMemory - budgetOverride;
+		}
+		else
+		{
+			VkDeviceSize target = static_cast<VkDeviceSize>(stats.deviceLocalBudget * budgetFraction);
+			if (stats.deviceLocalUsage > target)
+				overBudget = stats.deviceLocalUsage - target;
+		}
+
+		if (overBudget == 0 || candidates.empty())
+			return;
+
+		std::sort(candidates.begin(), candidates.end(),
+			[](const EvictionCandidate& a, const EvictionCandidate& b)
+			{
+				return a.lastUsedFrame < b.lastUsedFrame;
+			});
+
+		VkDeviceSize freed = 0;
+		for (const auto& candidate : candidates)
+		{
+			if (freed >= overBudget)
+				break;
+
+			modelManager->EvictModel(candidate.path, frameNumber);
+			freed += candidate.memorySize;
+
+			stats.residentModels--;
+			stats.evictedModels++;
+			stats.residentAssetMemory -= candidate.memorySize;
+		}
+	}
+
+	void ResidencyManager::SetBudgetOverride(VkDeviceSize bytes)
+	{
+		budgetOverride = bytes;
+	}
+
+	void ResidencyManager::SetBudgetFraction(float fraction)
+	{
+		budgetFraction = std::clamp(fraction, 0.1f, 1.0f);
+	}
+
+	const ResidencyStats& ResidencyManager::GetStats() const
+	{
+		return stats;
+	}
+}
\ No newline at end of file
@@ -1,11 +1,14 @@
 #include "Core/Scene.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 #include "Vulkan/Device.h"
 #include "Vulkan/StorageBuffer.h"
 #include "Vulkan/GlobalDescriptorSetManager.h"
 #include "Core/SceneObject.h"
+#include "Core/SceneBinary.h"
 #include "Core/PrefabInstance.h"
 #include "Core/MeshInstance.h"
 #include "Core/ModelManager.h"
@@ -16,6 +19,11 @@
 #include "Core/DirectionalLightData.h"
 #include "Core/PointLight.h"
 #include "Core/PointLightData.h"
+#include "Core/LightClusterGrid.h"
+#include "Core/Bounds.h"
+#include "Core/DynamicAABBTree.h"
+#include "Core/TriangleBVH.h"
+#include "Core/MeshUBO.h"
 #include "Core/Transform.h"
 #include "Core/Model.h"
 
@@ -30,6 +38,10 @@ namespace Nightbird
 		: device(device), modelManager(modelManager), globalDescriptorSetManager(globalDescriptorSetManager), descriptorPool(descriptorPool)
 	{
 		rootObject = std::make_unique<SceneObject>("Root");
+		lightClusterGrid = std::make_unique<LightClusterGrid>();
+		spatialIndex = std::make_unique<DynamicAABBTree>();
+
+		RegisterObject(rootObject.get());
 	}
 
 	Scene::~Scene()
@@ -132,20 +144,18 @@ namespace Nightbird
 
 	bool Scene::LoadSceneBIN(const std::string& path)
 	{
-		std::ifstream is(path, std::ios::binary);
-		if (!is.is_open())
-		{
-			std::cerr << "Failed to open scene for reading at " << path << std::endl;
+		if (!LoadSceneBinary(path, *rootObject))
 			return false;
-		}
 
 		std::vector<SceneObject*> allObjects = GetAllObjects();
 		for (SceneObject* object : allObjects)
 		{
 			if (auto* prefab = dynamic_cast<PrefabInstance*>(object))
 			{
-				modelManager->LoadModel(prefab->GetPrefabPath());
-				InstantiateModel(prefab);
+				modelManager->LoadModelAsync(prefab->GetPrefabPath(), [this, prefab](std::shared_ptr<Model> model)
+					{
+						InstantiateModel(prefab);
+					});
 			}
 		}
 
@@ -154,14 +164,7 @@ namespace Nightbird
 
 	bool Scene::SaveSceneBIN(const std::string& path) const
 	{
-		std::ofstream os(path, std::ios::binary);
-		if (!os.is_open())
-		{
-			std::cerr << "Failed to open scene for writing at " << path << std::endl;
-			return false;
-		}
-		
-		return true;
+		return SaveSceneBinary(*rootObject, path);
 	}
 	
 	void Scene::AddSceneObject(std::unique_ptr<SceneObject> object, SceneObject* parent)
@@ -217,9 +220,7 @@ namespace Nightbird
 		std::unique_ptr<SceneObject> object(new SpatialObject(instanceName));
 		SpatialObject* objectPtr = static_cast<SpatialObject*>(object.get());
 
-		objectPtr->transform.position = position;
-		objectPtr->transform.rotation = rotation;
-		objectPtr->transform.scale = scale;
+		objectPtr->SetTransform(Transform(position, rotation, scale));
 		objectPtr->SetParent(parent);
 
 		AddSceneObject(std::move(object), parent);
@@ -244,9 +245,7 @@ namespace Nightbird
 		std::unique_ptr<SceneObject> object(new PrefabInstance(instanceName, path));
 		PrefabInstance* prefab = static_cast<PrefabInstance*>(object.get());
 
-		prefab->transform.position = position;
-		prefab->transform.rotation = rotation;
-		prefab->transform.scale = scale;
+		prefab->SetTransform(Transform(position, rotation, scale));
 		prefab->SetParent(parent);
 		
 		AddSceneObject(std::move(object), parent);
@@ -271,9 +270,7 @@ namespace Nightbird
 		std::unique_ptr<SceneObject> object(new MeshInstance(instanceName, mesh, device, descriptorPool));
 		MeshInstance* meshInstance = static_cast<MeshInstance*>(object.get());
 
-		meshInstance->transform.position = position;
-		meshInstance->transform.rotation = rotation;
-		meshInstance->transform.scale = scale;
+		meshInstance->SetTransform(Transform(position, rotation, scale));
 		meshInstance->SetParent(parent);
 		
 		AddSceneObject(std::move(object), parent);
@@ -340,6 +337,9 @@ namespace Nightbird
 		{
 			InstantiateModelNode(model, model->gltfAsset.nodes[rootNodeIndex], prefab);
 		}
+
+		// Hands the saved flag to the freshly built mesh instances
+		prefab->SetOccluder(prefab->IsOccluder());
 	}
 
 	PrefabInstance* Scene::InstantiateModel(const std::string& path, const Transform& transform)
@@ -405,38 +405,496 @@ namespace Nightbird
 		{
 			object->Tick(delta);
 		}
+
+		FlushSpatialUpdates();
 	}
 
-	void Scene::UpdateBuffers(int currentFrame, VkExtent2D swapChainExtent)
+	void Scene::UpdateBuffers(int currentFrame, VkExtent2D swapChainExtent, const Camera* camera)
 	{
+		FlushSpatialUpdates();
+
+		CameraUBO cameraUBO = camera->GetUBO(swapChainExtent);
+		Frustum frustum = Frustum::FromMatrix(cameraUBO.projection * cameraUBO.view);
+
 		std::vector<DirectionalLightData> directionalLightData;
+		directionalLightData.reserve(directionalLights.size());
+		for (DirectionalLight* directionalLight : directionalLights)
+			directionalLightData.push_back(directionalLight->GetData());
+
+		// Lights whose radius does not reach the view cannot affect any visible fragment
+		std::vector<PointLight*> pointLights;
 		std::vector<PointLightData> pointLightData;
 
-		UpdateBuffersRecursive(currentFrame, swapChainExtent, rootObject.get(), directionalLightData, pointLightData);
+		spatialIndex->Query(frustum, SpatialCategory::PointLight, [&](int32_t proxyId)
+			{
+				auto* pointLight = static_cast<PointLight*>(static_cast<const SpatialProxy*>(spatialIndex->GetUserData(proxyId))->object);
+
+				PointLightData data = pointLight->GetData();
+				if (frustum.IntersectsSphere(glm::vec3(data.positionRadius), data.positionRadius.w))
+				{
+					pointLights.push_back(pointLight);
+					pointLightData.push_back(data);
+				}
+				return true;
+			});
+
+		if (pointLightData.size() > MAX_POINT_LIGHTS)
+		{
+			pointLights.resize(MAX_POINT_LIGHTS);
+			pointLightData.resize(MAX_POINT_LIGHTS);
+		}
+
+		// Instances outside the view are not drawn, so their buffers and light lists can wait until they are
+		std::vector<MeshInstance*> meshInstances;
+		spatialIndex->Query(frustum, SpatialCategory::MeshInstance, [&](int32_t proxyId)
+			{
+				meshInstances.push_back(static_cast<MeshInstance*>(static_cast<const SpatialProxy*>(spatialIndex->GetUserData(proxyId))->object));
+				return true;
+			});
+
+		hasDirectionalLights = !directionalLightData.empty();
+		hasPointLights = !pointLightData.empty();
+
+		if (lightingMode == LightingMode::PerObject)
+			AssignObjectLights(meshInstances, pointLights, pointLightData, frustum);
+
+		for (MeshInstance* meshInstance : meshInstances)
+			meshInstance->UpdateUniformBuffer(currentFrame);
 
 		globalDescriptorSetManager->UpdateDirectionalLights(currentFrame, directionalLightData);
-		globalDescriptorSetManager->UpdatePointLights(currentFrame, pointLightData);
+		globalDescriptorSetManager->UpdatePointLights(currentFrame, pointLightData, lightingMode == LightingMode::PerObject);
+
+		if (lightingMode == LightingMode::Clustered)
+		{
+			lightClusterGrid->Build(pointLightData, cameraUBO.view, cameraUBO.projection, swapChainExtent, camera->nearPlane, camera->farPlane);
+			globalDescriptorSetManager->UpdateLightClusters(currentFrame, *lightClusterGrid);
+		}
 	}
 
-	void Scene::UpdateBuffersRecursive(int currentFrame, VkExtent2D swapChainExtent, SceneObject* object, std::vector<DirectionalLightData>& directionalLightData, std::vector<PointLightData>& pointLightData)
+	LightingMode Scene::GetLightingMode() const
 	{
-		if (!object)
-			return;
+		return lightingMode;
+	}
 
-		if (auto* meshInstance = dynamic_cast<MeshInstance*>(object))
+	void Scene::SetLightingMode(LightingMode mode)
+	{
+		lightingMode = mode;
+	}
+
+	bool Scene::HasDirectionalLights() const
+	{
+		return hasDirectionalLights;
+	}
+
+	bool Scene::HasPointLights() const
+	{
+		return hasPointLights;
+	}
+
+	const DynamicAABBTree& Scene::GetSpatialIndex() const
+	{
+		return *spatialIndex;
+	}
+
+	void Scene::QueryFrustum(const Frustum& frustum, uint32_t categoryMask, std::vector<SpatialObject*>& results)
+	{
+		FlushSpatialUpdates();
+
+		spatialIndex->Query(frustum, categoryMask, [&](int32_t proxyId)
+			{
+				results.push_back(static_cast<const SpatialProxy*>(spatialIndex->GetUserData(proxyId))->object);
+				return true;
+			});
+	}
+
+	bool Scene::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, SpatialQueryHit& hit, uint32_t categoryMask, uint32_t layerMask)
+	{
+		hit = SpatialQueryHit();
+
+		// A zero direction has nothing to normalize
+		float lengthSquared = glm::dot(direction, direction);
+		if (!(lengthSquared > 0.0f))
+			return false;
+
+		FlushSpatialUpdates();
+
+		glm::vec3 normalizedDirection = direction / std::sqrt(lengthSquared);
+		float closest = maxDistance;
+
+		spatialIndex->Raycast(origin, normalizedDirection, maxDistance, categoryMask, [&](int32_t proxyId)
+			{
+				const SpatialProxy* proxy = GetSpatialProxy(proxyId, layerMask);
+
+				float distance;
+				if (proxy && RaycastProxy(*proxy, origin, normalizedDirection, closest, distance))
+				{
+					closest = distance;
+					hit.object = proxy->object;
+					hit.distance = distance;
+				}
+
+				// A hit at the origin cannot be beaten
+				return hit.object && closest <= 0.0f ? 0.0f : closest;
+			});
+
+		return hit.object != nullptr;
+	}
+
+	size_t Scene::OverlapSphere(const glm::vec3& center, float radius, SpatialObject** results, size_t capacity, uint32_t categoryMask, uint32_t layerMask)
+	{
+		AABB box;
+		box.min = center - glm::vec3(radius);
+		box.max = center + glm::vec3(radius);
+
+		size_t count = 0;
+		if (capacity == 0)
+			return count;
+
+		FlushSpatialUpdates();
+
+		spatialIndex->Query(box, categoryMask, [&](int32_t proxyId)
+			{
+				const SpatialProxy* proxy = GetSpatialProxy(proxyId, layerMask);
+				if (!proxy || DistanceSquaredToProxy(*proxy, center) > radius * radius)
+					return true;
+
+				results[count++] = proxy->object;
+				return count < capacity;
+			});
+
+		return count;
+	}
+
+	size_t Scene::OverlapBox(const AABB& box, SpatialObject** results, size_t capacity, uint32_t categoryMask, uint32_t layerMask)
+	{
+		size_t count = 0;
+		if (capacity == 0)
+			return count;
+
+		FlushSpatialUpdates();
+
+		spatialIndex->Query(box, categoryMask, [&](int32_t proxyId)
+			{
+				const SpatialProxy* proxy = GetSpatialProxy(proxyId, layerMask);
+				if (!proxy)
+					return true;
+
+				bool overlaps;
+				if (proxy->category == SpatialCategory::PointLight)
+				{
+					float radius = proxy->bounds.GetExtents().x;
+					overlaps = box.DistanceSquared(proxy->bounds.GetCenter()) <= radius * radius;
+				}
+				else
+				{
+					overlaps = box.Intersects(proxy->bounds);
+				}
+
+				if (!overlaps)
+					return true;
+
+				results[count++] = proxy->object;
+				return count < capacity;
+			});
+
+		return count;
+	}
+
+	size_t Scene::NearestK(const glm::vec3& point, float maxDistance, SpatialQueryHit* results, size_t k, uint32_t categoryMask, uint32_t layerMask)
+	{
+		size_t count = 0;
+		if (k == 0 || !(maxDistance > 0.0f))
+			return count;
+
+		FlushSpatialUpdates();
+
+		spatialIndex->QueryNearest(point, maxDistance, categoryMask, [&](int32_t proxyId)
+			{
+				const SpatialProxy* proxy = GetSpatialProxy(proxyId, layerMask);
+				if (proxy)
+				{
+					// Ties keep the object found first, a full buffer only takes strictly closer hits
+					float distance = std::sqrt(DistanceSquaredToProxy(*proxy, point));
+					if (distance <= maxDistance && (count < k || distance < results[k - 1].distance))
+					{
+						// Insertion into the sorted buffer, dropping the farthest once full
+						size_t index = count < k ? count++ : k - 1;
+						while (index > 0 && results[index - 1].distance > distance)
+						{
+							results[index] = results[index - 1];
+							--index;
+						}
+						results[index] = SpatialQueryHit{ proxy->object, distance };
+					}
+				}
+
+				// Once full at distance zero no hit can be strictly closer, so returning zero ends the search
+				return count < k ? maxDistance : results[k - 1].distance;
+			});
+
+		return count;
+	}
+
+	void Scene::RegisterObject(SceneObject* object)
+	{
+		object->scene = this;
+
+		if (auto* directionalLight = dynamic_cast<DirectionalLight*>(object))
+			directionalLights.push_back(directionalLight);
+		else if (auto* spatialObject = dynamic_cast<SpatialObject*>(object))
+			UpdateSpatialProxy(spatialObject);
+
+		for (const auto& child : object->GetChildren())
+			RegisterObject(child.get());
+	}
+
+	void Scene::UnregisterObject(SceneObject* object)
+	{
+		for (const auto& child : object->GetChildren())
+			UnregisterObject(child.get());
+
+		object->scene = nullptr;
+
+		auto it = spatialProxies.find(object);
+		if (it != spatialProxies.end())
 		{
-			meshInstance->UpdateUniformBuffer(currentFrame);
+			spatialIndex->DestroyProxy(it->second.id);
+			spatialProxies.erase(it);
 		}
-		else if (auto* directionalLight = dynamic_cast<DirectionalLight*>(object))
+
+		dirtySpatialObjects.erase(object);
+
+		if (auto* directionalLight = dynamic_cast<DirectionalLight*>(object))
+			directionalLights.erase(std::remove(directionalLights.begin(), directionalLights.end(), directionalLight), directionalLights.end());
+
+		if (object == mainCamera)
+			mainCamera = nullptr;
+	}
+
+	void Scene::MarkTransformDirty(SpatialObject* object)
+	{
+		dirtySpatialObjects.insert(object);
+	}
+
+	void Scene::FlushSpatialUpdates()
+	{
+		for (SceneObject* object : dirtySpatialObjects)
 		{
-			directionalLightData.push_back(directionalLight->GetData());
+			bool ancestorDirty = false;
+			for (SceneObject* ancestor = object->parent; ancestor && !ancestorDirty; ancestor = ancestor->parent)
+				ancestorDirty = dirtySpatialObjects.count(ancestor) != 0;
+
+			if (!ancestorDirty)
+				UpdateSpatialProxies(object);
 		}
-		else if (auto* pointLight = dynamic_cast<PointLight*>(object))
+
+		dirtySpatialObjects.clear();
+	}
+
+	void Scene::UpdateSpatialProxies(SceneObject* object)
+	{
+		if (auto* spatialObject = dynamic_cast<SpatialObject*>(object))
 		{
-			pointLightData.push_back(pointLight->GetData());
+			if (!dynamic_cast<DirectionalLight*>(spatialObject))
+				UpdateSpatialProxy(spatialObject);
 		}
 
 		for (const auto& child : object->GetChildren())
-			UpdateBuffersRecursive(currentFrame, swapChainExtent, child.get(), directionalLightData, pointLightData);
+			UpdateSpatialProxies(child.get());
+	}
+
+	void Scene::UpdateSpatialProxy(SpatialObject* object)
+	{
+		uint32_t category;
+		AABB bounds;
+
+		if (auto* meshInstance = dynamic_cast<MeshInstance*>(object))
+		{
+			category = SpatialCategory::MeshInstance;
+			bounds = meshInstance->GetWorldBounds();
+		}
+		else if (auto* pointLight = dynamic_cast<PointLight*>(object))
+		{
+			category = SpatialCategory::PointLight;
+			glm::vec3 position = glm::vec3(pointLight->GetWorldMatrix()[3]);
+			bounds.min = position - glm::vec3(pointLight->GetRadius());
+			bounds.max = position + glm::vec3(pointLight->GetRadius());
+		}
+		else
+		{
+			category = SpatialCategory::Object;
+			glm::vec3 position = glm::vec3(object->GetWorldMatrix()[3]);
+			bounds.min = position;
+			bounds.max = position;
+		}
+
+		auto it = spatialProxies.find(object);
+
+		// A mesh without vertices has nothing to index
+		if (!bounds.IsValid())
+		{
+			if (it != spatialProxies.end())
+			{
+				spatialIndex->DestroyProxy(it->second.id);
+				spatialProxies.erase(it);
+			}
+			return;
+		}
+
+		if (it == spatialProxies.end())
+		{
+			SpatialProxy& proxy = spatialProxies.emplace(object, SpatialProxy{ object, DynamicAABBTree::NullNode, category, bounds }).first->second;
+			proxy.id = spatialIndex->CreateProxy(bounds, &proxy, category);
+			return;
+		}
+
+		// Cheap when the object stayed inside its fattened bounds
+		spatialIndex->MoveProxy(it->second.id, bounds);
+		it->second.bounds = bounds;
+	}
+
+	const Scene::SpatialProxy* Scene::GetSpatialProxy(int32_t proxyId, uint32_t layerMask) const
+	{
+		const SpatialProxy* proxy = static_cast<const SpatialProxy*>(spatialIndex->GetUserData(proxyId));
+		if (!(proxy->object->layers & layerMask))
+			return nullptr;
+		return proxy;
+	}
+
+	float Scene::DistanceSquaredToProxy(const SpatialProxy& proxy, const glm::vec3& point)
+	{
+		if (proxy.category != SpatialCategory::PointLight)
+			return proxy.bounds.DistanceSquared(point);
+
+		float distance = std::max(glm::length(point - proxy.bounds.GetCenter()) - proxy.bounds.GetExtents().x, 0.0f);
+		return distance * distance;
+	}
+
+	bool Scene::RaycastProxy(const SpatialProxy& proxy, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance)
+	{
+		if (proxy.category == SpatialCategory::PointLight)
+		{
+			glm::vec3 offset = origin - proxy.bounds.GetCenter();
+			float radius = proxy.bounds.GetExtents().x;
+
+			float b = glm::dot(offset, direction);
+			float c = glm::dot(offset, offset) - radius * radius;
+			if (c <= 0.0f)
+			{
+				distance = 0.0f;
+				return true;
+			}
+
+			float discriminant = b * b - c;
+			if (b > 0.0f || discriminant < 0.0f)
+				return false;
+
+			distance = -b - std::sqrt(discriminant);
+			return distance <= maxDistance;
+		}
+
+		float enter = 0.0f;
+		float exit = maxDistance;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			// Parallel to the slab, the division would give NaN for the flat bounds of a point object
+			if (direction[axis] == 0.0f)
+			{
+				if (origin[axis] < proxy.bounds.min[axis] || origin[axis] > proxy.bounds.max[axis])
+					return false;
+				continue;
+			}
+
+			float t1 = (proxy.bounds.min[axis] - origin[axis]) / direction[axis];
+			float t2 = (proxy.bounds.max[axis] - origin[axis]) / direction[axis];
+			enter = std::max(enter, std::min(t1, t2));
+			exit = std::min(exit, std::max(t1, t2));
+		}
+
+		if (enter > exit)
+			return false;
+
+		if (proxy.category == SpatialCategory::MeshInstance)
+		{
+			const TriangleBVH* collision = static_cast<MeshInstance*>(proxy.object)->GetMesh()->GetCollision();
+			if (collision)
+			{
+				// The local direction keeps its scale so hit distances stay in world units
+				glm::mat4 inverseWorld = glm::inverse(proxy.object->GetWorldMatrix());
+				glm::vec3 localOrigin = glm::vec3(inverseWorld * glm::vec4(origin, 1.0f));
+				glm::vec3 localDirection = glm::vec3(inverseWorld * glm::vec4(direction, 0.0f));
+
+				return collision->Raycast(localOrigin, localDirection, maxDistance, distance);
+			}
+		}
+
+		distance = enter;
+		return true;
+	}
+
+	void Scene::AssignObjectLights(const std::vector<MeshInstance*>& meshInstances, const std::vector<PointLight*>& pointLights, const std::vector<PointLightData>& pointLightData, const Frustum& frustum)
+	{
+		struct LightInfluence
+		{
+			float influence;
+			uint32_t index;
+		};
+
+		std::unordered_map<const SpatialObject*, uint32_t> lightIndices;
+		lightIndices.reserve(pointLights.size());
+		for (uint32_t i = 0; i < pointLights.size(); ++i)
+			lightIndices.emplace(pointLights[i], i);
+
+		std::vector<LightInfluence> influences;
+		influences.reserve(pointLights.size());
+
+		for (MeshInstance* meshInstance : meshInstances)
+		{
+			AABB bounds = meshInstance->GetWorldBounds();
+			if (!bounds.IsValid() || !frustum.IntersectsAABB(bounds))
+			{
+				meshInstance->SetPointLights(nullptr, 0);
+				continue;
+			}
+
+			influences.clear();
+
+			// Only lights whose radius box overlaps the object are visited
+			spatialIndex->Query(bounds, SpatialCategory::PointLight, [&](int32_t proxyId)
+				{
+					auto it = lightIndices.find(static_cast<const SpatialProxy*>(spatialIndex->GetUserData(proxyId))->object);
+					if (it == lightIndices.end())
+						return true;
+
+					uint32_t lightIndex = it->second;
+					const PointLightData& light = pointLightData[lightIndex];
+					float radius = light.positionRadius.w;
+
+					float distanceSquared = bounds.DistanceSquared(glm::vec3(light.positionRadius));
+					if (distanceSquared > radius * radius)
+						return true;
+
+					// Shader falloff evaluated at the closest point of the bounds
+					float attenuation = 1.0f - std::sqrt(distanceSquared) / radius;
+					float brightness = std::max(light.colorIntensity.r, std::max(light.colorIntensity.g, light.colorIntensity.b)) * light.colorIntensity.a;
+
+					influences.push_back({ brightness * attenuation, lightIndex });
+					return true;
+				});
+
+			uint32_t count = static_cast<uint32_t>(std::min<size_t>(influences.size(), MAX_OBJECT_POINT_LIGHTS));
+
+			std::partial_sort(influences.begin(), influences.begin() + count, influences.end(),
+				[](const LightInfluence& a, const LightInfluence& b)
+				{
+					return a.influence > b.influence;
+				});
+
+			uint32_t indices[MAX_OBJECT_POINT_LIGHTS];
+			for (uint32_t i = 0; i < count; ++i)
+				indices[i] = influences[i].index;
+
+			meshInstance->SetPointLights(indices, count);
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,591 @@
+#include "Core/SceneBinary.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include <rttr/type>
+
+#include "Core/MappedFile.h"
+#include "Core/PrefabInstance.h"
+#include "Core/SceneObject.h"
+
+namespace Nightbird
+{
+	namespace
+	{
+		constexpr uint32_t Magic = 0x4353424E; // "NBSC"
+		constexpr uint32_t NoParent = ~0u;
+
+		// The property types the JSON serializer round trips, nested classes become a field with children
+		enum class FieldKind : uint32_t
+		{
+			Bool,
+			Int,
+			UInt,
+			Float,
+			Double,
+			String,
+			Class
+		};
+
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t typeCount;
+			uint32_t fieldCount;
+			uint32_t objectCount;
+			uint32_t stringCount;
+
+			uint64_t typesOffset;
+			uint64_t fieldsOffset;
+			uint64_t objectsOffset;
+			uint64_t stringsOffset;
+			uint64_t stringDataOffset;
+			uint64_t stringDataSize;
+			uint64_t dataOffset;
+			uint64_t dataSize;
+		};
+
+		// Every object of a type has a property block of blockSize bytes laid out by the type's fields
+		struct FileType
+		{
+			uint32_t name;
+			uint32_t firstField;
+			uint32_t fieldCount;
+			uint32_t blockSize;
+		};
+
+		// Depth first, a class field is followed by its childCount direct children. Leaves hold their offset in the block
+		struct FileField
+		{
+			uint32_t name;
+			FieldKind kind;
+			uint32_t childCount;
+			uint32_t offset;
+		};
+
+		// Depth first, parents always come before their children
+		struct FileObject
+		{
+			uint32_t type;
+			uint32_t parent;
+			uint64_t dataOffset;
+		};
+
+		struct FileString
+		{
+			uint32_t offset;
+			uint32_t length;
+		};
+
+		// A field bound to the property it reads or writes, resolved once per type rather than per object
+		struct FieldPlan
+		{
+			rttr::property property;
+			FieldKind kind;
+			uint32_t offset;
+			std::vector<FieldPlan> children;
+		};
+
+		uint32_t GetFieldSize(FieldKind kind)
+		{
+			switch (kind)
+			{
+			case FieldKind::Bool:
+				return 1;
+			case FieldKind::Int:
+			case FieldKind::UInt:
+			case FieldKind::Float:
+			case FieldKind::String:
+				return 4;
+			case FieldKind::Double:
+				return 8;
+			default:
+				return 0;
+			}
+		}
+
+		bool GetFieldKind(const rttr::type& type, FieldKind& kind)
+		{
+			if (type == rttr::type::get<bool>())
+				kind = FieldKind::Bool;
+			else if (type == rttr::type::get<int>())
+				kind = FieldKind::Int;
+			else if (type == rttr::type::get<uint32_t>())
+				kind = FieldKind::UInt;
+			else if (type == rttr::type::get<float>())
+				kind = FieldKind::Float;
+			else if (type == rttr::type::get<double>())
+				kind = FieldKind::Double;
+			else if (type == rttr::type::get<std::string>())
+				kind = FieldKind::String;
+			else if (type.is_class())
+				kind = FieldKind::Class;
+			else
+				return false;
+
+			return true;
+		}
+
+		template<typename T>
+		void WriteValue(uint8_t* block, uint32_t offset, T value)
+		{
+			memcpy(block + offset, &value, sizeof(T));
+		}
+
+		template<typename T>
+		T ReadValue(const uint8_t* block, uint32_t offset)
+		{
+			T value;
+			memcpy(&value, block + offset, sizeof(T));
+			return value;
+		}
+
+		class SceneWriter
+		{
+		public:
+			bool Write(const SceneObject& root, const std::string& path)
+			{
+				AddObject(root, NoParent);
+
+				FileHeader header{};
+				header.magic = Magic;
+				header.version = SceneBinaryVersion;
+				header.typeCount = static_cast<uint32_t>(types.size());
+				header.fieldCount = static_cast<uint32_t>(fields.size());
+				header.objectCount = static_cast<uint32_t>(objects.size());
+				header.stringCount = static_cast<uint32_t>(strings.size());
+
+				Append(&header, sizeof(header));
+				header.typesOffset = Append(types.data(), types.size() * sizeof(FileType));
+				header.fieldsOffset = Append(fields.data(), fields.size() * sizeof(FileField));
+				header.objectsOffset = Append(objects.data(), objects.size() * sizeof(FileObject));
+				header.stringsOffset = Append(strings.data(), strings.size() * sizeof(FileString));
+				header.stringDataOffset = Append(stringData.data(), stringData.size());
+				header.stringDataSize = stringData.size();
+				header.dataOffset = Append(data.data(), data.size());
+				header.dataSize = data.size();
+
+				memcpy(bytes.data(), &header, sizeof(header));
+
+				std::ofstream os(path, std::ios::binary | std::ios::trunc);
+				if (!os.is_open())
+				{
+					std::cerr << "Failed to open scene for writing at " << path << std::endl;
+					return false;
+				}
+
+				os.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+				return os.good();
+			}
+
+		private:
+			struct TypeEntry
+			{
+				uint32_t index;
+				uint32_t blockSize;
+				std::vector<FieldPlan> plans;
+			};
+
+			std::unordered_map<std::string, TypeEntry> typeEntries;
+			std::unordered_map<std::string, uint32_t> stringIndices;
+
+			std::vector<FileType> types;
+			std::vector<FileField> fields;
+			std::vector<FileObject> objects;
+			std::vector<FileString> strings;
+			std::vector<char> stringData;
+			std::vector<uint8_t> data;
+
+			std::vector<uint8_t> bytes;
+
+			uint64_t Append(const void* source, size_t size)
+			{
+				bytes.resize((bytes.size() + 7) / 8 * 8);
+				uint64_t offset = bytes.size();
+				if (size > 0)
+					bytes.insert(bytes.end(), static_cast<const uint8_t*>(source), static_cast<const uint8_t*>(source) + size);
+				return offset;
+			}
+
+			uint32_t AddString(const std::string& string)
+			{
+				auto [it, inserted] = stringIndices.try_emplace(string, static_cast<uint32_t>(strings.size()));
+				if (inserted)
+				{
+					strings.push_back({ static_cast<uint32_t>(stringData.size()), static_cast<uint32_t>(string.size()) });
+					stringData.insert(stringData.end(), string.begin(), string.end());
+				}
+				return it->second;
+			}
+
+			void BuildPlans(const rttr::type& type, std::vector<FieldPlan>& plans, uint32_t& blockSize)
+			{
+				for (const auto& property : type.get_properties())
+				{
+					FieldKind kind;
+					if (!property.is_valid() || !GetFieldKind(property.get_type(), kind))
+						continue;
+
+					FieldPlan plan{ property, kind, blockSize, {} };
+					blockSize += GetFieldSize(kind);
+
+					if (kind == FieldKind::Class)
+						BuildPlans(property.get_type(), plan.children, blockSize);
+
+					plans.push_back(std::move(plan));
+				}
+			}
+
+			void AddFields(const std::vector<FieldPlan>& plans)
+			{
+				for (const FieldPlan& plan : plans)
+				{
+					fields.push_back({ AddString(plan.property.get_name().to_string()), plan.kind, static_cast<uint32_t>(plan.children.size()), plan.offset });
+					AddFields(plan.children);
+				}
+			}
+
+			const TypeEntry& GetTypeEntry(const rttr::type& type)
+			{
+				std::string name = type.get_name().to_string();
+
+				auto it = typeEntries.find(name);
+				if (it != typeEntries.end())
+					return it->second;
+
+				TypeEntry entry;
+				entry.index = static_cast<uint32_t>(types.size());
+				entry.blockSize = 0;
+				BuildPlans(type, entry.plans, entry.blockSize);
+
+				FileType fileType;
+				fileType.name = AddString(name);
+				fileType.firstField = static_cast<uint32_t>(fields.size());
+				AddFields(entry.plans);
+				fileType.fieldCount = static_cast<uint32_t>(fields.size()) - fileType.firstField;
+				fileType.blockSize = entry.blockSize;
+				types.push_back(fileType);
+
+				return typeEntries.emplace(name, std::move(entry)).first->second;
+			}
+
+			void WriteFields(const rttr::instance& instance, const std::vector<FieldPlan>& plans, size_t blockOffset)
+			{
+				for (const FieldPlan& plan : plans)
+				{
+					rttr::variant value = plan.property.get_value(instance);
+					if (!value.is_valid())
+						continue;
+
+					uint8_t* block = data.data() + blockOffset;
+
+					switch (plan.kind)
+					{
+					case FieldKind::Bool:
+						WriteValue<uint8_t>(block, plan.offset, value.get_value<bool>() ? 1 : 0);
+						break;
+					case FieldKind::Int:
+						WriteValue<int32_t>(block, plan.offset, value.get_value<int>());
+						break;
+					case FieldKind::UInt:
+						WriteValue<uint32_t>(block, plan.offset, value.get_value<uint32_t>());
+						break;
+					case FieldKind::Float:
+						WriteValue<float>(block, plan.offset, value.get_value<float>());
+						break;
+					case FieldKind::Double:
+						WriteValue<double>(block, plan.offset, value.get_value<double>());
+						break;
+					case FieldKind::String:
+						WriteValue<uint32_t>(block, plan.offset, AddString(value.get_value<std::string>()));
+						break;
+					case FieldKind::Class:
+						WriteFields(rttr::instance(value), plan.children, blockOffset);
+						break;
+					}
+				}
+			}
+
+			void AddObject(const SceneObject& object, uint32_t parent)
+			{
+				rttr::instance instance = object;
+				const TypeEntry& entry = GetTypeEntry(instance.get_derived_type());
+
+				uint32_t index = static_cast<uint32_t>(objects.size());
+				objects.push_back({ entry.index, parent, data.size() });
+
+				size_t blockOffset = data.size();
+				data.resize(data.size() + entry.blockSize);
+				WriteFields(instance, entry.plans, blockOffset);
+
+				// Rebuilt from the model on load
+				if (dynamic_cast<const PrefabInstance*>(&object))
+					return;
+
+				for (const auto& child : object.GetChildren())
+					AddObject(*child, index);
+			}
+		};
+
+		class SceneReader
+		{
+		public:
+			bool Read(const std::string& path, SceneObject& root)
+			{
+				if (!file.Open(path))
+				{
+					std::cerr << "Failed to open scene for reading at " << path << std::endl;
+					return false;
+				}
+
+				if (!ReadTables())
+				{
+					std::cerr << "Corrupt scene file: " << path << std::endl;
+					return false;
+				}
+
+				if (header->objectCount == 0)
+					return true;
+
+				// The one allocation sized by the object count, children vectors are then reserved exactly
+				struct Slot
+				{
+					SceneObject* object = nullptr;
+					uint32_t childCount = 0;
+				};
+
+				std::vector<Slot> slots(header->objectCount);
+				for (uint32_t i = 1; i < header->objectCount; ++i)
+					++slots[objects[i].parent].childCount;
+
+				ApplyFields(root, loadTypes[objects[0].type].plans, data + objects[0].dataOffset);
+				root.ClearChildren();
+				root.ReserveChildren(slots[0].childCount);
+				slots[0].object = &root;
+
+				for (uint32_t i = 1; i < header->objectCount; ++i)
+				{
+					const FileObject& fileObject = objects[i];
+
+					// Skipped with their whole subtree when the parent could not be created
+					SceneObject* parent = slots[fileObject.parent].object;
+					if (!parent)
+						continue;
+
+					LoadType& loadType = loadTypes[fileObject.type];
+					if (!loadType.create.is_valid())
+						continue;
+
+					rttr::variant variant = loadType.create.invoke({}, loadType.name);
+					if (!variant.is_type<SceneObject*>())
+						continue;
+
+					SceneObject* object = variant.get_value<SceneObject*>();
+					ApplyFields(*object, loadType.plans, data + fileObject.dataOffset);
+					object->ReserveChildren(slots[i].childCount);
+
+					parent->AddChild(std::unique_ptr<SceneObject>(object));
+					slots[i].object = object;
+				}
+
+				return true;
+			}
+
+		private:
+			struct LoadType
+			{
+				std::string name;
+				rttr::method create = rttr::type::get_global_method("");
+				std::vector<FieldPlan> plans;
+			};
+
+			MappedFile file;
+
+			const FileHeader* header = nullptr;
+			const FileObject* objects = nullptr;
+			const FileString* strings = nullptr;
+			const char* stringData = nullptr;
+			const uint8_t* data = nullptr;
+
+			std::vector<LoadType> loadTypes;
+
+			// Null when the range leaves the file or breaks alignment
+			template<typename T>
+			const T* Get(uint64_t offset, uint64_t count) const
+			{
+				if (offset % alignof(T) != 0 || offset > file.GetSize() || count > (file.GetSize() - offset) / sizeof(T))
+					return nullptr;
+				return reinterpret_cast<const T*>(file.GetData() + offset);
+			}
+
+			std::string GetString(uint32_t index) const
+			{
+				return std::string(stringData + strings[index].offset, strings[index].length);
+			}
+
+			bool ReadTables()
+			{
+				header = Get<FileHeader>(0, 1);
+				if (!header || header->magic != Magic || header->version != SceneBinaryVersion)
+					return false;
+
+				const FileType* types = Get<FileType>(header->typesOffset, header->typeCount);
+				const FileField* fields = Get<FileField>(header->fieldsOffset, header->fieldCount);
+				objects = Get<FileObject>(header->objectsOffset, header->objectCount);
+				strings = Get<FileString>(header->stringsOffset, header->stringCount);
+				stringData = Get<char>(header->stringDataOffset, header->stringDataSize);
+				data = Get<uint8_t>(header->dataOffset, header->dataSize);
+
+				if ((header->typeCount && !types) || (header->fieldCount && !fields) || (header->objectCount && !objects) ||
+					(header->stringCount && !strings) || (header->stringDataSize && !stringData) || (header->dataSize && !data))
+					return false;
+
+				// Checked once here, so the loops below index without further tests
+				for (uint32_t i = 0; i < header->stringCount; ++i)
+				{
+					if (strings[i].offset > header->stringDataSize || strings[i].length > header->stringDataSize - strings[i].offset)
+						return false;
+				}
+
+				for (uint32_t i = 0; i < header->fieldCount; ++i)
+				{
+					if (fields[i].name >= header->stringCount)
+						return false;
+				}
+
+				for (uint32_t i = 0; i < header->objectCount; ++i)
+				{
+					const FileObject& object = objects[i];
+					if (object.type >= header->typeCount || (i == 0 ? object.parent != NoParent : object.parent >= i))
+						return false;
+					if (object.dataOffset > header->dataSize || types[object.type].blockSize > header->dataSize - object.dataOffset)
+						return false;
+				}
+
+				loadTypes.resize(header->typeCount);
+				for (uint32_t i = 0; i < header->typeCount; ++i)
+				{
+					const FileType& fileType = types[i];
+					if (fileType.name >= header->stringCount || fileType.firstField > header->fieldCount || fileType.fieldCount > header->fieldCount - fileType.firstField)
+						return false;
+
+					LoadType& loadType = loadTypes[i];
+					loadType.name = GetString(fileType.name);
+
+					rttr::type type = rttr::type::get_by_name(loadType.name);
+					if (!type.is_valid())
+					{
+						std::cerr << "Scene load error: unknown type: " << loadType.name << std::endl;
+						continue;
+					}
+
+					loadType.create = rttr::type::get_global_method("Create" + loadType.name);
+					if (!loadType.create.is_valid())
+						std::cerr << "Scene load error: no factory method found for type: " << loadType.name << std::endl;
+
+					const FileField* typeFields = fields + fileType.firstField;
+					uint32_t index = 0;
+					while (index < fileType.fieldCount)
+					{
+						if (!ResolveField(type, true, typeFields, index, fileType.fieldCount, fileType.blockSize, loadType.plans))
+							return false;
+					}
+				}
+
+				return true;
+			}
+
+			// Matches a stored field to the current property by name and kind, fields that no longer match are skipped with their children
+			bool ResolveField(const rttr::type& type, bool usable, const FileField* fields, uint32_t& index, uint32_t count, uint32_t blockSize, std::vector<FieldPlan>& plans)
+			{
+				if (index >= count)
+					return false;
+
+				const FileField& field = fields[index++];
+				if (field.kind > FieldKind::Class || (field.kind != FieldKind::Class && (field.offset > blockSize || GetFieldSize(field.kind) > blockSize - field.offset)))
+					return false;
+
+				rttr::property property = usable ? type.get_property(GetString(field.name)) : rttr::type::get<void>().get_property("");
+
+				FieldKind kind;
+				usable = usable && property.is_valid() && !property.is_readonly() && GetFieldKind(property.get_type(), kind) && kind == field.kind;
+
+				FieldPlan plan{ property, field.kind, field.offset, {} };
+				for (uint32_t child = 0; child < field.childCount; ++child)
+				{
+					if (!ResolveField(usable ? property.get_type() : type, usable, fields, index, count, blockSize, plan.children))
+						return false;
+				}
+
+				if (usable)
+					plans.push_back(std::move(plan));
+
+				return true;
+			}
+
+			void ApplyFields(rttr::instance instance, const std::vector<FieldPlan>& plans, const uint8_t* block) const
+			{
+				for (const FieldPlan& plan : plans)
+				{
+					bool success = true;
+
+					switch (plan.kind)
+					{
+					case FieldKind::Bool:
+						success = plan.property.set_value(instance, ReadValue<uint8_t>(block, plan.offset) != 0);
+						break;
+					case FieldKind::Int:
+						success = plan.property.set_value(instance, static_cast<int>(ReadValue<int32_t>(block, plan.offset)));
+						break;
+					case FieldKind::UInt:
+						success = plan.property.set_value(instance, ReadValue<uint32_t>(block, plan.offset));
+						break;
+					case FieldKind::Float:
+						success = plan.property.set_value(instance, ReadValue<float>(block, plan.offset));
+						break;
+					case FieldKind::Double:
+						success = plan.property.set_value(instance, ReadValue<double>(block, plan.offset));
+						break;
+					case FieldKind::String:
+					{
+						uint32_t string = ReadValue<uint32_t>(block, plan.offset);
+						if (string < header->stringCount)
+							success = plan.property.set_value(instance, GetString(string));
+						break;
+					}
+					case FieldKind::Class:
+					{
+						// Nested values are copied out, filled and set back like the JSON path does
+						rttr::variant value = plan.property.get_value(instance);
+						if (!value.is_valid())
+							break;
+						ApplyFields(rttr::instance(value), plan.children, block);
+						success = plan.property.set_value(instance, value);
+						break;
+					}
+					}
+
+					if (!success)
+						std::cerr << "Failed to set value for property: " << plan.property.get_name() << std::endl;
+				}
+			}
+		};
+	}
+
+	bool SaveSceneBinary(const SceneObject& root, const std::string& path)
+	{
+		SceneWriter writer;
+		return writer.Write(root, path);
+	}
+
+	bool LoadSceneBinary(const std::string& path, SceneObject& root)
+	{
+		SceneReader reader;
+		return reader.Read(path, root);
+	}
+}
\ No newline at end of file
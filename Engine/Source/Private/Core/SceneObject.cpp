@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "Core/RTTRSerialization.h"
+#include "Core/Scene.h"
 
 namespace Nightbird
 {
@@ -51,6 +52,11 @@ namespace Nightbird
 		return parent;
 	}
 
+	Scene* SceneObject::GetScene() const
+	{
+		return scene;
+	}
+
 	const std::vector<std::unique_ptr<SceneObject>>& SceneObject::GetChildren() const
 	{
 		return children;
@@ -60,6 +66,9 @@ namespace Nightbird
 	{
 		child->parent = this;
 		children.push_back(std::move(child));
+
+		if (scene)
+			scene->RegisterObject(children.back().get());
 	}
 
 	std::unique_ptr<SceneObject> SceneObject::DetachChild(SceneObject* child)
@@ -73,6 +82,9 @@ namespace Nightbird
 
 		if (it != children.end())
 		{
+			if (scene)
+				scene->UnregisterObject(it->get());
+
 			std::unique_ptr<SceneObject> detachedChild = std::move(*it);
 			children.erase(it);
 			detachedChild->parent = nullptr;
@@ -82,6 +94,23 @@ namespace Nightbird
 		return nullptr;
 	}
 
+	void SceneObject::ClearChildren()
+	{
+		// The scene index drops the subtree before it is freed
+		if (scene)
+		{
+			for (const auto& child : children)
+				scene->UnregisterObject(child.get());
+		}
+
+		children.clear();
+	}
+
+	void SceneObject::ReserveChildren(size_t count)
+	{
+		children.reserve(count);
+	}
+
 	void SceneObject::EnterScene()
 	{
 
@@ -109,7 +138,7 @@ namespace Nightbird
 	{
 		DeserializeBase(in);
 
-		children.clear();
+		ClearChildren();
 		if (in.contains("__children"))
 		{
 			for (const auto& childJson : in.at("__children"))
@@ -1,5 +1,7 @@
 #include "Core/SpatialObject.h"
 
+#include "Core/Scene.h"
+
 namespace Nightbird
 {
 	glm::mat4 SpatialObject::GetLocalMatrix() const
@@ -16,13 +18,49 @@ namespace Nightbird
 		}
 		return transform.GetLocalMatrix();
 	}
+
+	const Transform& SpatialObject::GetTransform() const
+	{
+		return transform;
+	}
+
+	void SpatialObject::SetTransform(const Transform& value)
+	{
+		transform = value;
+		MarkTransformDirty();
+	}
+
+	void SpatialObject::SetPosition(const glm::vec3& position)
+	{
+		transform.position = position;
+		MarkTransformDirty();
+	}
+
+	void SpatialObject::SetRotation(const glm::quat& rotation)
+	{
+		transform.rotation = rotation;
+		MarkTransformDirty();
+	}
+
+	void SpatialObject::SetScale(const glm::vec3& scale)
+	{
+		transform.scale = scale;
+		MarkTransformDirty();
+	}
+
+	void SpatialObject::MarkTransformDirty()
+	{
+		if (scene)
+			scene->MarkTransformDirty(this);
+	}
 }
 
 RTTR_REGISTRATION
 {
 	rttr::registration::class_<Nightbird::SpatialObject>("SpatialObject")
 	.constructor<std::string>()
-	.property("Transform", &Nightbird::SpatialObject::transform);
+	.property("Transform", &Nightbird::SpatialObject::GetTransform, &Nightbird::SpatialObject::SetTransform)
+	.property("Layers", &Nightbird::SpatialObject::layers);
 
 	rttr::registration::method("CreateSpatialObject", [](const std::string& name) -> Nightbird::SceneObject*
 	{
@@ -0,0 +1,417 @@
+#include "Core/TriangleBVH.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define NIGHTBIRD_PICK_SSE
+#endif
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstring>
+
+namespace Nightbird
+{
+	void TriangleBVH::Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices)
+	{
+		nodes.clear();
+		packs.clear();
+		triangleCount = indices.size() / 3;
+
+		if (triangleCount == 0)
+			return;
+
+		BuildData data{ positions, indices, {}, {}, {} };
+		data.triangles.resize(triangleCount);
+		std::iota(data.triangles.begin(), data.triangles.end(), 0u);
+
+		data.triangleBounds.resize(triangleCount);
+		data.centroids.resize(triangleCount);
+		for (size_t i = 0; i < triangleCount; ++i)
+		{
+			AABB bounds;
+			bounds.Expand(positions[indices[i * 3 + 0]]);
+			bounds.Expand(positions[indices[i * 3 + 1]]);
+			bounds.Expand(positions[indices[i * 3 + 2]]);
+			data.triangleBounds[i] = bounds;
+			data.centroids[i] = bounds.GetCenter();
+		}
+
+		nodes.reserve(triangleCount / LeafSize * 2 + 1);
+		packs.reserve(triangleCount / LeafSize + 1);
+
+		nodes.emplace_back();
+		Subdivide(data, 0, 0, static_cast<uint32_t>(triangleCount), 0);
+	}
+
+	void TriangleBVH::Serialize(std::vector<uint8_t>& out) const
+	{
+		uint64_t header[3] = { triangleCount, nodes.size(), packs.size() };
+
+		size_t start = out.size();
+		out.resize(start + sizeof(header) + nodes.size() * sizeof(Node) + packs.size() * sizeof(TrianglePack));
+
+		uint8_t* destination = out.data() + start;
+		memcpy(destination, header, sizeof(header));
+		destination += sizeof(header);
+		memcpy(destination, nodes.data(), nodes.size() * sizeof(Node));
+		destination += nodes.size() * sizeof(Node);
+		memcpy(destination, packs.data(), packs.size() * sizeof(TrianglePack));
+	}
+
+	bool TriangleBVH::Deserialize(const uint8_t* data, size_t size)
+	{
+		uint64_t header[3];
+		if (size < sizeof(header))
+			return false;
+
+		memcpy(header, data, sizeof(header));
+		if (header[1] > size / sizeof(Node) || header[2] > size / sizeof(TrianglePack) ||
+			sizeof(header) + header[1] * sizeof(Node) + header[2] * sizeof(TrianglePack) != size)
+			return false;
+
+		triangleCount = static_cast<size_t>(header[0]);
+		nodes.resize(static_cast<size_t>(header[1]));
+		packs.resize(static_cast<size_t>(header[2]));
+
+		const uint8_t* source = data + sizeof(header);
+		memcpy(nodes.data(), source, nodes.size() * sizeof(Node));
+		source += nodes.size() * sizeof(Node);
+		memcpy(packs.data(), source, packs.size() * sizeof(TrianglePack));
+
+		if (!Validate())
+		{
+			nodes.clear();
+			packs.clear();
+			triangleCount = 0;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TriangleBVH::Validate() const
+	{
+		// Children always follow their parent, so one forward pass bounds every depth and rules out cycles
+		std::vector<uint32_t> depths(nodes.size(), 0);
+
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			const Node& node = nodes[i];
+
+			if (node.packCount > 0)
+			{
+				if (node.leftOrFirst > packs.size() || node.packCount > packs.size() - node.leftOrFirst)
+					return false;
+				continue;
+			}
+
+			if (node.leftOrFirst <= i || node.leftOrFirst >= nodes.size() - 1 || depths[i] >= MaxDepth)
+				return false;
+
+			depths[node.leftOrFirst] = std::max(depths[node.leftOrFirst], depths[i] + 1);
+			depths[node.leftOrFirst + 1] = std::max(depths[node.leftOrFirst + 1], depths[i] + 1);
+		}
+
+		return true;
+	}
+
+	bool TriangleBVH::IsEmpty() const
+	{
+		return nodes.empty();
+	}
+
+	size_t TriangleBVH::GetTriangleCount() const
+	{
+		return triangleCount;
+	}
+
+	bool TriangleBVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const
+	{
+		if (nodes.empty())
+			return false;
+
+		glm::vec3 inverseDirection = 1.0f / direction;
+		float closest = maxDistance;
+
+		// Depth is capped at build time so the stack cannot overflow
+		uint32_t stack[MaxDepth + 2];
+		uint32_t count = 0;
+
+		float entry;
+		if (!IntersectNode(nodes[0], origin, inverseDirection, closest, entry))
+			return false;
+		stack[count++] = 0;
+
+		while (count > 0)
+		{
+			const Node& node = nodes[stack[--count]];
+
+			if (node.packCount > 0)
+			{
+				for (uint32_t i = 0; i < node.packCount; ++i)
+					IntersectPack(packs[node.leftOrFirst + i], origin, direction, closest);
+				continue;
+			}
+
+			uint32_t left = node.leftOrFirst;
+			uint32_t right = left + 1;
+
+			float leftEntry, rightEntry;
+			bool hitLeft = IntersectNode(nodes[left], origin, inverseDirection, closest, leftEntry);
+			bool hitRight = IntersectNode(nodes[right], origin, inverseDirection, closest, rightEntry);
+
+			// Nearer child on top so its hits shrink the ray before the other is visited
+			if (hitLeft && hitRight)
+			{
+				if (leftEntry > rightEntry)
+					std::swap(left, right);
+				stack[count++] = right;
+				stack[count++] = left;
+			}
+			else if (hitLeft)
+			{
+				stack[count++] = left;
+			}
+			else if (hitRight)
+			{
+				stack[count++] = right;
+			}
+		}
+
+		if (closest >= maxDistance)
+			return false;
+
+		distance = closest;
+		return true;
+	}
+
+	void TriangleBVH::Subdivide(BuildData& data, uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth)
+	{
+		AABB bounds;
+		AABB centroidBounds;
+		for (uint32_t i = first; i < first + count; ++i)
+		{
+			bounds.Expand(data.triangleBounds[data.triangles[i]]);
+			centroidBounds.Expand(data.centroids[data.triangles[i]]);
+		}
+
+		nodes[nodeIndex].min = bounds.min;
+		nodes[nodeIndex].max = bounds.max;
+
+		if (count <= LeafSize || depth >= MaxDepth)
+		{
+			MakeLeaf(data, nodeIndex, first, count);
+			return;
+		}
+
+		glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+		int axis = 0;
+		if (extent.y > extent[axis])
+			axis = 1;
+		if (extent.z > extent[axis])
+			axis = 2;
+
+		uint32_t* begin = data.triangles.data() + first;
+		uint32_t* end = begin + count;
+		uint32_t* middle = begin + count / 2;
+
+		if (extent[axis] > 0.0f)
+		{
+			// Binned surface area heuristic along the widest centroid axis
+			AABB binBounds[BinCount];
+			uint32_t binCounts[BinCount] = {};
+
+			float scale = BinCount / extent[axis];
+			auto binOf = [&](uint32_t triangle)
+				{
+					uint32_t bin = static_cast<uint32_t>((data.centroids[triangle][axis] - centroidBounds.min[axis]) * scale);
+					return std::min(bin, BinCount - 1);
+				};
+
+			for (uint32_t* it = begin; it != end; ++it)
+			{
+				uint32_t bin = binOf(*it);
+				binBounds[bin].Expand(data.triangleBounds[*it]);
+				++binCounts[bin];
+			}
+
+			float rightCosts[BinCount] = {};
+			AABB rightBounds;
+			uint32_t rightCount = 0;
+			for (uint32_t bin = BinCount - 1; bin > 0; --bin)
+			{
+				rightBounds.Expand(binBounds[bin]);
+				rightCount += binCounts[bin];
+				rightCosts[bin] = rightCount > 0 ? rightCount * SurfaceArea(rightBounds) : 0.0f;
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			uint32_t bestSplit = 0;
+			AABB leftBounds;
+			uint32_t leftCount = 0;
+			for (uint32_t split = 1; split < BinCount; ++split)
+			{
+				leftBounds.Expand(binBounds[split - 1]);
+				leftCount += binCounts[split - 1];
+
+				float cost = (leftCount > 0 ? leftCount * SurfaceArea(leftBounds) : 0.0f) + rightCosts[split];
+				if (leftCount > 0 && leftCount < count && cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = split;
+				}
+			}
+
+			if (bestSplit > 0)
+				middle = std::partition(begin, end, [&](uint32_t triangle) { return binOf(triangle) < bestSplit; });
+			else
+				std::nth_element(begin, middle, end, [&](uint32_t a, uint32_t b) { return data.centroids[a][axis] < data.centroids[b][axis]; });
+		}
+
+		uint32_t leftCount = static_cast<uint32_t>(middle - begin);
+		if (leftCount == 0 || leftCount == count)
+			leftCount = count / 2;
+
+		uint32_t left = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+		nodes.emplace_back();
+
+		nodes[nodeIndex].leftOrFirst = left;
+		nodes[nodeIndex].packCount = 0;
+
+		Subdivide(data, left, first, leftCount, depth + 1);
+		Subdivide(data, left + 1, first + leftCount, count - leftCount, depth + 1);
+	}
+
+	void TriangleBVH::MakeLeaf(BuildData& data, uint32_t nodeIndex, uint32_t first, uint32_t count)
+	{
+		nodes[nodeIndex].leftOrFirst = static_cast<uint32_t>(packs.size());
+		nodes[nodeIndex].packCount = (count + LeafSize - 1) / LeafSize;
+
+		for (uint32_t packStart = 0; packStart < count; packStart += LeafSize)
+		{
+			TrianglePack pack{};
+
+			for (uint32_t lane = 0; lane < LeafSize && packStart + lane < count; ++lane)
+			{
+				uint32_t triangle = data.triangles[first + packStart + lane];
+				glm::vec3 v0 = data.positions[data.indices[triangle * 3 + 0]];
+				glm::vec3 e1 = data.positions[data.indices[triangle * 3 + 1]] - v0;
+				glm::vec3 e2 = data.positions[data.indices[triangle * 3 + 2]] - v0;
+
+				pack.v0x[lane] = v0.x; pack.v0y[lane] = v0.y; pack.v0z[lane] = v0.z;
+				pack.e1x[lane] = e1.x; pack.e1y[lane] = e1.y; pack.e1z[lane] = e1.z;
+				pack.e2x[lane] = e2.x; pack.e2y[lane] = e2.y; pack.e2z[lane] = e2.z;
+			}
+
+			packs.push_back(pack);
+		}
+	}
+
+	float TriangleBVH::SurfaceArea(const AABB& aabb)
+	{
+		glm::vec3 size = aabb.max - aabb.min;
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	bool TriangleBVH::IntersectNode(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& entry)
+	{
+		glm::vec3 t1 = (node.min - origin) * inverseDirection;
+		glm::vec3 t2 = (node.max - origin) * inverseDirection;
+
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+
+		entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+		return entry <= exit;
+	}
+
+	void TriangleBVH::IntersectPack(const TrianglePack& pack, const glm::vec3& origin, const glm::vec3& direction, float& closest)
+	{
+		// Moller-Trumbore, two sided
+		constexpr float epsilon = 1e-12f;
+
+#ifdef NIGHTBIRD_PICK_SSE
+		__m128 dx = _mm_set1_ps(direction.x);
+		__m128 dy = _mm_set1_ps(direction.y);
+		__m128 dz = _mm_set1_ps(direction.z);
+
+		__m128 e1x = _mm_loadu_ps(pack.e1x), e1y = _mm_loadu_ps(pack.e1y), e1z = _mm_loadu_ps(pack.e1z);
+		__m128 e2x = _mm_loadu_ps(pack.e2x), e2y = _mm_loadu_ps(pack.e2y), e2z = _mm_loadu_ps(pack.e2z);
+
+		// p = d x e2
+		__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+		__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		__m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+		__m128 valid = _mm_cmpgt_ps(absDet, _mm_set1_ps(epsilon));
+		__m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		// s = o - v0
+		__m128 sx = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(pack.v0x));
+		__m128 sy = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_loadu_ps(pack.v0y));
+		__m128 sz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(pack.v0z));
+
+		__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+
+		// q = s x e1
+		__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+		__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+		__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+		__m128 zero = _mm_setzero_ps();
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+		valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+		valid = _mm_and_ps(valid, _mm_cmpgt_ps(t, zero));
+		valid = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_set1_ps(closest)));
+
+		int mask = _mm_movemask_ps(valid);
+		if (mask == 0)
+			return;
+
+		alignas(16) float distances[4];
+		_mm_store_ps(distances, t);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			if (mask & (1 << lane))
+				closest = std::min(closest, distances[lane]);
+		}
+#else
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			glm::vec3 e1(pack.e1x[lane], pack.e1y[lane], pack.e1z[lane]);
+			glm::vec3 e2(pack.e2x[lane], pack.e2y[lane], pack.e2z[lane]);
+
+			glm::vec3 p = glm::cross(direction, e2);
+			float det = glm::dot(e1, p);
+			if (std::abs(det) <= epsilon)
+				continue;
+
+			float inverseDet = 1.0f / det;
+			glm::vec3 s = origin - glm::vec3(pack.v0x[lane], pack.v0y[lane], pack.v0z[lane]);
+
+			float u = glm::dot(s, p) * inverseDet;
+			if (u < 0.0f || u > 1.0f)
+				continue;
+
+			glm::vec3 q = glm::cross(s, e1);
+			float v = glm::dot(direction, q) * inverseDet;
+			if (v < 0.0f || u + v > 1.0f)
+				continue;
+
+			float t = glm::dot(e2, q) * inverseDet;
+			if (t > 0.0f && t < closest)
+				closest = t;
+		}
+#endif
+	}
+}
\ No newline at end of file
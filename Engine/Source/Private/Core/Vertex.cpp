@@ -1,17 +1,28 @@
 #include "Core/Vertex.h"
 
 #include <iostream>
+#include <cmath>
+
+#include <glm/gtc/packing.hpp>
 
 namespace Nightbird
 {
-	VkVertexInputBindingDescription Vertex::GetBindingDescription()
+	std::array<VkVertexInputBindingDescription, 4> Vertex::GetBindingDescriptions()
 	{
-		VkVertexInputBindingDescription bindingDescription{};
-		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(Vertex);
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		std::array<VkVertexInputBindingDescription, 4> bindingDescriptions{};
+
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(PackedVertex);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-		return bindingDescription;
+		for (uint32_t i = 1; i < bindingDescriptions.size(); i++)
+		{
+			bindingDescriptions[i].binding = i;
+			bindingDescriptions[i].stride = sizeof(PackedTexCoord);
+			bindingDescriptions[i].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		}
+
+		return bindingDescriptions;
 	}
 
 	std::array<VkVertexInputAttributeDescription, 5> Vertex::GetAttributeDescriptions()
@@ -21,33 +32,74 @@ namespace Nightbird
 		// Position attribute
 		attributeDescriptions[0].binding = 0;
 		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(Vertex, position);
+		attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attributeDescriptions[0].offset = offsetof(PackedVertex, position);
 
 		// Normal attribute
 		attributeDescriptions[1].binding = 0;
 		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(Vertex, normal);
+		attributeDescriptions[1].format = VK_FORMAT_R16G16_SNORM;
+		attributeDescriptions[1].offset = offsetof(PackedVertex, normal);
 
 		// Base color tex coord attribute
-		attributeDescriptions[2].binding = 0;
+		attributeDescriptions[2].binding = 1;
 		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[2].offset = offsetof(Vertex, baseColorTexCoord);
+		attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[2].offset = 0;
 
 		// Metallic roughness tex coord attribute
-		attributeDescriptions[3].binding = 0;
+		attributeDescriptions[3].binding = 2;
 		attributeDescriptions[3].location = 3;
-		attributeDescriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[3].offset = offsetof(Vertex, metallicRoughnessTexCoord);
+		attributeDescriptions[3].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[3].offset = 0;
 
 		// Normal tex coord attribute
-		attributeDescriptions[4].binding = 0;
+		attributeDescriptions[4].binding = 3;
 		attributeDescriptions[4].location = 4;
-		attributeDescriptions[4].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[4].offset = offsetof(Vertex, normalTexCoord);
+		attributeDescriptions[4].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[4].offset = 0;
 
 		return attributeDescriptions;
 	}
+
+	PackedVertex PackVertex(const Vertex& vertex, const VertexDecode& decode)
+	{
+		PackedVertex packed{};
+
+		for (int i = 0; i < 3; i++)
+		{
+			float scale = decode.positionScale[i];
+			float normalized = scale > 0.0f ? (vertex.position[i] - decode.positionOffset[i]) / scale : 0.0f;
+			packed.position[i] = static_cast<uint16_t>(std::round(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+		}
+
+		// Project onto the octahedron, the lower half folds over the diagonals
+		glm::vec3 normal = vertex.normal;
+		float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (length <= 0.0f)
+			normal = glm::vec3(0.0f, 0.0f, 1.0f);
+		else
+			normal /= length;
+
+		glm::vec2 encoded(normal.x, normal.y);
+		if (normal.z < 0.0f)
+		{
+			encoded.x = (1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f);
+			encoded.y = (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f);
+		}
+
+		packed.normal[0] = static_cast<int16_t>(std::round(glm::clamp(encoded.x, -1.0f, 1.0f) * 32767.0f));
+		packed.normal[1] = static_cast<int16_t>(std::round(glm::clamp(encoded.y, -1.0f, 1.0f) * 32767.0f));
+
+		return packed;
+	}
+
+	PackedTexCoord PackTexCoord(const glm::vec2& texCoord)
+	{
+		PackedTexCoord packed{};
+		packed.uv[0] = glm::packHalf1x16(texCoord.x);
+		packed.uv[1] = glm::packHalf1x16(texCoord.y);
+
+		return packed;
+	}
 }
\ No newline at end of file
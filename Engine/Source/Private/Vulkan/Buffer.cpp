@@ -32,6 +32,11 @@ namespace Nightbird
 		return allocation;
 	}
 
+	VkDeviceSize VulkanBuffer::GetSize() const
+	{
+		return size;
+	}
+
 	void* VulkanBuffer::Map()
 	{
 		void* mappedData;
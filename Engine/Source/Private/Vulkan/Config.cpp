@@ -14,6 +14,7 @@ namespace VulkanConfig
 
 	const std::vector<const char*> validationLayers = {"VK_LAYER_KHRONOS_validation"};
 	const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+	const std::vector<const char*> optionalDeviceExtensions = {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME};
 
 	bool CheckValidationLayerSupport()
 	{
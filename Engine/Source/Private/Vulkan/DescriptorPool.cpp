@@ -28,20 +28,30 @@ namespace Nightbird
 	{
 		constexpr uint32_t SET_COUNT = 2;
 		constexpr uint32_t SAMPLER_COUNT = 2;
+		constexpr uint32_t GLOBAL_STORAGE_BUFFER_COUNT = 4;
+		// One composite set per OIT target (swap chain and editor scene window), with headroom while resizing
+		constexpr uint32_t OIT_TARGET_SET_COUNT = 4;
+		constexpr uint32_t OIT_INPUT_ATTACHMENT_COUNT = 2;
 
-		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		std::array<VkDescriptorPoolSize, 4> poolSizes{};
 		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		poolSizes[0].descriptorCount = static_cast<uint32_t>(meshCount * VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 
 		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		poolSizes[1].descriptorCount = static_cast<uint32_t>(meshCount * VulkanConfig::MAX_FRAMES_IN_FLIGHT * SAMPLER_COUNT * SET_COUNT);
 
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[2].descriptorCount = static_cast<uint32_t>(GLOBAL_STORAGE_BUFFER_COUNT * VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+
+		poolSizes[3].type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		poolSizes[3].descriptorCount = OIT_TARGET_SET_COUNT * OIT_INPUT_ATTACHMENT_COUNT;
+
 		VkDescriptorPoolCreateInfo poolInfo{};
 		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = static_cast<uint32_t>(meshCount * VulkanConfig::MAX_FRAMES_IN_FLIGHT * SET_COUNT);
+		poolInfo.maxSets = static_cast<uint32_t>(meshCount * VulkanConfig::MAX_FRAMES_IN_FLIGHT * SET_COUNT + OIT_TARGET_SET_COUNT);
 
 		if (vkCreateDescriptorPool(device->GetLogical(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
 		{
@@ -13,6 +13,7 @@ namespace Nightbird
 		CreateGlobalDescriptorSetLayout();
 		CreateMeshDescriptorSetLayout();
 		CreateMaterialDescriptorSetLayout();
+		CreateOitCompositeDescriptorSetLayout();
 	}
 
 	VulkanDescriptorSetLayoutManager::~VulkanDescriptorSetLayoutManager()
@@ -20,6 +21,7 @@ namespace Nightbird
 		vkDestroyDescriptorSetLayout(device->GetLogical(), globalDescriptorSetLayout, nullptr);
 		vkDestroyDescriptorSetLayout(device->GetLogical(), meshDescriptorSetLayout, nullptr);
 		vkDestroyDescriptorSetLayout(device->GetLogical(), materialDescriptorSetLayout, nullptr);
+		vkDestroyDescriptorSetLayout(device->GetLogical(), oitCompositeDescriptorSetLayout, nullptr);
 	}
 
 	VkDescriptorSetLayout VulkanDescriptorSetLayoutManager::GetGlobalDescriptorSetLayout() const
@@ -37,6 +39,11 @@ namespace Nightbird
 		return materialDescriptorSetLayout;
 	}
 
+	VkDescriptorSetLayout VulkanDescriptorSetLayoutManager::GetOitCompositeDescriptorSetLayout() const
+	{
+		return oitCompositeDescriptorSetLayout;
+	}
+
 	void VulkanDescriptorSetLayoutManager::CreateGlobalDescriptorSetLayout()
 	{
 		VkDescriptorSetLayoutBinding cameraBinding{};
@@ -74,7 +81,28 @@ namespace Nightbird
 		pointLightsMetaBinding.pImmutableSamplers = nullptr;
 		pointLightsMetaBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-		std::array<VkDescriptorSetLayoutBinding, 5> bindings = { cameraBinding, directionalLightsBinding, directionalLightsMetaBinding, pointLightsBinding, pointLightsMetaBinding };
+		VkDescriptorSetLayoutBinding lightClustersBinding{};
+		lightClustersBinding.binding = 5;
+		lightClustersBinding.descriptorCount = 1;
+		lightClustersBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		lightClustersBinding.pImmutableSamplers = nullptr;
+		lightClustersBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkDescriptorSetLayoutBinding lightIndicesBinding{};
+		lightIndicesBinding.binding = 6;
+		lightIndicesBinding.descriptorCount = 1;
+		lightIndicesBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		lightIndicesBinding.pImmutableSamplers = nullptr;
+		lightIndicesBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkDescriptorSetLayoutBinding lightClusterMetaBinding{};
+		lightClusterMetaBinding.binding = 7;
+		lightClusterMetaBinding.descriptorCount = 1;
+		lightClusterMetaBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		lightClusterMetaBinding.pImmutableSamplers = nullptr;
+		lightClusterMetaBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		std::array<VkDescriptorSetLayoutBinding, 8> bindings = { cameraBinding, directionalLightsBinding, directionalLightsMetaBinding, pointLightsBinding, pointLightsMetaBinding, lightClustersBinding, lightIndicesBinding, lightClusterMetaBinding };
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -93,7 +121,7 @@ namespace Nightbird
 		uboBinding.descriptorCount = 1;
 		uboBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		uboBinding.pImmutableSamplers = nullptr;
-		uboBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		uboBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -147,4 +175,31 @@ namespace Nightbird
 			std::cerr << "Failed to create mesh descriptor set layout" << std::endl;
 		}
 	}
+	void VulkanDescriptorSetLayoutManager::CreateOitCompositeDescriptorSetLayout()
+	{
+		VkDescriptorSetLayoutBinding accumBinding{};
+		accumBinding.binding = 0;
+		accumBinding.descriptorCount = 1;
+		accumBinding.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		accumBinding.pImmutableSamplers = nullptr;
+		accumBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkDescriptorSetLayoutBinding revealageBinding{};
+		revealageBinding.binding = 1;
+		revealageBinding.descriptorCount = 1;
+		revealageBinding.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		revealageBinding.pImmutableSamplers = nullptr;
+		revealageBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		std::array<VkDescriptorSetLayoutBinding, 2> bindings = {accumBinding, revealageBinding};
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		if (vkCreateDescriptorSetLayout(device->GetLogical(), &layoutInfo, nullptr, &oitCompositeDescriptorSetLayout) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create OIT composite descriptor set layout" << std::endl;
+		}
+	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <map>
 #include <set>
+#include <cstring>
 
 #include <Vulkan/Config.h>
 
@@ -78,13 +79,22 @@ namespace Nightbird
 		VkPhysicalDeviceFeatures deviceFeatures{};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+		enabledExtensions = VulkanConfig::deviceExtensions;
+		for (const char* extensionName : VulkanConfig::optionalDeviceExtensions)
+		{
+			if (IsDeviceExtensionSupported(physicalDevice, extensionName))
+				enabledExtensions.push_back(extensionName);
+		}
+
+		memoryBudgetSupported = IsExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(VulkanConfig::deviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = VulkanConfig::deviceExtensions.data();
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 		if (VulkanConfig::enableValidationLayers)
 		{
@@ -117,11 +127,18 @@ namespace Nightbird
 		allocatorInfo.device = logicalDevice;
 		allocatorInfo.instance = instance;
 		allocatorInfo.pVulkanFunctions = &vulkanFunctions;
+		allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+
+		// Lets VMA report real per-heap usage and budget from the driver instead of its own estimate
+		if (memoryBudgetSupported)
+			allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
 		if (vmaCreateAllocator(&allocatorInfo, &allocator) != VK_SUCCESS)
 		{
 			std::cerr << "Failed to create Vulkan Memory Allocator" << std::endl;
 		}
+
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
 	}
 
 	void VulkanDevice::CreateCommandPool()
@@ -219,4 +236,40 @@ namespace Nightbird
 	{
 		return allocator;
 	}
+
+	bool VulkanDevice::IsExtensionEnabled(const char* extensionName) const
+	{
+		for (const char* enabledExtension : enabledExtensions)
+		{
+			if (strcmp(enabledExtension, extensionName) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool VulkanDevice::IsMemoryBudgetSupported() const
+	{
+		return memoryBudgetSupported;
+	}
+
+	void VulkanDevice::SetFrameIndex(uint32_t frameIndex)
+	{
+		vmaSetCurrentFrameIndex(allocator, frameIndex);
+	}
+
+	std::vector<VmaBudget> VulkanDevice::GetHeapBudgets() const
+	{
+		std::vector<VmaBudget> budgets(memoryProperties.memoryHeapCount);
+		vmaGetHeapBudgets(allocator, budgets.data());
+
+		return budgets;
+	}
+
+	bool VulkanDevice::IsHeapDeviceLocal(uint32_t heapIndex) const
+	{
+		if (heapIndex >= memoryProperties.memoryHeapCount)
+			return false;
+
+		return (memoryProperties.memoryHeaps[heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <Vulkan/GlobalDescriptorSetManager.h>
 
 #include <array>
+#include <algorithm>
 #include <iostream>
 
 #include <Vulkan/Config.h>
@@ -10,6 +11,8 @@
 #include <Core/CameraUBO.h>
 #include <Core/DirectionalLightData.h>
 #include <Core/PointLightData.h>
+#include <Core/LightClusterData.h>
+#include <Core/LightClusterGrid.h>
 
 namespace Nightbird
 {
@@ -37,43 +40,59 @@ namespace Nightbird
 
 	void GlobalDescriptorSetManager::UpdateDirectionalLights(uint32_t frameIndex, const std::vector<DirectionalLightData>& directionalLights)
 	{
-		VkDeviceSize size = sizeof(PointLightData) * directionalLights.size();
-		if (size > 0)
-		{
-			directionalLightBuffers[frameIndex].UploadData(directionalLights.data(), size);
+		uint32_t count = static_cast<uint32_t>(std::min<size_t>(directionalLights.size(), MAX_DIRECTIONAL_LIGHTS));
+		if (count > 0)
+			directionalLightBuffers[frameIndex].UploadData(directionalLights.data(), sizeof(DirectionalLightData) * count);
 
-			DirectionalLightMetaUBO metaUBO{};
-			metaUBO.count = static_cast<uint32_t>(directionalLights.size());
-			memcpy(directionalLightMetaBuffers[frameIndex].GetMappedData(), &metaUBO, sizeof(metaUBO));
-		}
+		DirectionalLightMetaUBO metaUBO{};
+		metaUBO.count = count;
+		memcpy(directionalLightMetaBuffers[frameIndex].GetMappedData(), &metaUBO, sizeof(metaUBO));
 	}
 
-	void GlobalDescriptorSetManager::UpdatePointLights(uint32_t frameIndex, const std::vector<PointLightData>& pointLights)
+	void GlobalDescriptorSetManager::UpdatePointLights(uint32_t frameIndex, const std::vector<PointLightData>& pointLights, bool perObjectLights)
 	{
-		VkDeviceSize size = sizeof(PointLightData) * pointLights.size();
-		if (size > 0)
-		{
-			pointLightBuffers[frameIndex].UploadData(pointLights.data(), size);
+		uint32_t count = static_cast<uint32_t>(std::min<size_t>(pointLights.size(), MAX_POINT_LIGHTS));
+		if (count > 0)
+			pointLightBuffers[frameIndex].UploadData(pointLights.data(), sizeof(PointLightData) * count);
+
+		PointLightMetaUBO metaUBO{};
+		metaUBO.count = count;
+		metaUBO.perObjectLights = perObjectLights ? 1 : 0;
+		memcpy(pointLightMetaBuffers[frameIndex].GetMappedData(), &metaUBO, sizeof(metaUBO));
+	}
 
-			PointLightMetaUBO metaUBO{};
-			metaUBO.count = static_cast<uint32_t>(pointLights.size());
-			memcpy(pointLightMetaBuffers[frameIndex].GetMappedData(), &metaUBO, sizeof(metaUBO));
-		}
+	void GlobalDescriptorSetManager::UpdateLightClusters(uint32_t frameIndex, const LightClusterGrid& lightClusterGrid)
+	{
+		const auto& clusters = lightClusterGrid.GetClusters();
+		lightClusterBuffers[frameIndex].UploadData(clusters.data(), sizeof(LightClusterRange) * clusters.size());
+
+		const auto& lightIndices = lightClusterGrid.GetLightIndices();
+		if (!lightIndices.empty())
+			lightIndexBuffers[frameIndex].UploadData(lightIndices.data(), sizeof(uint32_t) * lightIndices.size());
+
+		const LightClusterMetaUBO& metaUBO = lightClusterGrid.GetMetaUBO();
+		memcpy(lightClusterMetaBuffers[frameIndex].GetMappedData(), &metaUBO, sizeof(metaUBO));
 	}
 
 	void GlobalDescriptorSetManager::CreateBuffers()
 	{
 		VkDeviceSize cameraSize = sizeof(CameraUBO);
 		VkDeviceSize directionalLightBufferSize = sizeof(DirectionalLightData) * MAX_DIRECTIONAL_LIGHTS;
-		VkDeviceSize directionalLightMetaBufferSize = sizeof(DirectionalLightMetaUBO) * MAX_DIRECTIONAL_LIGHTS;
+		VkDeviceSize directionalLightMetaBufferSize = sizeof(DirectionalLightMetaUBO);
 		VkDeviceSize pointLightBufferSize = sizeof(PointLightData) * MAX_POINT_LIGHTS;
-		VkDeviceSize pointLightMetaBufferSize = sizeof(PointLightMetaUBO) * MAX_POINT_LIGHTS;
+		VkDeviceSize pointLightMetaBufferSize = sizeof(PointLightMetaUBO);
+		VkDeviceSize lightClusterBufferSize = sizeof(LightClusterRange) * CLUSTER_COUNT;
+		VkDeviceSize lightIndexBufferSize = sizeof(uint32_t) * MAX_CLUSTER_LIGHT_INDICES;
+		VkDeviceSize lightClusterMetaBufferSize = sizeof(LightClusterMetaUBO);
 
 		cameraBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 		directionalLightBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 		directionalLightMetaBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 		pointLightBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 		pointLightMetaBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+		lightClusterBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+		lightIndexBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+		lightClusterMetaBuffers.reserve(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 
 		for (size_t i = 0; i < VulkanConfig::MAX_FRAMES_IN_FLIGHT; i++)
 		{
@@ -84,6 +103,10 @@ namespace Nightbird
 
 			pointLightBuffers.emplace_back(device, pointLightBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 			pointLightMetaBuffers.emplace_back(device, pointLightMetaBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			lightClusterBuffers.emplace_back(device, lightClusterBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			lightIndexBuffers.emplace_back(device, lightIndexBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			lightClusterMetaBuffers.emplace_back(device, lightClusterMetaBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 		}
 	}
 
@@ -134,7 +157,22 @@ namespace Nightbird
 			pointLightsMetaInfo.offset = 0;
 			pointLightsMetaInfo.range = sizeof(PointLightMetaUBO);
 
-			std::array<VkWriteDescriptorSet, 5> descriptorWrites{};
+			VkDescriptorBufferInfo lightClustersInfo{};
+			lightClustersInfo.buffer = lightClusterBuffers[i].Get();
+			lightClustersInfo.offset = 0;
+			lightClustersInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lightIndicesInfo{};
+			lightIndicesInfo.buffer = lightIndexBuffers[i].Get();
+			lightIndicesInfo.offset = 0;
+			lightIndicesInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lightClusterMetaInfo{};
+			lightClusterMetaInfo.buffer = lightClusterMetaBuffers[i].Get();
+			lightClusterMetaInfo.offset = 0;
+			lightClusterMetaInfo.range = sizeof(LightClusterMetaUBO);
+
+			std::array<VkWriteDescriptorSet, 8> descriptorWrites{};
 			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 			descriptorWrites[0].dstSet = descriptorSets[i];
 			descriptorWrites[0].dstBinding = 0;
@@ -175,6 +213,30 @@ namespace Nightbird
 			descriptorWrites[4].descriptorCount = 1;
 			descriptorWrites[4].pBufferInfo = &pointLightsMetaInfo;
 
+			descriptorWrites[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[5].dstSet = descriptorSets[i];
+			descriptorWrites[5].dstBinding = 5;
+			descriptorWrites[5].dstArrayElement = 0;
+			descriptorWrites[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[5].descriptorCount = 1;
+			descriptorWrites[5].pBufferInfo = &lightClustersInfo;
+
+			descriptorWrites[6].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[6].dstSet = descriptorSets[i];
+			descriptorWrites[6].dstBinding = 6;
+			descriptorWrites[6].dstArrayElement = 0;
+			descriptorWrites[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[6].descriptorCount = 1;
+			descriptorWrites[6].pBufferInfo = &lightIndicesInfo;
+
+			descriptorWrites[7].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[7].dstSet = descriptorSets[i];
+			descriptorWrites[7].dstBinding = 7;
+			descriptorWrites[7].dstArrayElement = 0;
+			descriptorWrites[7].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			descriptorWrites[7].descriptorCount = 1;
+			descriptorWrites[7].pBufferInfo = &lightClusterMetaInfo;
+
 			vkUpdateDescriptorSets(logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 		}
 	}
@@ -1,6 +1,7 @@
 #include <Vulkan/Helpers.h>
 
 #include <iostream>
+#include <cstring>
 #include <algorithm>
 #include <set>
 #include <string>
@@ -33,6 +34,22 @@ namespace Nightbird
 		return requiredExtensions.empty();
 	}
 
+	bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName)
+	{
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const auto& extension : availableExtensions)
+		{
+			if (strcmp(extension.extensionName, extensionName) == 0)
+				return true;
+		}
+		return false;
+	}
+
 	QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface)
 	{
 		QueueFamilyIndices indices;
@@ -159,12 +176,12 @@ namespace Nightbird
 		return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 	}
 	
-	void CopyBuffer(VulkanDevice* device, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+	void CopyBuffer(VulkanDevice* device, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset)
 	{
 		VkCommandBuffer commandBuffer = device->BeginSingleTimeCommands();
 
 		VkBufferCopy copyRegion{};
-		copyRegion.srcOffset = 0;
+		copyRegion.srcOffset = srcOffset;
 		copyRegion.dstOffset = 0;
 		copyRegion.size = size;
 		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
@@ -0,0 +1,636 @@
+#include <Vulkan/HiZCuller.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include <Core/Shader.h>
+#include <Core/Renderable.h>
+#include <Core/MeshPrimitive.h>
+#include <Core/Bounds.h>
+#include <Vulkan/Device.h>
+#include <Vulkan/Image.h>
+#include <Vulkan/StorageBuffer.h>
+#include <Vulkan/Helpers.h>
+
+namespace Nightbird
+{
+	VulkanHiZCuller::VulkanHiZCuller(VulkanDevice* device)
+		: device(device)
+	{
+		// Sampling depth is only guaranteed for some depth formats
+		VkFormatProperties formatProperties{};
+		vkGetPhysicalDeviceFormatProperties(device->GetPhysical(), FindDepthFormat(device->GetPhysical()), &formatProperties);
+		if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+		{
+			std::cerr << "Depth format can't be sampled, GPU occlusion culling disabled" << std::endl;
+			return;
+		}
+
+		CreateDescriptorSetLayouts();
+		CreateDescriptorPool();
+		CreatePipelines();
+
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = static_cast<float>(MaxMipCount);
+
+		if (vkCreateSampler(device->GetLogical(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create depth pyramid sampler" << std::endl;
+			return;
+		}
+
+		supported = reducePipeline != VK_NULL_HANDLE && cullPipeline != VK_NULL_HANDLE;
+	}
+
+	VulkanHiZCuller::~VulkanHiZCuller()
+	{
+		VkDevice logicalDevice = device->GetLogical();
+
+		CleanupPyramid();
+
+		if (sampler != VK_NULL_HANDLE)
+			vkDestroySampler(logicalDevice, sampler, nullptr);
+
+		if (reducePipeline != VK_NULL_HANDLE)
+			vkDestroyPipeline(logicalDevice, reducePipeline, nullptr);
+		if (cullPipeline != VK_NULL_HANDLE)
+			vkDestroyPipeline(logicalDevice, cullPipeline, nullptr);
+		if (reducePipelineLayout != VK_NULL_HANDLE)
+			vkDestroyPipelineLayout(logicalDevice, reducePipelineLayout, nullptr);
+		if (cullPipelineLayout != VK_NULL_HANDLE)
+			vkDestroyPipelineLayout(logicalDevice, cullPipelineLayout, nullptr);
+
+		// Destroying the pool frees its sets
+		if (descriptorPool != VK_NULL_HANDLE)
+			vkDestroyDescriptorPool(logicalDevice, descriptorPool, nullptr);
+		if (reduceDescriptorSetLayout != VK_NULL_HANDLE)
+			vkDestroyDescriptorSetLayout(logicalDevice, reduceDescriptorSetLayout, nullptr);
+		if (cullDescriptorSetLayout != VK_NULL_HANDLE)
+			vkDestroyDescriptorSetLayout(logicalDevice, cullDescriptorSetLayout, nullptr);
+	}
+
+	bool VulkanHiZCuller::IsSupported() const
+	{
+		return supported;
+	}
+
+	uint32_t VulkanHiZCuller::Begin(uint32_t currentFrame, uint64_t frameNumber, const glm::mat4& viewProjection, VkExtent2D extent, size_t drawCount)
+	{
+		this->currentFrame = currentFrame;
+		this->frameNumber = frameNumber;
+		this->viewProjection = viewProjection;
+
+		// The fence of this frame slot was waited on, so its counter is final
+		uint32_t occludedCount = 0;
+		if (statsBuffers[currentFrame])
+		{
+			uint32_t* stats = static_cast<uint32_t*>(statsBuffers[currentFrame]->GetMappedData());
+			occludedCount = *stats;
+			*stats = 0;
+		}
+
+		bool invalidate = false;
+
+		if (extent.width != depthExtent.width || extent.height != depthExtent.height)
+		{
+			vkDeviceWaitIdle(device->GetLogical());
+			CleanupPyramid();
+			CreatePyramid(extent);
+			invalidate = true;
+		}
+
+		// Draws missing from the previous frame give their slot back
+		for (auto it = slotLookup.begin(); it != slotLookup.end();)
+		{
+			if (slots[it->second].lastSeenFrame + 1 < frameNumber)
+			{
+				slots[it->second] = Slot{};
+				freeSlots.push_back(it->second);
+				it = slotLookup.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		// Grown before any draw of this frame references the command buffer
+		if (slots.size() + drawCount > capacity)
+		{
+			vkDeviceWaitIdle(device->GetLogical());
+			CreateBuffers(std::max({ capacity * 2, slots.size() + drawCount, static_cast<size_t>(256) }));
+			invalidate = true;
+		}
+
+		// Commands written against the old pyramid or buffers can't be trusted
+		if (invalidate)
+		{
+			for (Slot& slot : slots)
+				slot.testedFrame = 0;
+		}
+
+		objects.assign(slots.size(), CullObject{});
+		queuedSlots.clear();
+
+		return occludedCount;
+	}
+
+	void VulkanHiZCuller::AddDraw(Renderable& renderable, const AABB& worldBounds)
+	{
+		DrawKey key{ renderable.instance, renderable.primitive };
+
+		uint32_t slotIndex;
+		auto it = slotLookup.find(key);
+		if (it != slotLookup.end())
+		{
+			slotIndex = it->second;
+		}
+		else
+		{
+			if (!freeSlots.empty())
+			{
+				slotIndex = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else
+			{
+				slotIndex = static_cast<uint32_t>(slots.size());
+				slots.emplace_back();
+				objects.emplace_back();
+			}
+
+			slotLookup.emplace(key, slotIndex);
+		}
+
+		Slot& slot = slots[slotIndex];
+		if (slot.lastSeenFrame == frameNumber)
+			return;
+
+		const MeshLod& lod = renderable.primitive->GetLod(renderable.lod);
+
+		// New draws and ones the last frame didn't test are drawn directly until their first result is in
+		bool sameRange = slot.testedFirstIndex == lod.firstIndex && slot.testedIndexCount == lod.indexCount;
+		if (slot.testedFrame != 0 && slot.testedFrame + 1 == frameNumber && sameRange)
+		{
+			renderable.indirectBuffer = drawCommandBuffer->Get();
+			renderable.indirectOffset = static_cast<VkDeviceSize>(slotIndex) * sizeof(VkDrawIndexedIndirectCommand);
+		}
+
+		slot.lastSeenFrame = frameNumber;
+		slot.testedFirstIndex = lod.firstIndex;
+		slot.testedIndexCount = lod.indexCount;
+
+		CullObject& object = objects[slotIndex];
+		object.boundsMin = glm::vec4(worldBounds.min, 1.0f);
+		object.boundsMax = glm::vec4(worldBounds.max, 1.0f);
+		object.indexCount = lod.indexCount;
+		object.firstIndex = lod.firstIndex;
+		object.active = 1;
+
+		queuedSlots.push_back(slotIndex);
+	}
+
+	bool VulkanHiZCuller::Dispatch(VkCommandBuffer commandBuffer, VulkanImage* depthImage)
+	{
+		if (!supported || !depthImage || queuedSlots.empty() || pyramidImage == VK_NULL_HANDLE)
+			return false;
+
+		for (uint32_t slotIndex : queuedSlots)
+			slots[slotIndex].testedFrame = frameNumber;
+
+		objectBuffers[currentFrame]->UploadData(objects.data(), objects.size() * sizeof(CullObject));
+
+		UpdateDescriptorSets(depthImage);
+
+		VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (HasStencilComponent(depthImage->GetFormat()))
+			depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+
+		std::array<VkImageMemoryBarrier, 2> imageBarriers{};
+
+		imageBarriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageBarriers[0].oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		imageBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarriers[0].image = depthImage->Get();
+		imageBarriers[0].subresourceRange = { depthAspect, 0, 1, 0, 1 };
+		imageBarriers[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		imageBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		// The previous contents are rebuilt from scratch, the last frame's test only has to be done reading them
+		imageBarriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageBarriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageBarriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		imageBarriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarriers[1].image = pyramidImage;
+		imageBarriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount, 0, 1 };
+		imageBarriers[1].srcAccessMask = 0;
+		imageBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		vkCmdPipelineBarrier
+		(
+			commandBuffer,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+		);
+
+		// Each level keeps the farthest depth of the texels below it
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipeline);
+
+		VkMemoryBarrier levelBarrier{};
+		levelBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		for (uint32_t level = 0; level < mipCount; ++level)
+		{
+			ReducePushConstants pushConstants{};
+			pushConstants.outputSize = glm::ivec2(std::max(pyramidExtent.width >> level, 1u), std::max(pyramidExtent.height >> level, 1u));
+			if (level == 0)
+				pushConstants.inputSize = glm::ivec2(depthExtent.width, depthExtent.height);
+			else
+				pushConstants.inputSize = glm::ivec2(std::max(pyramidExtent.width >> (level - 1), 1u), std::max(pyramidExtent.height >> (level - 1), 1u));
+
+			VkDescriptorSet descriptorSet = reduceDescriptorSets[currentFrame * MaxMipCount + level];
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, reducePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+			vkCmdDispatch(commandBuffer, (pushConstants.outputSize.x + 7) / 8, (pushConstants.outputSize.y + 7) / 8, 1);
+
+			if (level + 1 < mipCount)
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &levelBarrier, 0, nullptr, 0, nullptr);
+		}
+
+		// Pyramid ready for the test, the commands free from the first pass's indirect reads, depth back for the second pass
+		VkMemoryBarrier cullBarrier{};
+		cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		cullBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		VkImageMemoryBarrier depthBarrier = imageBarriers[0];
+		depthBarrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthBarrier.srcAccessMask = 0;
+		depthBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		vkCmdPipelineBarrier
+		(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			0,
+			1, &cullBarrier,
+			0, nullptr,
+			1, &depthBarrier
+		);
+
+		CullPushConstants pushConstants{};
+		pushConstants.viewProjection = viewProjection;
+		pushConstants.pyramidSize = glm::vec2(pyramidExtent.width, pyramidExtent.height);
+		pushConstants.objectCount = static_cast<uint32_t>(objects.size());
+		pushConstants.mipCount = mipCount;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &cullDescriptorSets[currentFrame], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, (pushConstants.objectCount + 63) / 64, 1, 1);
+
+		// Commands are read by the second pass and the next frame's draws, the counter by the host once the fence signals
+		VkMemoryBarrier resultBarrier{};
+		resultBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		resultBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &resultBarrier, 0, nullptr, 0, nullptr);
+
+		return true;
+	}
+
+	VkBuffer VulkanHiZCuller::GetLateCommandBuffer() const
+	{
+		return lateCommandBuffer ? lateCommandBuffer->Get() : VK_NULL_HANDLE;
+	}
+
+	void VulkanHiZCuller::CreateDescriptorSetLayouts()
+	{
+		std::array<VkDescriptorSetLayoutBinding, 2> reduceBindings{};
+
+		reduceBindings[0].binding = 0;
+		reduceBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		reduceBindings[0].descriptorCount = 1;
+		reduceBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		reduceBindings[1].binding = 1;
+		reduceBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		reduceBindings[1].descriptorCount = 1;
+		reduceBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(reduceBindings.size());
+		layoutInfo.pBindings = reduceBindings.data();
+
+		if (vkCreateDescriptorSetLayout(device->GetLogical(), &layoutInfo, nullptr, &reduceDescriptorSetLayout) != VK_SUCCESS)
+			std::cerr << "Failed to create depth reduce descriptor set layout" << std::endl;
+
+		std::array<VkDescriptorSetLayoutBinding, 5> cullBindings{};
+
+		cullBindings[0].binding = 0;
+		cullBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		cullBindings[0].descriptorCount = 1;
+		cullBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		for (uint32_t binding = 1; binding < cullBindings.size(); ++binding)
+		{
+			cullBindings[binding].binding = binding;
+			cullBindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			cullBindings[binding].descriptorCount = 1;
+			cullBindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		layoutInfo.bindingCount = static_cast<uint32_t>(cullBindings.size());
+		layoutInfo.pBindings = cullBindings.data();
+
+		if (vkCreateDescriptorSetLayout(device->GetLogical(), &layoutInfo, nullptr, &cullDescriptorSetLayout) != VK_SUCCESS)
+			std::cerr << "Failed to create occlusion cull descriptor set layout" << std::endl;
+	}
+
+	void VulkanHiZCuller::CreateDescriptorPool()
+	{
+		constexpr uint32_t FRAME_COUNT = VulkanConfig::MAX_FRAMES_IN_FLIGHT;
+
+		std::array<VkDescriptorPoolSize, 3> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[0].descriptorCount = FRAME_COUNT * (MaxMipCount + 1);
+
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		poolSizes[1].descriptorCount = FRAME_COUNT * MaxMipCount;
+
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[2].descriptorCount = FRAME_COUNT * 4;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = FRAME_COUNT * (MaxMipCount + 1);
+
+		if (vkCreateDescriptorPool(device->GetLogical(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create occlusion culling descriptor pool" << std::endl;
+			return;
+		}
+
+		// Allocated once, rewritten each frame for the slot whose fence was waited on
+		std::vector<VkDescriptorSetLayout> reduceLayouts(reduceDescriptorSets.size(), reduceDescriptorSetLayout);
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = static_cast<uint32_t>(reduceLayouts.size());
+		allocInfo.pSetLayouts = reduceLayouts.data();
+
+		if (vkAllocateDescriptorSets(device->GetLogical(), &allocInfo, reduceDescriptorSets.data()) != VK_SUCCESS)
+			std::cerr << "Failed to allocate depth reduce descriptor sets" << std::endl;
+
+		std::vector<VkDescriptorSetLayout> cullLayouts(cullDescriptorSets.size(), cullDescriptorSetLayout);
+
+		allocInfo.descriptorSetCount = static_cast<uint32_t>(cullLayouts.size());
+		allocInfo.pSetLayouts = cullLayouts.data();
+
+		if (vkAllocateDescriptorSets(device->GetLogical(), &allocInfo, cullDescriptorSets.data()) != VK_SUCCESS)
+			std::cerr << "Failed to allocate occlusion cull descriptor sets" << std::endl;
+	}
+
+	void VulkanHiZCuller::CreatePipelines()
+	{
+		VkPushConstantRange reducePushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ReducePushConstants) };
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &reduceDescriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &reducePushConstantRange;
+
+		if (vkCreatePipelineLayout(device->GetLogical(), &pipelineLayoutInfo, nullptr, &reducePipelineLayout) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create depth reduce pipeline layout" << std::endl;
+			return;
+		}
+
+		VkPushConstantRange cullPushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants) };
+
+		pipelineLayoutInfo.pSetLayouts = &cullDescriptorSetLayout;
+		pipelineLayoutInfo.pPushConstantRanges = &cullPushConstantRange;
+
+		if (vkCreatePipelineLayout(device->GetLogical(), &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create occlusion cull pipeline layout" << std::endl;
+			return;
+		}
+
+		Shader reduceShader(device->GetLogical(), "Assets/Shaders/DepthReduceComp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+		Shader cullShader(device->GetLogical(), "Assets/Shaders/OcclusionCullComp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = reduceShader.GetStageCreateInfo();
+		pipelineInfo.layout = reducePipelineLayout;
+
+		if (vkCreateComputePipelines(device->GetLogical(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &reducePipeline) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create depth reduce pipeline" << std::endl;
+			reducePipeline = VK_NULL_HANDLE;
+		}
+
+		pipelineInfo.stage = cullShader.GetStageCreateInfo();
+		pipelineInfo.layout = cullPipelineLayout;
+
+		if (vkCreateComputePipelines(device->GetLogical(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &cullPipeline) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create occlusion cull pipeline" << std::endl;
+			cullPipeline = VK_NULL_HANDLE;
+		}
+	}
+
+	void VulkanHiZCuller::CreatePyramid(VkExtent2D extent)
+	{
+		depthExtent = extent;
+
+		// Power of two below the depth size, so every level halves exactly and a texel never misses depth texels
+		pyramidExtent = { 1, 1 };
+		while (pyramidExtent.width * 2 <= extent.width)
+			pyramidExtent.width *= 2;
+		while (pyramidExtent.height * 2 <= extent.height)
+			pyramidExtent.height *= 2;
+
+		mipCount = 1;
+		while (mipCount < MaxMipCount && (std::max(pyramidExtent.width, pyramidExtent.height) >> mipCount) > 0)
+			++mipCount;
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = { pyramidExtent.width, pyramidExtent.height, 1 };
+		imageInfo.mipLevels = mipCount;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = VK_FORMAT_R32_SFLOAT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+		VmaAllocationCreateInfo allocationInfo{};
+		allocationInfo.usage = VMA_MEMORY_USAGE_AUTO;
+		allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+		if (vmaCreateImage(device->GetAllocator(), &imageInfo, &allocationInfo, &pyramidImage, &pyramidAllocation, nullptr) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create depth pyramid image" << std::endl;
+			pyramidImage = VK_NULL_HANDLE;
+			return;
+		}
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = pyramidImage;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R32_SFLOAT;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount, 0, 1 };
+
+		if (vkCreateImageView(device->GetLogical(), &viewInfo, nullptr, &pyramidView) != VK_SUCCESS)
+			std::cerr << "Failed to create depth pyramid view" << std::endl;
+
+		// Storage image views can only cover a single level
+		for (uint32_t level = 0; level < mipCount; ++level)
+		{
+			viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+
+			if (vkCreateImageView(device->GetLogical(), &viewInfo, nullptr, &pyramidMipViews[level]) != VK_SUCCESS)
+				std::cerr << "Failed to create depth pyramid level view" << std::endl;
+		}
+	}
+
+	void VulkanHiZCuller::CleanupPyramid()
+	{
+		VkDevice logicalDevice = device->GetLogical();
+
+		for (VkImageView& view : pyramidMipViews)
+		{
+			if (view != VK_NULL_HANDLE)
+				vkDestroyImageView(logicalDevice, view, nullptr);
+			view = VK_NULL_HANDLE;
+		}
+
+		if (pyramidView != VK_NULL_HANDLE)
+			vkDestroyImageView(logicalDevice, pyramidView, nullptr);
+		pyramidView = VK_NULL_HANDLE;
+
+		if (pyramidImage != VK_NULL_HANDLE)
+			vmaDestroyImage(device->GetAllocator(), pyramidImage, pyramidAllocation);
+		pyramidImage = VK_NULL_HANDLE;
+		pyramidAllocation = VK_NULL_HANDLE;
+
+		mipCount = 0;
+	}
+
+	void VulkanHiZCuller::CreateBuffers(size_t newCapacity)
+	{
+		capacity = newCapacity;
+
+		VkMemoryPropertyFlags hostFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+		for (size_t i = 0; i < objectBuffers.size(); ++i)
+		{
+			objectBuffers[i] = std::make_unique<VulkanStorageBuffer>(device, capacity * sizeof(CullObject), 0, hostFlags);
+
+			if (!statsBuffers[i])
+			{
+				statsBuffers[i] = std::make_unique<VulkanStorageBuffer>(device, sizeof(uint32_t), 0, hostFlags);
+				std::memset(statsBuffers[i]->GetMappedData(), 0, sizeof(uint32_t));
+			}
+		}
+
+		drawCommandBuffer = std::make_unique<VulkanStorageBuffer>(device, capacity * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		lateCommandBuffer = std::make_unique<VulkanStorageBuffer>(device, capacity * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+
+	void VulkanHiZCuller::UpdateDescriptorSets(VulkanImage* depthImage)
+	{
+		std::array<VkDescriptorImageInfo, MaxMipCount * 2 + 1> imageInfos{};
+		std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+		std::array<VkWriteDescriptorSet, MaxMipCount * 2 + 5> descriptorWrites{};
+		uint32_t writeCount = 0;
+
+		auto addWrite = [&](VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+			{
+				VkWriteDescriptorSet& write = descriptorWrites[writeCount++];
+				write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				write.dstSet = set;
+				write.dstBinding = binding;
+				write.dstArrayElement = 0;
+				write.descriptorType = type;
+				write.descriptorCount = 1;
+				write.pImageInfo = imageInfo;
+				write.pBufferInfo = bufferInfo;
+			};
+
+		for (uint32_t level = 0; level < mipCount; ++level)
+		{
+			VkDescriptorSet set = reduceDescriptorSets[currentFrame * MaxMipCount + level];
+
+			VkDescriptorImageInfo& inputInfo = imageInfos[level * 2];
+			inputInfo.sampler = sampler;
+			if (level == 0)
+			{
+				inputInfo.imageView = depthImage->GetImageView();
+				inputInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+			}
+			else
+			{
+				inputInfo.imageView = pyramidMipViews[level - 1];
+				inputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			}
+
+			VkDescriptorImageInfo& outputInfo = imageInfos[level * 2 + 1];
+			outputInfo.imageView = pyramidMipViews[level];
+			outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			addWrite(set, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &inputInfo, nullptr);
+			addWrite(set, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &outputInfo, nullptr);
+		}
+
+		VkDescriptorSet cullSet = cullDescriptorSets[currentFrame];
+
+		VkDescriptorImageInfo& pyramidInfo = imageInfos[MaxMipCount * 2];
+		pyramidInfo.sampler = sampler;
+		pyramidInfo.imageView = pyramidView;
+		pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		bufferInfos[0] = { objectBuffers[currentFrame]->Get(), 0, VK_WHOLE_SIZE };
+		bufferInfos[1] = { drawCommandBuffer->Get(), 0, VK_WHOLE_SIZE };
+		bufferInfos[2] = { statsBuffers[currentFrame]->Get(), 0, VK_WHOLE_SIZE };
+		bufferInfos[3] = { lateCommandBuffer->Get(), 0, VK_WHOLE_SIZE };
+
+		addWrite(cullSet, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &pyramidInfo, nullptr);
+		for (uint32_t i = 0; i < bufferInfos.size(); ++i)
+			addWrite(cullSet, i + 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &bufferInfos[i]);
+
+		vkUpdateDescriptorSets(device->GetLogical(), writeCount, descriptorWrites.data(), 0, nullptr);
+	}
+}
\ No newline at end of file
@@ -10,7 +10,7 @@ namespace Nightbird
 	VulkanImage::VulkanImage(VulkanDevice* device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImageAspectFlags aspectFlags)
 		: device(device), format(format), ownsImage(true)
 	{
-		CreateImage(width, height, format, VK_IMAGE_TILING_OPTIMAL, usageFlags, propertyFlags, image, memory);
+		CreateImage(width, height, format, VK_IMAGE_TILING_OPTIMAL, usageFlags, propertyFlags);
 		CreateImageView(aspectFlags);
 	}
 
@@ -27,13 +27,8 @@ namespace Nightbird
 		if (imageView != VK_NULL_HANDLE)
 			vkDestroyImageView(logicalDevice, imageView, nullptr);
 
-		if (ownsImage)
-		{
-			if (image != VK_NULL_HANDLE)
-				vkDestroyImage(logicalDevice, image, nullptr);
-			if (memory != VK_NULL_HANDLE)
-				vkFreeMemory(logicalDevice, memory, nullptr);
-		}
+		if (ownsImage && image != VK_NULL_HANDLE)
+			vmaDestroyImage(device->GetAllocator(), image, allocation);
 	}
 
 	VkImage VulkanImage::Get() const
@@ -46,10 +41,18 @@ namespace Nightbird
 		return imageView;
 	}
 
-	void VulkanImage::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImage& image, VkDeviceMemory& imageMemory)
+	VkFormat VulkanImage::GetFormat() const
 	{
-		VkDevice logicalDevice = device->GetLogical();
+		return format;
+	}
 
+	VkDeviceSize VulkanImage::GetMemorySize() const
+	{
+		return memorySize;
+	}
+
+	void VulkanImage::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags)
+	{
 		VkImageCreateInfo imageInfo{};
 		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 		imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -65,27 +68,20 @@ namespace Nightbird
 		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageInfo.flags = 0;
 
-		if (vkCreateImage(logicalDevice, &imageInfo, nullptr, &image) != VK_SUCCESS)
-		{
-			std::cerr << "Failed to create image" << std::endl;
-			return;
-		}
+		// Allocated through VMA so images are counted in the heap budgets alongside buffers
+		VmaAllocationCreateInfo allocationInfo{};
+		allocationInfo.usage = VMA_MEMORY_USAGE_AUTO;
+		allocationInfo.requiredFlags = propertyFlags;
 
-		VkMemoryRequirements memoryRequirements;
-		vkGetImageMemoryRequirements(logicalDevice, image, &memoryRequirements);
-
-		VkMemoryAllocateInfo allocateInfo{};
-		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocateInfo.allocationSize = memoryRequirements.size;
-		allocateInfo.memoryTypeIndex = device->FindMemoryType(memoryRequirements.memoryTypeBits, propertyFlags);
-
-		if (vkAllocateMemory(logicalDevice, &allocateInfo, nullptr, &imageMemory) != VK_SUCCESS)
+		VmaAllocationInfo allocationResult{};
+		if (vmaCreateImage(device->GetAllocator(), &imageInfo, &allocationInfo, &image, &allocation, &allocationResult) != VK_SUCCESS)
 		{
-			std::cerr << "Failed to allocate image memory" << std::endl;
+			std::cerr << "Failed to create image" << std::endl;
+			image = VK_NULL_HANDLE;
 			return;
 		}
 
-		vkBindImageMemory(logicalDevice, image, imageMemory, 0);
+		memorySize = allocationResult.size;
 	}
 
 	void VulkanImage::CreateImageView(VkImageAspectFlags aspectFlags)
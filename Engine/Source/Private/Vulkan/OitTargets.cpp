@@ -0,0 +1,87 @@
+#include <Vulkan/OitTargets.h>
+
+#include <iostream>
+#include <array>
+
+#include <Vulkan/Device.h>
+#include <Vulkan/Image.h>
+
+namespace Nightbird
+{
+	VulkanOitTargets::VulkanOitTargets(VulkanDevice* device, uint32_t width, uint32_t height, VkDescriptorSetLayout compositeDescriptorSetLayout, VkDescriptorPool descriptorPool)
+		: descriptorPool(descriptorPool), device(device)
+	{
+		// Only live inside the render pass, so tile based GPUs can keep them on chip
+		VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+		accumImage = std::make_unique<VulkanImage>(device, width, height, ACCUM_FORMAT, usageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+		revealageImage = std::make_unique<VulkanImage>(device, width, height, REVEALAGE_FORMAT, usageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+		CreateCompositeDescriptorSet(compositeDescriptorSetLayout);
+	}
+
+	VulkanOitTargets::~VulkanOitTargets()
+	{
+		if (compositeDescriptorSet != VK_NULL_HANDLE)
+			vkFreeDescriptorSets(device->GetLogical(), descriptorPool, 1, &compositeDescriptorSet);
+	}
+
+	VkImageView VulkanOitTargets::GetAccumImageView() const
+	{
+		return accumImage->GetImageView();
+	}
+
+	VkImageView VulkanOitTargets::GetRevealageImageView() const
+	{
+		return revealageImage->GetImageView();
+	}
+
+	VkDescriptorSet VulkanOitTargets::GetCompositeDescriptorSet() const
+	{
+		return compositeDescriptorSet;
+	}
+
+	void VulkanOitTargets::CreateCompositeDescriptorSet(VkDescriptorSetLayout compositeDescriptorSetLayout)
+	{
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &compositeDescriptorSetLayout;
+
+		if (vkAllocateDescriptorSets(device->GetLogical(), &allocInfo, &compositeDescriptorSet) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to allocate OIT composite descriptor set" << std::endl;
+			compositeDescriptorSet = VK_NULL_HANDLE;
+			return;
+		}
+
+		VkDescriptorImageInfo accumInfo{};
+		accumInfo.imageView = accumImage->GetImageView();
+		accumInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkDescriptorImageInfo revealageInfo{};
+		revealageInfo.imageView = revealageImage->GetImageView();
+		revealageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+
+		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[0].dstSet = compositeDescriptorSet;
+		descriptorWrites[0].dstBinding = 0;
+		descriptorWrites[0].dstArrayElement = 0;
+		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		descriptorWrites[0].descriptorCount = 1;
+		descriptorWrites[0].pImageInfo = &accumInfo;
+
+		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[1].dstSet = compositeDescriptorSet;
+		descriptorWrites[1].dstBinding = 1;
+		descriptorWrites[1].dstArrayElement = 0;
+		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		descriptorWrites[1].descriptorCount = 1;
+		descriptorWrites[1].pImageInfo = &revealageInfo;
+
+		vkUpdateDescriptorSets(device->GetLogical(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+	}
+}
\ No newline at end of file
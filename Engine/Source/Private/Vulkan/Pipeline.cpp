@@ -12,6 +12,7 @@
 #include <Core/Mesh.h>
 #include <Core/MeshPrimitive.h>
 #include <Core/Camera.h>
+#include <Core/ShaderVariant.h>
 #include <Vulkan/Device.h>
 #include <Vulkan/SwapChain.h>
 #include <Vulkan/RenderPass.h>
@@ -23,12 +24,17 @@ namespace Nightbird
 	VulkanPipeline::VulkanPipeline(VulkanDevice* device, VulkanRenderPass* renderPass, VulkanDescriptorSetLayoutManager* descriptorSetLayoutManager, GlobalDescriptorSetManager* globalDescriptorSetManager, PipelineType type, bool doubleSided)
 		: device(device), renderPass(renderPass), globalDescriptorSetManager(globalDescriptorSetManager), type(type), doubleSided(doubleSided)
 	{
-		CreateGraphicsPipeline(descriptorSetLayoutManager);
+		CreatePipelineLayout(descriptorSetLayoutManager);
+
+		// Fully featured variant up front, simpler ones are created as materials and lights need them
+		GetVariant(ShaderVariant::All);
 	}
 
 	VulkanPipeline::~VulkanPipeline()
 	{
-		vkDestroyPipeline(device->GetLogical(), pipeline, nullptr);
+		for (const auto& [key, variant] : variants)
+			vkDestroyPipeline(device->GetLogical(), variant, nullptr);
+
 		vkDestroyPipelineLayout(device->GetLogical(), pipelineLayout, nullptr);
 	}
 
@@ -37,17 +43,110 @@ namespace Nightbird
 		descriptorPool = pool;
 	}
 
-	void VulkanPipeline::CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* descriptorSetLayoutManager)
+	bool VulkanPipeline::UsesShaderVariants() const
 	{
-		Shader vertShader(device->GetLogical(), "Assets/Shaders/Vert.spv", VK_SHADER_STAGE_VERTEX_BIT);
-		Shader fragShader(device->GetLogical(), "Assets/Shaders/Frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
+		// Only pipelines running Shader.frag have the specialization constants
+		return type != PipelineType::DepthPrepass && type != PipelineType::TransparentComposite;
+	}
 
-		VkPipelineShaderStageCreateInfo shaderStages[] =
+	VkPipeline VulkanPipeline::GetVariant(uint32_t variantKey)
+	{
+		variantKey = UsesShaderVariants() ? variantKey & ShaderVariant::All : 0;
+
+		auto it = variants.find(variantKey);
+		if (it != variants.end())
+			return it->second;
+
+		VkPipeline variant = CreateGraphicsPipeline(variantKey);
+		variants[variantKey] = variant;
+		return variant;
+	}
+
+	void VulkanPipeline::CreatePipelineLayout(VulkanDescriptorSetLayoutManager* descriptorSetLayoutManager)
+	{
+		// The depth pre-pass shares the full layout so set 2 can simply be left unbound
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts =
 		{
-			vertShader.GetStageCreateInfo(),
-			fragShader.GetStageCreateInfo()
+			descriptorSetLayoutManager->GetGlobalDescriptorSetLayout(),
+			descriptorSetLayoutManager->GetMeshDescriptorSetLayout(),
+			descriptorSetLayoutManager->GetMaterialDescriptorSetLayout()
 		};
 
+		if (type == PipelineType::TransparentComposite)
+			descriptorSetLayouts = { descriptorSetLayoutManager->GetOitCompositeDescriptorSetLayout() };
+
+		VkPushConstantRange vertexDecodeRange{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexDecode) };
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = (uint32_t)descriptorSetLayouts.size();
+		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = type == PipelineType::TransparentComposite ? 0 : 1;
+		pipelineLayoutInfo.pPushConstantRanges = &vertexDecodeRange;
+
+		if (vkCreatePipelineLayout(device->GetLogical(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create pipeline layout" << std::endl;
+		}
+	}
+
+	VkPipeline VulkanPipeline::CreateGraphicsPipeline(uint32_t variantKey)
+	{
+		bool depthOnly = type == PipelineType::DepthPrepass;
+		bool fullscreen = type == PipelineType::TransparentComposite;
+
+		const char* vertPath = "Assets/Shaders/Vert.spv";
+		const char* fragPath = "Assets/Shaders/Frag.spv";
+
+		if (depthOnly)
+		{
+			vertPath = "Assets/Shaders/DepthVert.spv";
+			fragPath = nullptr;
+		}
+		else if (type == PipelineType::TransparentAccumulate)
+		{
+			fragPath = "Assets/Shaders/FragOit.spv";
+		}
+		else if (fullscreen)
+		{
+			vertPath = "Assets/Shaders/FullscreenVert.spv";
+			fragPath = "Assets/Shaders/OitCompositeFrag.spv";
+		}
+
+		Shader vertShader(device->GetLogical(), vertPath, VK_SHADER_STAGE_VERTEX_BIT);
+
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages = { vertShader.GetStageCreateInfo() };
+
+		// One VkBool32 per ShaderVariant bit, constant_id matching the bit index
+		std::array<VkBool32, ShaderVariant::Count> specializationData{};
+		std::array<VkSpecializationMapEntry, ShaderVariant::Count> specializationEntries{};
+
+		for (uint32_t i = 0; i < ShaderVariant::Count; i++)
+		{
+			specializationData[i] = (variantKey & (1u << i)) ? VK_TRUE : VK_FALSE;
+			specializationEntries[i].constantID = i;
+			specializationEntries[i].offset = i * sizeof(VkBool32);
+			specializationEntries[i].size = sizeof(VkBool32);
+		}
+
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+		specializationInfo.pMapEntries = specializationEntries.data();
+		specializationInfo.dataSize = sizeof(specializationData);
+		specializationInfo.pData = specializationData.data();
+
+		std::unique_ptr<Shader> fragShader;
+		if (fragPath)
+		{
+			fragShader = std::make_unique<Shader>(device->GetLogical(), fragPath, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+			VkPipelineShaderStageCreateInfo fragStageInfo = fragShader->GetStageCreateInfo();
+			if (UsesShaderVariants())
+				fragStageInfo.pSpecializationInfo = &specializationInfo;
+
+			shaderStages.push_back(fragStageInfo);
+		}
+
 		std::vector<VkDynamicState> dynamicStates =
 		{
 			VK_DYNAMIC_STATE_VIEWPORT,
@@ -59,14 +158,15 @@ namespace Nightbird
 		dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 		dynamicStateInfo.pDynamicStates = dynamicStates.data();
 
-		auto bindingDescription = Vertex::GetBindingDescription();
+		auto bindingDescriptions = Vertex::GetBindingDescriptions();
 		auto attributeDescriptions = Vertex::GetAttributeDescriptions();
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+		// Depth pre-pass only reads the position attribute (location 0, binding 0), the fullscreen triangle has no vertex input
+		vertexInputInfo.vertexBindingDescriptionCount = fullscreen ? 0 : depthOnly ? 1 : static_cast<uint32_t>(bindingDescriptions.size());
+		vertexInputInfo.vertexAttributeDescriptionCount = fullscreen ? 0 : depthOnly ? 1 : static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
 		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
@@ -85,7 +185,7 @@ namespace Nightbird
 		rasterizationStateInfo.rasterizerDiscardEnable = VK_FALSE;
 		rasterizationStateInfo.polygonMode = VK_POLYGON_MODE_FILL;
 		rasterizationStateInfo.lineWidth = 1.0f;
-		rasterizationStateInfo.cullMode = doubleSided ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
+		rasterizationStateInfo.cullMode = doubleSided || fullscreen ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
 		rasterizationStateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
 		rasterizationStateInfo.depthBiasEnable = VK_FALSE;
 		rasterizationStateInfo.depthBiasConstantFactor = 0.0f;
@@ -103,8 +203,8 @@ namespace Nightbird
 
 		VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
 		depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencilInfo.depthTestEnable = VK_TRUE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+		depthStencilInfo.depthTestEnable = fullscreen ? VK_FALSE : VK_TRUE;
+		depthStencilInfo.depthCompareOp = type == PipelineType::OpaqueDepthEqual ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS;
 		depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
 		depthStencilInfo.minDepthBounds = 0.0f;
 		depthStencilInfo.maxDepthBounds = 1.0f;
@@ -112,19 +212,21 @@ namespace Nightbird
 		depthStencilInfo.front = {};
 		depthStencilInfo.back = {};
 		
-		if (type == PipelineType::Opaque)
+		if (type == PipelineType::Opaque || type == PipelineType::DepthPrepass)
 		{
 			depthStencilInfo.depthWriteEnable = VK_TRUE;
 		}
-		else if (type == PipelineType::Transparent)
+		else
 		{
 			depthStencilInfo.depthWriteEnable = VK_FALSE;
 		}
 
+		std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachmentStates;
+
 		VkPipelineColorBlendAttachmentState colorBlendAttachmentState{};
-		colorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachmentState.colorWriteMask = depthOnly ? 0 : VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 		
-		if (type == PipelineType::Opaque)
+		if (type == PipelineType::Opaque || type == PipelineType::OpaqueDepthEqual || type == PipelineType::DepthPrepass)
 		{
 			colorBlendAttachmentState.blendEnable = VK_FALSE;
 		}
@@ -138,40 +240,60 @@ namespace Nightbird
 			colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
 			colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
 		}
+		else if (type == PipelineType::TransparentAccumulate)
+		{
+			// Accumulation sums weighted premultiplied color, revealage multiplies by (1 - alpha)
+			colorBlendAttachmentState.blendEnable = VK_TRUE;
+			colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+			colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+
+			VkPipelineColorBlendAttachmentState revealageBlendAttachmentState{};
+			revealageBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT;
+			revealageBlendAttachmentState.blendEnable = VK_TRUE;
+			revealageBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+			revealageBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+			revealageBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+			revealageBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			revealageBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			revealageBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+
+			colorBlendAttachmentStates.push_back(colorBlendAttachmentState);
+			colorBlendAttachmentStates.push_back(revealageBlendAttachmentState);
+		}
+		else if (type == PipelineType::TransparentComposite)
+		{
+			// Composite outputs alpha as (1 - revealage) and blends the average color over the opaque result
+			colorBlendAttachmentState.blendEnable = VK_TRUE;
+			colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+			colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+		}
+
+		if (colorBlendAttachmentStates.empty())
+			colorBlendAttachmentStates.push_back(colorBlendAttachmentState);
 
 		VkPipelineColorBlendStateCreateInfo colorBlendStateInfo{};
 		colorBlendStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 		colorBlendStateInfo.logicOpEnable = VK_FALSE;
 		colorBlendStateInfo.logicOp = VK_LOGIC_OP_COPY;
-		colorBlendStateInfo.attachmentCount = 1;
-		colorBlendStateInfo.pAttachments = &colorBlendAttachmentState;
+		colorBlendStateInfo.attachmentCount = static_cast<uint32_t>(colorBlendAttachmentStates.size());
+		colorBlendStateInfo.pAttachments = colorBlendAttachmentStates.data();
 		colorBlendStateInfo.blendConstants[0] = 0.0f;
 		colorBlendStateInfo.blendConstants[1] = 0.0f;
 		colorBlendStateInfo.blendConstants[2] = 0.0f;
 		colorBlendStateInfo.blendConstants[3] = 0.0f;
 
-		std::array<VkDescriptorSetLayout, 3> descriptorSetLayouts =
-		{
-			descriptorSetLayoutManager->GetGlobalDescriptorSetLayout(),
-			descriptorSetLayoutManager->GetMeshDescriptorSetLayout(),
-			descriptorSetLayoutManager->GetMaterialDescriptorSetLayout()
-		};
-
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = (uint32_t)descriptorSetLayouts.size();
-		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pPushConstantRanges = nullptr;
-
-		if (vkCreatePipelineLayout(device->GetLogical(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
-		{
-			std::cerr << "Failed to create pipeline layout" << std::endl;
-		}
-
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
-		pipelineInfo.pStages = shaderStages;
+		pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+		pipelineInfo.pStages = shaderStages.data();
 		pipelineInfo.pInputAssemblyState = &inputAssemblyInfo;
 		pipelineInfo.pVertexInputState = &vertexInputInfo;
 		pipelineInfo.pViewportState = &viewportStateInfo;
@@ -182,54 +304,105 @@ namespace Nightbird
 		pipelineInfo.pDynamicState = &dynamicStateInfo;
 		pipelineInfo.layout = pipelineLayout;
 		pipelineInfo.renderPass = renderPass->Get();
-		pipelineInfo.subpass = 0;
+		pipelineInfo.subpass = GetSubpass();
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 		pipelineInfo.basePipelineIndex = -1;
 
+		VkPipeline pipeline = VK_NULL_HANDLE;
 		if (vkCreateGraphicsPipelines(device->GetLogical(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
 		{
 			std::cerr << "Failed to create graphics pipeline" << std::endl;
 		}
+
+		return pipeline;
 	}
 
-	void VulkanPipeline::Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<Renderable>& renderables, Camera* camera)
+	uint32_t VulkanPipeline::GetBoundDescriptorSetCount() const
 	{
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		// Depth pre-pass has no material inputs
+		return type == PipelineType::DepthPrepass ? 2 : 3;
+	}
+
+	uint32_t VulkanPipeline::GetSubpass() const
+	{
+		if (type == PipelineType::TransparentAccumulate)
+			return RenderSubpass::TransparentAccumulate;
+
+		if (type == PipelineType::TransparentComposite)
+			return RenderSubpass::TransparentComposite;
+
+		return RenderSubpass::Scene;
+	}
+
+	void VulkanPipeline::Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<Renderable>& renderables, Camera* camera, uint32_t sceneVariantKey)
+	{
+		VkPipeline boundPipeline = VK_NULL_HANDLE;
 		
 		for (const auto& renderable : renderables)
 		{
-			VkBuffer vertexBuffers[] = {renderable.primitive->vertexBuffer->Get()};
-			VkDeviceSize offsets[] = {0};
-			
-			// Bind vertex and index buffers of mesh
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(commandBuffer, renderable.primitive->indexBuffer->Get(), 0, VK_INDEX_TYPE_UINT16);
+			// Variants share the layout, so bound descriptor sets stay valid across switches
+			VkPipeline variant = GetVariant(renderable.primitive->GetShaderVariantKey() | sceneVariantKey);
+			if (variant != boundPipeline)
+			{
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, variant);
+				boundPipeline = variant;
+			}
+
+			BindPrimitive(commandBuffer, renderable.primitive);
 			
 			// Bind camera (view & proj matrices) and mesh (model matrix & textures) descriptor sets
 			std::array<VkDescriptorSet, 3> descriptorSets = {globalDescriptorSetManager->GetDescriptorSets()[currentFrame], renderable.instance->GetUniformDescriptorSets()[currentFrame], renderable.primitive->GetMaterialDescriptorSets()[currentFrame]};
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, GetBoundDescriptorSetCount(), descriptorSets.data(), 0, nullptr);
 			
 			// Draw the mesh
-			vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(renderable.primitive->GetIndicesSize()), 1, 0, 0, 0);
+			const MeshLod& lod = renderable.primitive->GetLod(renderable.lod);
+			if (renderable.indirectBuffer != VK_NULL_HANDLE)
+				vkCmdDrawIndexedIndirect(commandBuffer, renderable.indirectBuffer, renderable.indirectOffset, 1, sizeof(VkDrawIndexedIndirectCommand));
+			else
+				vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
 		}
 	}
 
-	void VulkanPipeline::RenderSingle(VkCommandBuffer commandBuffer, uint32_t currentFrame, const Renderable& renderable, Camera* camera)
+	void VulkanPipeline::RenderSingle(VkCommandBuffer commandBuffer, uint32_t currentFrame, const Renderable& renderable, Camera* camera, uint32_t sceneVariantKey)
 	{
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, GetVariant(renderable.primitive->GetShaderVariantKey() | sceneVariantKey));
 		
-		VkBuffer vertexBuffers[] = {renderable.primitive->vertexBuffer->Get()};
-		VkDeviceSize offsets[] = {0};
-		
-		// Bind vertex and index buffers of mesh
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-		vkCmdBindIndexBuffer(commandBuffer, renderable.primitive->indexBuffer->Get(), 0, VK_INDEX_TYPE_UINT16);
+		BindPrimitive(commandBuffer, renderable.primitive);
 
 		// Bind camera (view & proj matrices) and mesh (model matrix & textures) descriptor sets
 		std::array<VkDescriptorSet, 3> descriptorSets = {globalDescriptorSetManager->GetDescriptorSets()[currentFrame], renderable.instance->GetUniformDescriptorSets()[currentFrame], renderable.primitive->GetMaterialDescriptorSets()[currentFrame]};
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, GetBoundDescriptorSetCount(), descriptorSets.data(), 0, nullptr);
 
 		// Draw the mesh
-		vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(renderable.primitive->GetIndicesSize()), 1, 0, 0, 0);
+		const MeshLod& lod = renderable.primitive->GetLod(renderable.lod);
+		if (renderable.indirectBuffer != VK_NULL_HANDLE)
+			vkCmdDrawIndexedIndirect(commandBuffer, renderable.indirectBuffer, renderable.indirectOffset, 1, sizeof(VkDrawIndexedIndirectCommand));
+		else
+			vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
+	}
+
+	void VulkanPipeline::BindPrimitive(VkCommandBuffer commandBuffer, const MeshPrimitive* primitive)
+	{
+		VkBuffer vertexBuffer = primitive->vertexBuffer->Get();
+		const auto& texCoordOffsets = primitive->GetTexCoordOffsets();
+
+		// Packed positions and normals, then one stream per texture coordinate set
+		VkBuffer vertexBuffers[] = { vertexBuffer, vertexBuffer, vertexBuffer, vertexBuffer };
+		VkDeviceSize offsets[] = { 0, texCoordOffsets[0], texCoordOffsets[1], texCoordOffsets[2] };
+
+		// Bind vertex and index buffers of mesh
+		vkCmdBindVertexBuffers(commandBuffer, 0, 4, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, primitive->indexBuffer->Get(), 0, primitive->GetIndexType());
+
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexDecode), &primitive->GetVertexDecode());
+	}
+
+	void VulkanPipeline::RenderFullscreen(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, GetVariant(0));
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+		// Single triangle covering the screen, generated in the vertex shader
+		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 	}
 }
\ No newline at end of file
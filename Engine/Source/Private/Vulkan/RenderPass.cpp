@@ -4,18 +4,21 @@
 #include <array>
 
 #include <Vulkan/Device.h>
+#include <Vulkan/OitTargets.h>
 
 namespace Nightbird
 {
 	VulkanRenderPass::VulkanRenderPass(VulkanDevice* device, VkFormat colorFormat, VkFormat depthFormat, VkImageLayout finalColorLayout)
 		: device(device)
 	{
-		Create(colorFormat, depthFormat, finalColorLayout);
+		renderPass = Create(colorFormat, depthFormat, finalColorLayout, false);
+		resumeRenderPass = Create(colorFormat, depthFormat, finalColorLayout, true);
 	}
 
 	VulkanRenderPass::~VulkanRenderPass()
 	{
 		vkDestroyRenderPass(device->GetLogical(), renderPass, nullptr);
+		vkDestroyRenderPass(device->GetLogical(), resumeRenderPass, nullptr);
 	}
 
 	VkRenderPass VulkanRenderPass::Get() const
@@ -24,22 +27,35 @@ namespace Nightbird
 	}
 
 	void VulkanRenderPass::Begin(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent)
+	{
+		BeginPass(commandBuffer, renderPass, framebuffer, extent);
+	}
+
+	void VulkanRenderPass::Resume(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent)
+	{
+		BeginPass(commandBuffer, resumeRenderPass, framebuffer, extent);
+	}
+
+	void VulkanRenderPass::BeginPass(VkCommandBuffer commandBuffer, VkRenderPass pass, VkFramebuffer framebuffer, VkExtent2D extent)
 	{
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = renderPass;
+		renderPassInfo.renderPass = pass;
 		renderPassInfo.framebuffer = framebuffer;
 		renderPassInfo.renderArea.offset = {0, 0};
 		renderPassInfo.renderArea.extent = extent;
 
-		std::array<VkClearValue, 2> clearValues{};
+		std::array<VkClearValue, 4> clearValues{};
 		clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
 		clearValues[1].depthStencil = {1.0f, 0};
+		clearValues[2].color = {0.0f, 0.0f, 0.0f, 0.0f};
+		clearValues[3].color = {1.0f, 0.0f, 0.0f, 0.0f};
 
 		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderPassInfo.pClearValues = clearValues.data();
 
 		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		currentSubpass = RenderSubpass::Scene;
 
 		VkViewport viewport{};
 		viewport.x = 0.0f;
@@ -56,8 +72,17 @@ namespace Nightbird
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 	}
 
+	void VulkanRenderPass::NextSubpass(VkCommandBuffer commandBuffer)
+	{
+		vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+		currentSubpass++;
+	}
+
 	void VulkanRenderPass::End(VkCommandBuffer commandBuffer)
 	{
+		while (currentSubpass + 1 < RenderSubpass::Count)
+			NextSubpass(commandBuffer);
+
 		vkCmdEndRenderPass(commandBuffer);
 	}
 
@@ -83,16 +108,16 @@ namespace Nightbird
 		}
 	}
 
-	void VulkanRenderPass::Create(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout finalColorLayout)
+	VkRenderPass VulkanRenderPass::Create(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout finalColorLayout, bool resume)
 	{
 		VkAttachmentDescription colorAttachment{};
 		colorAttachment.format = colorFormat;
 		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
 		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachment.initialLayout = resume ? finalColorLayout : VK_IMAGE_LAYOUT_UNDEFINED;
 		colorAttachment.finalLayout = finalColorLayout;
 
 		VkAttachmentReference colorAttachmentRef{};
@@ -102,44 +127,119 @@ namespace Nightbird
 		VkAttachmentDescription depthAttachment{};
 		depthAttachment.format = depthFormat;
 		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+		// Kept after the pass, the GPU occlusion test builds its depth pyramid from it
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.initialLayout = resume ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
 		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference depthAttachmentRef{};
 		depthAttachmentRef.attachment = 1;
 		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-		VkSubpassDescription subpass{};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorAttachmentRef;
-		subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-		VkSubpassDependency dependency{};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-		std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
+		// Weighted blended OIT targets, cleared to zero accumulation and full revealage
+		VkAttachmentDescription accumAttachment{};
+		accumAttachment.format = VulkanOitTargets::ACCUM_FORMAT;
+		accumAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		accumAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		accumAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		accumAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		accumAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		accumAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		accumAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkAttachmentDescription revealageAttachment = accumAttachment;
+		revealageAttachment.format = VulkanOitTargets::REVEALAGE_FORMAT;
+
+		std::array<VkAttachmentReference, 2> oitColorAttachmentRefs{};
+		oitColorAttachmentRefs[0].attachment = 2;
+		oitColorAttachmentRefs[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		oitColorAttachmentRefs[1].attachment = 3;
+		oitColorAttachmentRefs[1].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		std::array<VkAttachmentReference, 2> oitInputAttachmentRefs{};
+		oitInputAttachmentRefs[0].attachment = 2;
+		oitInputAttachmentRefs[0].layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		oitInputAttachmentRefs[1].attachment = 3;
+		oitInputAttachmentRefs[1].layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		uint32_t preservedColorAttachment = 0;
+
+		std::array<VkSubpassDescription, RenderSubpass::Count> subpasses{};
+
+		subpasses[RenderSubpass::Scene].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[RenderSubpass::Scene].colorAttachmentCount = 1;
+		subpasses[RenderSubpass::Scene].pColorAttachments = &colorAttachmentRef;
+		subpasses[RenderSubpass::Scene].pDepthStencilAttachment = &depthAttachmentRef;
+
+		subpasses[RenderSubpass::TransparentAccumulate].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[RenderSubpass::TransparentAccumulate].colorAttachmentCount = static_cast<uint32_t>(oitColorAttachmentRefs.size());
+		subpasses[RenderSubpass::TransparentAccumulate].pColorAttachments = oitColorAttachmentRefs.data();
+		subpasses[RenderSubpass::TransparentAccumulate].pDepthStencilAttachment = &depthAttachmentRef;
+		subpasses[RenderSubpass::TransparentAccumulate].preserveAttachmentCount = 1;
+		subpasses[RenderSubpass::TransparentAccumulate].pPreserveAttachments = &preservedColorAttachment;
+
+		subpasses[RenderSubpass::TransparentComposite].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[RenderSubpass::TransparentComposite].inputAttachmentCount = static_cast<uint32_t>(oitInputAttachmentRefs.size());
+		subpasses[RenderSubpass::TransparentComposite].pInputAttachments = oitInputAttachmentRefs.data();
+		subpasses[RenderSubpass::TransparentComposite].colorAttachmentCount = 1;
+		subpasses[RenderSubpass::TransparentComposite].pColorAttachments = &colorAttachmentRef;
+
+		std::array<VkSubpassDependency, 4> dependencies{};
+
+		// Also orders a resumed pass after the attachment writes of the first, both passes need it identical to stay compatible
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = RenderSubpass::Scene;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		// Accumulation depth tests against the opaque depth
+		dependencies[1].srcSubpass = RenderSubpass::Scene;
+		dependencies[1].dstSubpass = RenderSubpass::TransparentAccumulate;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+		dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		// Composite reads the accumulation targets as input attachments
+		dependencies[2].srcSubpass = RenderSubpass::TransparentAccumulate;
+		dependencies[2].dstSubpass = RenderSubpass::TransparentComposite;
+		dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[2].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		dependencies[2].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+		dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		// Composite blends over the opaque color
+		dependencies[3].srcSubpass = RenderSubpass::Scene;
+		dependencies[3].dstSubpass = RenderSubpass::TransparentComposite;
+		dependencies[3].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[3].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[3].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[3].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[3].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		std::array<VkAttachmentDescription, 4> attachments = {colorAttachment, depthAttachment, accumAttachment, revealageAttachment};
 		VkRenderPassCreateInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
 		renderPassInfo.pAttachments = attachments.data();
-		renderPassInfo.subpassCount = 1;
-		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+		renderPassInfo.pSubpasses = subpasses.data();
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
 
-		if (vkCreateRenderPass(device->GetLogical(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+		VkRenderPass pass = VK_NULL_HANDLE;
+		if (vkCreateRenderPass(device->GetLogical(), &renderPassInfo, nullptr, &pass) != VK_SUCCESS)
 		{
 			std::cerr << "Failed to create render pass" << std::endl;
 		}
+
+		return pass;
 	}
 }
\ No newline at end of file
@@ -47,6 +47,11 @@ namespace Nightbird
 		return depthFormat;
 	}
 
+	VulkanImage* VulkanSwapChain::GetDepthImage() const
+	{
+		return depthImage;
+	}
+
 	void VulkanSwapChain::CreateSwapChain()
 	{
 		VkDevice logicalDevice = device->GetLogical();
@@ -135,21 +140,22 @@ namespace Nightbird
 	void VulkanSwapChain::CreateDepthResources()
 	{
 		depthFormat = FindDepthFormat(device->GetPhysical());
-		depthImage = new VulkanImage(device, extent.width, extent.height, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+		depthImage = new VulkanImage(device, extent.width, extent.height, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
 		depthImage->TransitionImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 	}
 
-	void VulkanSwapChain::CreateFramebuffers(VkRenderPass renderPass)
+	void VulkanSwapChain::CreateFramebuffers(VkRenderPass renderPass, const std::vector<VkImageView>& sharedAttachments)
 	{
 		framebuffers.resize(images.size());
 
 		for (size_t i = 0; i < images.size(); i++)
 		{
-			std::array<VkImageView, 2> attachments =
+			std::vector<VkImageView> attachments =
 			{
 				images[i]->GetImageView(),
 				depthImage->GetImageView()
 			};
+			attachments.insert(attachments.end(), sharedAttachments.begin(), sharedAttachments.end());
 
 			VkFramebufferCreateInfo framebufferInfo{};
 			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
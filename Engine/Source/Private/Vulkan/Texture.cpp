@@ -1,10 +1,12 @@
 #include <Vulkan/Texture.h>
 
+#include <filesystem>
 #include <iostream>
 
 #include <Vulkan/Device.h>
 #include <Vulkan/Image.h>
 #include <Vulkan/Buffer.h>
+#include <Core/CookedTexture.h>
 
 #include <stb_image.h>
 
@@ -47,6 +49,11 @@ namespace Nightbird
 		delete image;
 	}
 
+	VulkanImage* VulkanTexture::GetImage() const
+	{
+		return image;
+	}
+
 	VkImageView VulkanTexture::GetImageView() const
 	{
 		return image->GetImageView();
@@ -57,6 +64,11 @@ namespace Nightbird
 		return sampler;
 	}
 
+	VkDeviceSize VulkanTexture::GetMemorySize() const
+	{
+		return image->GetMemorySize();
+	}
+
 	void VulkanTexture::TransitionToShaderRead(VkCommandBuffer commandBuffer)
 	{
 		image->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
@@ -69,7 +81,25 @@ namespace Nightbird
 
 	void VulkanTexture::CreateTextureImage(const std::string& path)
 	{
-		stbi_set_flip_vertically_on_load(true);
+		// Cooked by the asset cooker, either next to the source or shipped in its place
+		std::filesystem::path cookedPath = path;
+		if (cookedPath.extension() != CookedTextureExtension)
+			cookedPath += CookedTextureExtension;
+
+		std::error_code error;
+		if (std::filesystem::exists(cookedPath, error))
+		{
+			bool checkSource = cookedPath != path && std::filesystem::exists(path, error);
+
+			CookedTexture cooked;
+			if (ReadCookedTexture(cookedPath, cooked, checkSource ? std::filesystem::path(path) : std::filesystem::path()))
+			{
+				CreateTextureImage(cooked.pixels, static_cast<int>(cooked.width), static_cast<int>(cooked.height), true);
+				return;
+			}
+		}
+
+		stbi_set_flip_vertically_on_load_thread(true);
 
 		int width, height, channels;
 		stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
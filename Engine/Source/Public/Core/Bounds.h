@@ -0,0 +1,54 @@
+#pragma once
+
+#include <limits>
+
+#include <glm/glm.hpp>
+
+namespace Nightbird
+{
+	struct AABB
+	{
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+		bool IsValid() const;
+
+		void Expand(const glm::vec3& point);
+		void Expand(const AABB& other);
+
+		glm::vec3 GetCenter() const;
+		glm::vec3 GetExtents() const;
+
+		AABB Transform(const glm::mat4& matrix) const;
+
+		float DistanceSquared(const glm::vec3& point) const;
+		bool Intersects(const AABB& other) const;
+	};
+
+	struct BoundingSphere
+	{
+		glm::vec3 center = glm::vec3(0.0f);
+		float radius = -1.0f;
+
+		bool IsValid() const;
+
+		// Smallest sphere enclosing both
+		void Expand(const BoundingSphere& other);
+
+		// Conservative under non-uniform scale, the radius grows by the largest axis scale
+		BoundingSphere Transform(const glm::mat4& matrix) const;
+
+		static BoundingSphere FromAABB(const AABB& aabb);
+	};
+
+	struct Frustum
+	{
+		// Normalized planes with normals pointing inward: left, right, bottom, top, near, far
+		glm::vec4 planes[6];
+
+		static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+		bool IntersectsSphere(const glm::vec3& center, float radius) const;
+		bool IntersectsAABB(const AABB& aabb) const;
+	};
+}
\ No newline at end of file
@@ -27,6 +27,8 @@ namespace Nightbird
 		CameraUBO GetUBO(VkExtent2D extent) const;
 		
 		float fov = 70.0f;
+		float nearPlane = 0.01f;
+		float farPlane = 100.0f;
 		
 		RTTR_ENABLE(Nightbird::SpatialObject)
 	};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Nightbird
+{
+	struct Model;
+
+	// Bumped whenever the file layout or the import that produces it changes
+	constexpr uint32_t CookedModelVersion = 2;
+	constexpr const char* CookedModelExtension = ".nbmodel";
+
+	// Identifies the source a cooked file was built from
+	struct CookedSourceInfo
+	{
+		uint64_t size = 0;
+		int64_t writeTime = 0;
+		uint64_t contentHash = 0;
+	};
+
+	// A file the source references, such as a .gltf's buffers and images, path relative to the source's directory
+	struct CookedDependency
+	{
+		std::string path;
+		CookedSourceInfo info;
+	};
+
+	bool GetCookedSourceInfo(const std::filesystem::path& sourcePath, CookedSourceInfo& info);
+
+	// Local files a .gltf references, none for other sources. False when one of them is missing
+	bool GetCookedDependencies(const std::filesystem::path& sourcePath, std::vector<CookedDependency>& dependencies);
+
+	// Size and write time decide when they match, a touched file falls back to comparing the content hash
+	bool IsCookedSourceCurrent(const CookedSourceInfo& cooked, const std::filesystem::path& sourcePath);
+
+	// Needs the imported CPU data, so call it before the model is uploaded
+	bool WriteCookedModel(const Model& model, const CookedSourceInfo& source, const std::vector<CookedDependency>& dependencies, const std::filesystem::path& path);
+
+	// Maps the file and points the model's texture and primitive data into it, null when missing, corrupt or from another version.
+	// With a source path the file is also rejected when that source or one of its dependencies changed since it was cooked
+	std::shared_ptr<Model> ReadCookedModel(const std::filesystem::path& path, const std::filesystem::path& sourcePath = {});
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "Core/CookedModel.h"
+
+namespace Nightbird
+{
+	class MappedFile;
+
+	constexpr uint32_t CookedTextureVersion = 1;
+	constexpr const char* CookedTextureExtension = ".nbtex";
+
+	// RGBA8 pixels of a standalone image, rows stored bottom up like the texture loader expects
+	struct CookedTexture
+	{
+		std::shared_ptr<MappedFile> file;
+		const uint8_t* pixels = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	bool WriteCookedTexture(const uint8_t* pixels, uint32_t width, uint32_t height, const CookedSourceInfo& source, const std::filesystem::path& path);
+
+	// Same rules as ReadCookedModel, false when missing, corrupt, from another version or older than the source
+	bool ReadCookedTexture(const std::filesystem::path& path, CookedTexture& texture, const std::filesystem::path& sourcePath = {});
+}
\ No newline at end of file
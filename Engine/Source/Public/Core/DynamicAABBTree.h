@@ -0,0 +1,288 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "Core/Bounds.h"
+
+namespace Nightbird
+{
+	// Incrementally balanced bounding volume hierarchy, leaves store fattened bounds so small motion needs no tree update
+	class DynamicAABBTree
+	{
+	public:
+		static constexpr int32_t NullNode = -1;
+
+		explicit DynamicAABBTree(float margin = 0.1f);
+
+		int32_t CreateProxy(const AABB& aabb, void* userData, uint32_t category);
+		void DestroyProxy(int32_t proxyId);
+
+		// Returns true when the proxy had to be reinserted
+		bool MoveProxy(int32_t proxyId, const AABB& aabb);
+
+		void* GetUserData(int32_t proxyId) const;
+		uint32_t GetCategory(int32_t proxyId) const;
+		const AABB& GetFatAABB(int32_t proxyId) const;
+
+		size_t GetProxyCount() const;
+		int32_t GetHeight() const;
+
+		void Clear();
+
+		// Callbacks take the proxy id and return false to stop the traversal
+		template<typename Callback>
+		void Query(const AABB& aabb, uint32_t categoryMask, Callback&& callback) const;
+
+		// Subtrees fully inside the frustum are reported without further plane tests
+		template<typename Callback>
+		void Query(const Frustum& frustum, uint32_t categoryMask, Callback&& callback) const;
+
+		// The callback returns the new maximum distance, 0 stops the cast, maxDistance keeps going
+		template<typename Callback>
+		void Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t categoryMask, Callback&& callback) const;
+
+		// Visits leaves nearer child first, the callback returns the new maximum distance like Raycast
+		template<typename Callback>
+		void QueryNearest(const glm::vec3& point, float maxDistance, uint32_t categoryMask, Callback&& callback) const;
+
+	private:
+		// Fixed storage covers any balanced tree, so queries only allocate for degenerate ones
+		template<typename T>
+		class TraversalStack
+		{
+		public:
+			void Push(const T& value)
+			{
+				if (count < Capacity)
+					items[count++] = value;
+				else
+					overflow.push_back(value);
+			}
+
+			T Pop()
+			{
+				if (!overflow.empty())
+				{
+					T value = overflow.back();
+					overflow.pop_back();
+					return value;
+				}
+				return items[--count];
+			}
+
+			bool IsEmpty() const
+			{
+				return count == 0 && overflow.empty();
+			}
+
+		private:
+			static constexpr size_t Capacity = 128;
+
+			T items[Capacity];
+			size_t count = 0;
+			std::vector<T> overflow;
+		};
+
+		struct Node
+		{
+			AABB aabb;
+			void* userData = nullptr;
+			union
+			{
+				int32_t parent;
+				int32_t next;
+			};
+			int32_t child1 = NullNode;
+			int32_t child2 = NullNode;
+			// Leaf = 0, free node = -1
+			int32_t height = -1;
+			// Union of the leaf categories below, lets queries skip whole subtrees
+			uint32_t category = 0;
+
+			bool IsLeaf() const { return child1 == NullNode; }
+		};
+
+		enum class FrustumTest
+		{
+			Outside,
+			Intersect,
+			Inside
+		};
+
+		std::vector<Node> nodes;
+		int32_t root = NullNode;
+		int32_t freeList = NullNode;
+		size_t proxyCount = 0;
+		float margin;
+
+		int32_t AllocateNode();
+		void FreeNode(int32_t nodeId);
+
+		void InsertLeaf(int32_t leaf);
+		void RemoveLeaf(int32_t leaf);
+		void Refit(int32_t nodeId);
+		void UpdateNode(int32_t nodeId);
+		int32_t Balance(int32_t nodeId);
+
+		static float SurfaceArea(const AABB& aabb);
+		static bool Contains(const AABB& outer, const AABB& inner);
+		static AABB Fatten(const AABB& aabb, float amount);
+		static AABB Union(const AABB& a, const AABB& b);
+		static FrustumTest TestFrustum(const Frustum& frustum, const AABB& aabb);
+		static bool RayIntersects(const AABB& aabb, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance);
+	};
+
+	template<typename Callback>
+	void DynamicAABBTree::Query(const AABB& aabb, uint32_t categoryMask, Callback&& callback) const
+	{
+		if (root == NullNode)
+			return;
+
+		TraversalStack<int32_t> stack;
+		stack.Push(root);
+
+		while (!stack.IsEmpty())
+		{
+			int32_t nodeId = stack.Pop();
+
+			const Node& node = nodes[nodeId];
+			if (!(node.category & categoryMask) || !node.aabb.Intersects(aabb))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				if (!callback(nodeId))
+					return;
+				continue;
+			}
+
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+
+	template<typename Callback>
+	void DynamicAABBTree::Query(const Frustum& frustum, uint32_t categoryMask, Callback&& callback) const
+	{
+		if (root == NullNode)
+			return;
+
+		struct Entry
+		{
+			int32_t nodeId;
+			bool inside;
+		};
+
+		TraversalStack<Entry> stack;
+		stack.Push({ root, false });
+
+		while (!stack.IsEmpty())
+		{
+			Entry entry = stack.Pop();
+
+			const Node& node = nodes[entry.nodeId];
+			if (!(node.category & categoryMask))
+				continue;
+
+			bool inside = entry.inside;
+			if (!inside)
+			{
+				FrustumTest test = TestFrustum(frustum, node.aabb);
+				if (test == FrustumTest::Outside)
+					continue;
+				inside = test == FrustumTest::Inside;
+			}
+
+			if (node.IsLeaf())
+			{
+				if (!callback(entry.nodeId))
+					return;
+				continue;
+			}
+
+			stack.Push({ node.child1, inside });
+			stack.Push({ node.child2, inside });
+		}
+	}
+
+	template<typename Callback>
+	void DynamicAABBTree::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t categoryMask, Callback&& callback) const
+	{
+		if (root == NullNode)
+			return;
+
+		glm::vec3 inverseDirection = 1.0f / direction;
+
+		TraversalStack<int32_t> stack;
+		stack.Push(root);
+
+		while (!stack.IsEmpty())
+		{
+			int32_t nodeId = stack.Pop();
+
+			const Node& node = nodes[nodeId];
+			if (!(node.category & categoryMask) || !RayIntersects(node.aabb, origin, inverseDirection, maxDistance))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				float distance = callback(nodeId);
+				if (distance <= 0.0f)
+					return;
+				maxDistance = std::min(maxDistance, distance);
+				continue;
+			}
+
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+
+	template<typename Callback>
+	void DynamicAABBTree::QueryNearest(const glm::vec3& point, float maxDistance, uint32_t categoryMask, Callback&& callback) const
+	{
+		if (root == NullNode)
+			return;
+
+		float maxDistanceSquared = maxDistance * maxDistance;
+
+		TraversalStack<int32_t> stack;
+		stack.Push(root);
+
+		while (!stack.IsEmpty())
+		{
+			int32_t nodeId = stack.Pop();
+
+			const Node& node = nodes[nodeId];
+			if (!(node.category & categoryMask) || node.aabb.DistanceSquared(point) > maxDistanceSquared)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				float distance = callback(nodeId);
+				if (distance <= 0.0f)
+					return;
+				maxDistanceSquared = std::min(maxDistanceSquared, distance * distance);
+				continue;
+			}
+
+			// Pushed last is popped first
+			float distance1 = nodes[node.child1].aabb.DistanceSquared(point);
+			float distance2 = nodes[node.child2].aabb.DistanceSquared(point);
+			if (distance1 < distance2)
+			{
+				stack.Push(node.child2);
+				stack.Push(node.child1);
+			}
+			else
+			{
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -11,10 +11,12 @@
 namespace Nightbird
 {
 	class GlfwWindow;
+	class JobSystem;
 	class ModelManager;
 	class MeshInstance;
 	class Scene;
 	class Renderer;
+	class ResidencyManager;
 	
 	class Engine
 	{
@@ -23,9 +25,11 @@ namespace Nightbird
 		~Engine();
 		
 		GlfwWindow* GetGlfwWindow() const;
+		JobSystem* GetJobSystem() const;
 		Renderer* GetRenderer() const;
 		Scene* GetScene() const;
 		ModelManager* GetModelManager() const;
+		ResidencyManager* GetResidencyManager() const;
 
 		float GetDeltaTime() const;
 		
@@ -34,12 +38,16 @@ namespace Nightbird
 		bool bSimulationRunning = false;
 
 	private:
+		// Declared first so it outlives every system that schedules jobs
+		std::unique_ptr<JobSystem> jobSystem;
+
 		std::unique_ptr<GlfwWindow> glfwWindow;
 
 		std::unique_ptr<Renderer> renderer;
 		
 		std::unique_ptr<Scene> scene;
 		std::unique_ptr<ModelManager> modelManager;
+		std::unique_ptr<ResidencyManager> residencyManager;
 
 		float deltaTime = 0.0f;
 	};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace Nightbird
+{
+	struct Frustum;
+
+	// Batched sphere vs frustum test over SoA arrays, four spheres per step with SSE
+	class FrustumCuller
+	{
+	public:
+		void Clear();
+		void Reserve(size_t count);
+
+		void AddSphere(const glm::vec3& center, float radius);
+
+		size_t GetCount() const;
+
+		// Writes 1 for every sphere that touches the frustum, 0 otherwise, returns the visible count
+		size_t Cull(const Frustum& frustum, std::vector<uint8_t>& visible) const;
+
+	private:
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> radius;
+	};
+}
\ No newline at end of file
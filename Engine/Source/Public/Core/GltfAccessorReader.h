@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <fastgltf/types.hpp>
+
+namespace Nightbird
+{
+	struct Vertex;
+
+	// Bulk reads of glTF accessors into the import arrays. Plain float and unsigned index data is copied straight from the buffer,
+	// sparse, normalized and quantized accessors fall back to fastgltf's per element conversion
+
+	// Fills one member of every vertex, elements past vertices.size() are ignored
+	void ReadVertexAttribute(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<Vertex>& vertices, glm::vec3 Vertex::* member);
+	void ReadVertexAttribute(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<Vertex>& vertices, glm::vec2 Vertex::* member);
+
+	// Appends the accessor widened to 32 bit
+	void ReadIndices(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<uint32_t>& indices);
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Nightbird
+{
+	// Fast 64 bit content hash for cache invalidation, not suitable for anything security related
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+}
\ No newline at end of file
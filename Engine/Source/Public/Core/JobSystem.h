@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Nightbird
+{
+	enum class JobPriority
+	{
+		High,
+		Normal,
+		Low,
+		Count
+	};
+
+	struct JobState;
+
+	class JobHandle
+	{
+	public:
+		JobHandle() = default;
+
+		bool IsValid() const;
+		bool IsDone() const;
+		bool IsCancelled() const;
+
+		// Jobs that have not started are skipped, running jobs can poll JobSystem::IsCurrentJobCancelled
+		void Cancel();
+
+	private:
+		friend class JobSystem;
+
+		explicit JobHandle(std::shared_ptr<JobState> state);
+
+		std::shared_ptr<JobState> state;
+	};
+
+	struct JobWorkerStats
+	{
+		uint64_t jobsExecuted = 0;
+		uint64_t jobsStolen = 0;
+
+		// Busy fraction of the wall time between the last two UpdateStats calls
+		float utilization = 0.0f;
+	};
+
+	// Fixed pool of workers, each owns a deque per priority and steals from the others when empty
+	class JobSystem
+	{
+	public:
+		// 0 uses one worker per hardware thread minus the main thread
+		explicit JobSystem(size_t workerCount = 0);
+		~JobSystem();
+
+		JobHandle Schedule(std::function<void()> job, JobPriority priority = JobPriority::Normal);
+
+		// Runs queued jobs while waiting, so jobs may wait on other jobs without starving the pool
+		void Wait(const JobHandle& handle);
+
+		// Calls function for every index, the calling thread takes part, returns the number of threads that did work
+		size_t ParallelFor(size_t count, const std::function<void(size_t)>& function, JobPriority priority = JobPriority::High);
+
+		static bool IsCurrentJobCancelled();
+
+		size_t GetWorkerCount() const;
+
+		// Call once per frame to sample utilization
+		void UpdateStats();
+		const std::vector<JobWorkerStats>& GetWorkerStats() const;
+
+	private:
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<std::shared_ptr<JobState>> queues[static_cast<size_t>(JobPriority::Count)];
+			std::thread thread;
+
+			std::atomic<uint64_t> busyNanoseconds{ 0 };
+			std::atomic<uint64_t> jobsExecuted{ 0 };
+			std::atomic<uint64_t> jobsStolen{ 0 };
+
+			uint64_t sampledBusyNanoseconds = 0;
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		std::mutex sleepMutex;
+		std::condition_variable workAvailable;
+		// Waiters wake on new work to help and on finished jobs to recheck their own
+		std::condition_variable progress;
+
+		std::atomic<size_t> queuedJobs{ 0 };
+		std::atomic<size_t> nextQueue{ 0 };
+		bool stopping = false;
+
+		std::chrono::steady_clock::time_point sampleTime;
+		std::vector<JobWorkerStats> stats;
+
+		void WorkerLoop(size_t workerIndex);
+
+		// Own deque newest first, then the oldest job of another worker, higher priorities before lower
+		std::shared_ptr<JobState> TryGetJob(size_t workerIndex);
+
+		void Execute(const std::shared_ptr<JobState>& job, size_t workerIndex);
+	};
+}
\ No newline at end of file
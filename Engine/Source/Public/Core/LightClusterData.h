@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace Nightbird
+{
+	constexpr uint32_t CLUSTER_GRID_X = 16;
+	constexpr uint32_t CLUSTER_GRID_Y = 9;
+	constexpr uint32_t CLUSTER_GRID_Z = 24;
+	constexpr uint32_t CLUSTER_COUNT = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+
+	// Average of 32 lights per cluster, the list is truncated beyond that
+	constexpr uint32_t MAX_CLUSTER_LIGHT_INDICES = CLUSTER_COUNT * 32;
+
+	struct LightClusterRange
+	{
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	struct alignas(16) LightClusterMetaUBO
+	{
+		alignas(16) glm::uvec4 gridSize;
+		alignas(16) glm::vec4 tileSize;
+		// x: slice scale, y: slice bias, z: near plane, w: far plane
+		alignas(16) glm::vec4 depthParams;
+	};
+}
\ No newline at end of file
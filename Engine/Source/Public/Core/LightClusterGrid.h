@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <volk.h>
+
+#include "Core/LightClusterData.h"
+
+namespace Nightbird
+{
+	struct PointLightData;
+
+	// Bins point lights into view space clusters with exponential depth slices
+	class LightClusterGrid
+	{
+	public:
+		LightClusterGrid();
+		~LightClusterGrid();
+
+		void Build(const std::vector<PointLightData>& pointLights, const glm::mat4& view, const glm::mat4& projection, VkExtent2D extent, float nearPlane, float farPlane);
+
+		const std::vector<LightClusterRange>& GetClusters() const;
+		const std::vector<uint32_t>& GetLightIndices() const;
+		const LightClusterMetaUBO& GetMetaUBO() const;
+
+	private:
+		std::vector<LightClusterRange> clusters;
+		std::vector<uint32_t> lightIndices;
+
+		// Packed (cluster << 16 | light) pairs, counting sorted into clusters
+		std::vector<uint32_t> clusterLightPairs;
+		std::vector<uint32_t> clusterCounts;
+
+		LightClusterMetaUBO metaUBO{};
+
+		bool truncationReported = false;
+
+		// View space cluster bounds in SoA layout, rebuilt when the projection changes
+		std::vector<float> boundsMinX, boundsMinY, boundsMinZ;
+		std::vector<float> boundsMaxX, boundsMaxY, boundsMaxZ;
+
+		glm::mat4 cachedProjection = glm::mat4(0.0f);
+		float cachedNear = 0.0f;
+		float cachedFar = 0.0f;
+
+		void BuildClusterBounds(const glm::mat4& projection, float nearPlane, float farPlane);
+
+		uint32_t GetSlice(float depth) const;
+	};
+}
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <volk.h>
 
 #include "Core/Vertex.h"
+#include "Core/Bounds.h"
 #include "Vulkan/UniformBuffer.h"
 
 namespace Nightbird
@@ -15,6 +16,7 @@ namespace Nightbird
 	class VulkanDevice;
 	class VulkanTexture;
 	class MeshPrimitive;
+	class TriangleBVH;
 	struct MeshPrimitiveInfo;
 	
 	class Mesh
@@ -30,11 +32,46 @@ namespace Nightbird
 		
 		void AddPrimitive(std::unique_ptr<MeshPrimitive> meshPrimitive);
 
+		// Hands the GPU resources back while the Mesh object stays referenced by instances
+		std::vector<std::unique_ptr<MeshPrimitive>> ReleasePrimitives();
+		
+		bool IsResident() const;
+		void SetResident(bool resident);
+
+		void MarkUsed(uint64_t frame) const;
+		uint64_t GetLastUsedFrame() const;
+
+		VkDeviceSize GetMemorySize() const;
+
+		// Local space bounds of all primitives, kept while evicted
+		const AABB& GetBounds() const;
+		const BoundingSphere& GetBoundingSphere() const;
+
+		// Levels of the primitive with the most, the error of a level is the largest over all primitives
+		size_t GetLodCount() const;
+		float GetLodError(size_t level) const;
+
+		// Local space triangles for raycasts, kept while evicted, null when the mesh has no indexed geometry
+		const TriangleBVH* GetCollision() const;
+		void SetCollision(std::shared_ptr<const TriangleBVH> triangles);
+
 	private:
 		VulkanDevice* device;
 		
 		std::vector<std::unique_ptr<MeshPrimitive>> primitives;
 
 		VkDescriptorSetLayout uniformDescriptorSetLayout;
+
+		AABB bounds;
+		BoundingSphere boundingSphere;
+
+		// Kept while evicted like the bounds, so LOD selection stays stable across reloads
+		std::vector<float> lodErrors;
+
+		std::shared_ptr<const TriangleBVH> collision;
+
+		bool resident = true;
+
+		mutable uint64_t lastUsedFrame = 0;
 	};
 }
\ No newline at end of file
@@ -3,11 +3,14 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <array>
 
 #include <volk.h>
 
 #include "Core/SpatialObject.h"
 #include "Core/Transform.h"
+#include "Core/Bounds.h"
+#include "Core/MeshUBO.h"
 
 namespace Nightbird
 {
@@ -26,6 +29,18 @@ namespace Nightbird
 		
 		void UpdateUniformBuffer(uint32_t currentImage);
 
+		AABB GetWorldBounds() const;
+
+		void SetPointLights(const uint32_t* indices, uint32_t count);
+
+		// Large closed meshes worth rasterizing into the CPU occlusion buffer, set through the owning PrefabInstance
+		bool IsOccluder() const;
+		void SetOccluder(bool value);
+
+		// Detail level picked by the renderer, remembered so switching back needs a clear margin
+		uint32_t GetLodLevel() const;
+		void SetLodLevel(uint32_t level);
+
 	protected:
 		VulkanDevice* device;
 
@@ -35,6 +50,13 @@ namespace Nightbird
 		
 		std::shared_ptr<Mesh> mesh;
 
+		std::array<uint32_t, MAX_OBJECT_POINT_LIGHTS> pointLightIndices{};
+		uint32_t pointLightCount = 0;
+
+		bool occluder = false;
+
+		uint32_t lodLevel = 0;
+
 		void CreateUniformBuffers();
 		void CreateUniformDescriptorSets(VkDescriptorPool descriptorPool);
 	};
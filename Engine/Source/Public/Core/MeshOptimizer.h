@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Nightbird
+{
+	struct Vertex;
+
+	// Import time reordering of indexed triangle lists, none of these change the rendered surface.
+	// Every index must be below the vertex count, out of range input is left untouched
+
+	// Reorders triangles for the post-transform vertex cache (Forsyth's linear speed algorithm)
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	// Splits cache optimized triangles into clusters and draws the outward facing ones first, so more pixels fail the depth test.
+	// A cluster is only cut where its own cache miss ratio stays within threshold of the unsplit order
+	void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+
+	// Renumbers vertices in order of first use so fetches walk the vertex buffer linearly, unreferenced vertices are dropped
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Average cache miss ratio, vertices transformed per triangle with a FIFO cache of cacheSize entries, 0 for out of range input
+	float ComputeAcmr(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = 16);
+}
\ No newline at end of file
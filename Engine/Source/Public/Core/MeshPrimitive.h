@@ -2,24 +2,76 @@
 
 #include <vector>
 #include <memory>
+#include <array>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <volk.h>
 
+#include "Core/Bounds.h"
+#include "Core/Vertex.h"
+
 namespace Nightbird
 {
 	class VulkanDevice;
 	class VulkanTexture;
 	class VulkanBuffer;
 	class VulkanUniformBuffer;
-	struct Vertex;
+
+	// Index range of one detail level, all levels share the primitive's vertex buffer
+	struct MeshLod
+	{
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		// Largest deviation from the full detail surface, in local space units
+		float error = 0.0f;
+	};
+
+	// GPU layout of a primitive's vertex buffer, shared by upload and the cooked model format
+	struct PackedVertexLayout
+	{
+		VertexDecode vertexDecode{};
+		// Offsets of bindings 1-3, sets identical to an earlier one reuse its offset
+		std::array<VkDeviceSize, 3> texCoordOffsets{};
+		std::array<size_t, 3> streamSource{};
+		// Position stream plus every distinct texture coordinate stream
+		VkDeviceSize size = 0;
+	};
+
+	// Vertex and index data already in the GPU layout, the memory must outlive the upload
+	struct PackedPrimitiveData
+	{
+		const uint8_t* vertices = nullptr;
+		const uint8_t* indices = nullptr;
+		PackedVertexLayout layout;
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+	};
+
+	PackedVertexLayout ComputePackedVertexLayout(const std::vector<Vertex>& vertices, const AABB& bounds);
+	void WritePackedVertices(const std::vector<Vertex>& vertices, const PackedVertexLayout& layout, uint8_t* destination);
+
+	VkIndexType GetPackedIndexType(size_t vertexCount);
+	VkDeviceSize GetIndexSize(VkIndexType indexType);
+	void WritePackedIndices(const std::vector<uint32_t>& indices, VkIndexType indexType, uint8_t* destination);
 
 	struct MeshPrimitiveInfo
 	{
 		std::vector<Vertex> vertices;
-		std::vector<uint16_t> indices;
+		// Always 32 bit at import, narrowed to 16 bit at upload when the vertex count allows it
+		std::vector<uint32_t> indices;
+
+		// Cooked models fill this instead of vertices and indices
+		PackedPrimitiveData packed;
+
+		// Finest first, ranges into indices. Left empty the whole index list is the only level
+		std::vector<MeshLod> lods;
+
+		// Local space bounds, filled at import (computed from the vertices when left invalid)
+		AABB bounds;
+		BoundingSphere boundingSphere;
 
 		glm::vec4 baseColorFactor;
 		float metallicFactor;
@@ -48,6 +100,20 @@ namespace Nightbird
 		~MeshPrimitive();
 		
 		const size_t GetIndicesSize() const;
+		VkIndexType GetIndexType() const;
+
+		size_t GetLodCount() const;
+		// Levels past the coarsest clamp to it
+		const MeshLod& GetLod(size_t level) const;
+
+		VkDeviceSize GetMemorySize() const;
+
+		const AABB& GetBounds() const;
+		const BoundingSphere& GetBoundingSphere() const;
+
+		const VertexDecode& GetVertexDecode() const;
+		// Offsets into vertexBuffer for vertex bindings 1-3, deduplicated sets share an offset
+		const std::array<VkDeviceSize, 3>& GetTexCoordOffsets() const;
 
 		VkDescriptorImageInfo GetBaseColorInfo() const;
 		VkDescriptorImageInfo GetMetallicRoughnessInfo() const;
@@ -57,6 +123,9 @@ namespace Nightbird
 
 		bool GetTransparencyEnabled() const;
 		bool GetDoubleSided() const;
+
+		// Material half of the pipeline variant key (ShaderVariant bits)
+		uint32_t GetShaderVariantKey() const;
 		
 		VulkanBuffer* vertexBuffer;
 		VulkanBuffer* indexBuffer;
@@ -75,9 +144,21 @@ namespace Nightbird
 		bool transparencyEnabled = false;
 		bool doubleSided = false;
 
+		uint32_t shaderVariantKey = 0;
+
 		size_t indicesSize;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+
+		std::vector<MeshLod> lods;
+
+		AABB bounds;
+		BoundingSphere boundingSphere;
+
+		VertexDecode vertexDecode{};
+		std::array<VkDeviceSize, 3> texCoordOffsets{};
 
 		VkDescriptorSetLayout materialDescriptorSetLayout;
+		VkDescriptorPool descriptorPool;
 
 		std::vector<VkDescriptorSet> materialDescriptorSets;
 		
@@ -86,8 +167,9 @@ namespace Nightbird
 		void CreateMaterialFactorsUniformBuffer();
 		
 		void CreateVertexBuffer(const std::vector<Vertex>& vertices);
-		void CreateIndexBuffer(const std::vector<uint16_t>& indices);
+		void CreateIndexBuffer(const std::vector<uint32_t>& indices, size_t vertexCount);
+		void CreateBuffers(const PackedPrimitiveData& packed);
 		
-		void CreateMaterialDescriptorSets(VkDescriptorPool descriptorPool);
+		void CreateMaterialDescriptorSets();
 	};
 }
\ No newline at end of file
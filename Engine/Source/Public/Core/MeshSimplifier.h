@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace Nightbird
+{
+	struct Vertex;
+
+	// Quadric error edge collapse over an indexed triangle list. Vertices are only ever merged into existing ones,
+	// so the simplified index lists keep referencing the original vertex buffer
+	class MeshSimplifier
+	{
+	public:
+		MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+		// Collapses edges until targetIndexCount is reached or the next collapse would exceed maxError,
+		// error receives the largest geometric deviation introduced, both in the units of the vertex positions
+		std::vector<uint32_t> Simplify(size_t targetIndexCount, float maxError, float& error) const;
+
+	private:
+		// Normal and base color texture coordinate channels, weighted against position error
+		static constexpr int AttributeCount = 5;
+		static constexpr float NormalWeight = 0.5f;
+		static constexpr float TexCoordWeight = 1.0f;
+
+		// error(p) = p'Ap + 2b.p + c, summed over planes weighted by triangle area
+		struct Quadric
+		{
+			float a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+			float b0 = 0, b1 = 0, b2 = 0;
+			float c = 0;
+			float weight = 0;
+
+			void Add(const Quadric& other);
+			float Evaluate(const glm::vec3& p) const;
+		};
+
+		// Per channel fit of the attribute as a linear function over each triangle plane,
+		// error(p, a) = (g.p + d - a)^2 expanded so it can be summed
+		struct AttributeQuadric
+		{
+			Quadric gradient;
+			glm::vec3 gradientSum = glm::vec3(0.0f);
+			float offsetSum = 0;
+
+			void Add(const AttributeQuadric& other);
+			float Evaluate(const glm::vec3& p, float a) const;
+		};
+
+		struct VertexQuadric
+		{
+			Quadric position;
+			AttributeQuadric attributes[AttributeCount];
+
+			void Add(const VertexQuadric& other);
+			float Evaluate(const glm::vec3& p, const float* a) const;
+		};
+
+		struct Collapse
+		{
+			uint32_t from;
+			uint32_t to;
+			float cost;
+		};
+
+		// Positions moved into a unit box so error thresholds don't depend on model scale
+		std::vector<glm::vec3> positions;
+		std::vector<float> attributes;
+		std::vector<uint32_t> indices;
+
+		// Vertices on open borders or sharing their position with another vertex (attribute seams)
+		std::vector<uint8_t> locked;
+
+		// Built once from the full mesh, each Simplify call collapses a copy
+		std::vector<VertexQuadric> quadrics;
+
+		float scale = 1.0f;
+
+		void BuildQuadrics();
+		bool FlipsTriangle(const std::vector<uint32_t>& triangleIndices, const std::vector<uint32_t>& adjacency, const std::vector<uint32_t>& adjacencyOffsets, uint32_t from, uint32_t to) const;
+	};
+}
\ No newline at end of file
@@ -4,8 +4,12 @@
 
 namespace Nightbird
 {
+	constexpr uint32_t MAX_OBJECT_POINT_LIGHTS = 8;
+
 	struct alignas(16) MeshUBO
 	{
 		alignas(16)	glm::mat4 model;
+		alignas(16) glm::uvec4 pointLightIndices[MAX_OBJECT_POINT_LIGHTS / 4];
+		alignas(16) uint32_t pointLightCount;
 	};
 }
\ No newline at end of file
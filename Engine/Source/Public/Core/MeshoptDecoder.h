@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Nightbird
+{
+	enum class MeshoptFilter
+	{
+		None,
+		Octahedral,
+		Quaternion,
+		Exponential
+	};
+
+	// Decoders for the EXT_meshopt_compression bitstreams, each returns false on malformed input
+
+	// Attributes mode, stride must be a multiple of 4 no larger than 256
+	bool DecodeMeshoptVertexBuffer(void* destination, size_t count, size_t stride, const uint8_t* buffer, size_t size);
+
+	// Triangles mode, indexSize is 2 or 4
+	bool DecodeMeshoptIndexBuffer(void* destination, size_t count, size_t indexSize, const uint8_t* buffer, size_t size);
+
+	// Indices mode, indexSize is 2 or 4
+	bool DecodeMeshoptIndexSequence(void* destination, size_t count, size_t indexSize, const uint8_t* buffer, size_t size);
+
+	// Applied in place after DecodeMeshoptVertexBuffer
+	void ApplyMeshoptFilter(void* data, size_t count, size_t stride, MeshoptFilter filter);
+}
\ No newline at end of file
@@ -13,6 +13,8 @@ namespace Nightbird
 {
 	class VulkanTexture;
 	class Mesh;
+	class TriangleBVH;
+	class MappedFile;
 
 	struct TextureData
 	{
@@ -21,11 +23,17 @@ namespace Nightbird
 		int height;
 		int channels;
 		bool sRGB;
+
+		// Set instead of pixels for cooked models, points into Model::mappedFile
+		const uint8_t* mappedPixels = nullptr;
 	};
 
 	struct MeshData
 	{
 		std::vector<MeshPrimitiveInfo> primitiveInfo;
+
+		// Built on the loading thread from all primitives, handed to the Mesh at upload
+		std::shared_ptr<TriangleBVH> collision;
 	};
 
 	struct Model
@@ -35,8 +43,15 @@ namespace Nightbird
 
 		std::vector<TextureData> textureData;
 		std::vector<MeshData> meshData;
+
+		// Cooked models read their texture and primitive data straight from here until upload
+		std::shared_ptr<MappedFile> mappedFile;
 		
 		std::unordered_map<size_t, std::shared_ptr<VulkanTexture>> textures;
 		std::vector<std::shared_ptr<Mesh>> meshes;
+
+		// Cleared when the residency manager evicts the model's GPU resources
+		bool resident = true;
+		VkDeviceSize gpuMemorySize = 0;
 	};
 }
\ No newline at end of file
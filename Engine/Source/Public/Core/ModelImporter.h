@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <fastgltf/core.hpp>
+#include <fastgltf/types.hpp>
+
+namespace Nightbird
+{
+	class JobSystem;
+	struct MeshData;
+	struct MeshPrimitiveInfo;
+	struct Model;
+
+	// Part of the cooked model's identity, the asset cooker rebuilds outputs whose settings changed
+	struct ModelImportSettings
+	{
+		bool optimizeMeshes = true;
+		bool generateLods = true;
+	};
+
+	// Accessor reads of one import, the time is summed over workers so it gives per thread throughput
+	struct ModelImportStats
+	{
+		size_t readVertices = 0;
+		double readSeconds = 0.0;
+	};
+
+	// Builds a model's CPU data from a GLB or glTF file. Needs no GPU, so it runs on loader jobs and in the asset cooker
+	class ModelImporter
+	{
+	public:
+		explicit ModelImporter(JobSystem* jobSystem, const ModelImportSettings& settings = {});
+
+		// Null on failure or when the calling job was cancelled
+		std::shared_ptr<Model> Import(const std::filesystem::path& path, ModelImportStats* importStats = nullptr) const;
+
+	private:
+		JobSystem* jobSystem;
+		ModelImportSettings settings;
+
+		void LoadTextures(std::shared_ptr<Model>& model) const;
+
+		// Decodes EXT_meshopt_compression views into new buffers, returns false when any fails
+		bool DecodeCompressedBufferViews(fastgltf::Asset& asset) const;
+
+		// Reads one primitive's vertices, indices and material, touches no shared state so primitives extract in parallel.
+		// False for primitives without POSITION or with unusable indices, triangles past the vertex count are dropped
+		bool ExtractPrimitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, MeshPrimitiveInfo& primitiveInfo) const;
+
+		// Appends simplified index ranges to the primitive, each roughly halving the triangle count
+		void GenerateLods(MeshPrimitiveInfo& primitiveInfo) const;
+
+		// Cache, overdraw and fetch reordering plus LODs, accumulates triangle weighted ACMR for the import report
+		void OptimizePrimitive(MeshPrimitiveInfo& primitiveInfo, double& acmrBefore, double& acmrAfter, size_t& triangleCount) const;
+
+		// CPU copy of the mesh triangles used for exact raycasts and picking
+		void BuildCollision(MeshData& meshData) const;
+
+		bool DecodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight, int& outChannels) const;
+	};
+}
\ No newline at end of file
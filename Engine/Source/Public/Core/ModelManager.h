@@ -4,10 +4,13 @@
 #include <mutex>
 #include <queue>
 #include <unordered_map>
-#include <unordered_set>
+#include <deque>
 #include <future>
 #include <string>
+#include <vector>
 
+#include "Core/JobSystem.h"
+#include "Core/ModelImporter.h"
 #include "Vulkan/Texture.h"
 
 #include <volk.h>
@@ -25,54 +28,122 @@ namespace Nightbird
 	class VulkanTexture;
 	class Transform;
 	class Mesh;
+	class MeshPrimitive;
 	class MeshInstance;
 	struct MeshInfo;
+	struct MeshData;
+	struct MeshPrimitiveInfo;
 	struct Model;
 	
 	class ModelManager
 	{
 	public:
 		using LoadCallback = std::function<void(std::shared_ptr<Model>)>;
+		using ModelMap = std::unordered_map<std::string, std::shared_ptr<Model>>;
 
-		ModelManager(VulkanDevice* device, VkDescriptorSetLayout uniformDescriptorSetLayout, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool);
+		ModelManager(VulkanDevice* device, JobSystem* jobSystem, VkDescriptorSetLayout uniformDescriptorSetLayout, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool);
 		~ModelManager();
 
-		const std::unordered_map<std::string, std::shared_ptr<Model>>& GetModels();
+		// Immutable snapshot, safe to iterate from any thread while new models are published. Keep the pointer alive while iterating
+		std::shared_ptr<const ModelMap> GetModels() const;
 		
-		std::shared_ptr<Model> GetModel(const std::string& path);
+		// Null when the path was never loaded
+		std::shared_ptr<Model> GetModel(const std::string& path) const;
 		
 		std::shared_ptr<Model> LoadModel(const std::filesystem::path& path);
-		void LoadModelAsync(const std::filesystem::path& path, LoadCallback callback = 0);
 
+		// Requests for a path that is already loading share that load. The future is ready once the CPU side is built,
+		// callbacks run on the main thread after upload, or immediately when the model is already resident
+		std::shared_future<std::shared_ptr<Model>> LoadModelAsync(const std::filesystem::path& path, LoadCallback callback = 0, JobPriority priority = JobPriority::Normal);
+
+		// Uploads ready models within the per-frame budget, large models finish over several frames
 		void ProcessUploadQueue();
+		void SetUploadBudget(double milliseconds, VkDeviceSize bytes);
+
+		// Imported models write a .nbmodel next to the source that later loads map instead of parsing the glTF
+		void SetCookOnImport(bool enabled);
+
+		// frameNumber is the last frame that may have drawn the model, its GPU resources live until that frame completes
+		void EvictModel(const std::string& path, uint64_t frameNumber);
+		void ReloadModel(const std::string& path);
+
+		void ReleaseRetiredResources(uint64_t completedFrameNumber);
 
 	private:
 		VulkanDevice* device;
+		JobSystem* jobSystem;
 		
 		VkDescriptorSetLayout uniformDescriptorSetLayout;
 		VkDescriptorSetLayout materialDescriptorSetLayout;
 
 		VkDescriptorPool descriptorPool;
 		
-		std::unordered_map<std::string, std::shared_ptr<Model>> models;
-
-		std::unordered_map<std::string, std::future<std::shared_ptr<Model>>> modelFutures;
+		struct PendingLoad
+		{
+			JobHandle job;
+			std::shared_future<std::shared_ptr<Model>> future;
+			std::vector<LoadCallback> callbacks;
+		};
+
+		// Copied on every insert and swapped with atomic_store, so lookups never take a lock
+		std::shared_ptr<const ModelMap> models;
+
+		// Main thread only, one entry per path with a load in flight
+		std::unordered_map<std::string, PendingLoad> pendingLoads;
+
+		// Main thread only, a model part way through its upload
+		struct UploadTask
+		{
+			std::shared_ptr<Model> model;
+			size_t textureIndex = 0;
+			size_t meshIndex = 0;
+			size_t primitiveIndex = 0;
+		};
 
 		std::mutex uploadQueueMutex;
 		std::queue<std::shared_ptr<Model>> uploadQueue;
 
-		std::unordered_map<std::string, LoadCallback> pendingCallbacks;
+		std::deque<UploadTask> uploadTasks;
+
+		// Checked after each texture or primitive, so one item may overshoot
+		double uploadBudgetMilliseconds = 4.0;
+		VkDeviceSize uploadBudgetBytes = 64ull * 1024 * 1024;
+
+		// Read from loader jobs, only change it while no load is in flight
+		bool cookOnImport = true;
+
+		// Evicted GPU resources waiting for the frames that used them
+		struct RetiredResources
+		{
+			uint64_t frameNumber;
+			std::vector<std::unique_ptr<MeshPrimitive>> primitives;
+			std::unordered_map<size_t, std::shared_ptr<VulkanTexture>> textures;
+		};
+
+		std::deque<RetiredResources> retiredResources;
 
 		std::shared_ptr<VulkanTexture> fallbackTexture;
 
-		void LoadTextures(std::shared_ptr<Model>& model);
-		
+		ModelImporter importer;
+
+		// Cooked file when there is a current one, otherwise a full import
 		std::shared_ptr<Model> LoadModelInternal(const std::filesystem::path& path);
 
+		void ProcessUploads(double budgetMilliseconds, VkDeviceSize budgetBytes);
+
+		// Returns the model to upload into, the evicted one a reload replaces, or null when it cannot be restored
+		std::shared_ptr<Model> PrepareUpload(std::shared_ptr<Model> model);
+
+		// Publishes the model and runs the callbacks waiting on it
+		void FinishUpload(std::shared_ptr<Model> model);
+
 		void UploadModel(std::shared_ptr<Model>& model);
+
+		// Uploads one texture or primitive, returns true once the model is resident
+		bool UploadStep(UploadTask& task, VkDeviceSize& uploadedBytes);
+
+		bool RestoreModel(std::shared_ptr<Model>& evictedModel, std::shared_ptr<Model>& loadedModel);
 		
 		std::shared_ptr<VulkanTexture> CreateFallbackTexture(glm::vec4 color);
-		
-		bool DecodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight, int& outChannels);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace Nightbird
+{
+	class TriangleBVH;
+	class JobSystem;
+	struct AABB;
+
+	// Low resolution CPU depth buffer filled from occluder meshes, rasterized in parallel by screen tiles
+	class OcclusionCuller
+	{
+	public:
+		static constexpr uint32_t Width = 320;
+		static constexpr uint32_t Height = 192;
+		static constexpr uint32_t TileWidth = 64;
+		static constexpr uint32_t TileHeight = 64;
+		static constexpr uint32_t TilesX = Width / TileWidth;
+		static constexpr uint32_t TilesY = Height / TileHeight;
+
+		explicit OcclusionCuller(JobSystem* jobSystem);
+
+		// Clears the depth buffer and the binned occluder triangles
+		void Begin(const glm::mat4& viewProjection);
+
+		// Triangles crossing the near plane are dropped, which only makes the occluder smaller
+		void AddOccluder(const glm::mat4& worldMatrix, const TriangleBVH& triangles);
+
+		void Rasterize();
+
+		// False only when the box is hidden behind rasterized occluders over its whole screen rectangle
+		bool IsVisible(const AABB& worldBounds) const;
+
+		size_t GetOccluderTriangleCount() const;
+
+	private:
+		struct ScreenTriangle
+		{
+			glm::vec3 v0;
+			glm::vec3 v1;
+			glm::vec3 v2;
+		};
+
+		JobSystem* jobSystem;
+
+		glm::mat4 viewProjection = glm::mat4(1.0f);
+
+		std::vector<float> depth;
+		std::vector<ScreenTriangle> triangles;
+		std::vector<uint32_t> tileBins[TilesX * TilesY];
+
+		void RasterizeTile(uint32_t tile);
+		void RasterizeTriangle(const ScreenTriangle& triangle, uint32_t tileX, uint32_t tileY);
+
+		bool ToScreen(const glm::vec4& clip, glm::vec3& screen) const;
+	};
+}
\ No newline at end of file
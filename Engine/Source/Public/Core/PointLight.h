@@ -19,9 +19,15 @@ namespace Nightbird
 		~PointLight() override;
 
 		PointLightData GetData() const;
+
+		// The radius sizes the light's bounds in the scene index, so writes mark it like a transform change
+		float GetRadius() const;
+		void SetRadius(float value);
 		
 		glm::vec3 color = glm::vec3(1.0f);
 		float intensity = 1.0f;
+
+	private:
 		float radius = 10.0f;
 		
 		RTTR_ENABLE(Nightbird::SpatialObject)
@@ -4,7 +4,7 @@
 
 namespace Nightbird
 {
-	constexpr int MAX_POINT_LIGHTS = 16;
+	constexpr int MAX_POINT_LIGHTS = 1024;
 
 	struct alignas(16) PointLightData
 	{
@@ -15,5 +15,6 @@ namespace Nightbird
 	struct alignas(16) PointLightMetaUBO
 	{
 		uint32_t count;
+		uint32_t perObjectLights;
 	};
 }
\ No newline at end of file
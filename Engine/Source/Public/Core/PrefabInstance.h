@@ -21,11 +21,17 @@ namespace Nightbird
 		
 		const std::string& GetPrefabPath() const;
 
+		// Saved with the prefab and applied to every mesh instance under it, they are rebuilt on load
+		bool IsOccluder() const;
+		void SetOccluder(bool value);
+
 		void Serialize(json& out) const override;
 		void Deserialize(const json& in) override;
 
 	protected:
 		std::string prefabPath;
+
+		bool occluder = false;
 		
 		RTTR_ENABLE(Nightbird::SpatialObject)
 		RTTR_REGISTRATION_FRIEND
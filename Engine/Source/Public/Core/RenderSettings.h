@@ -0,0 +1,30 @@
+#pragma once
+
+namespace Nightbird
+{
+	enum class TransparencyMode
+	{
+		// Back to front by object origin, one draw at a time
+		Sorted,
+		// Weighted blended order independent transparency, no sort and batched draws
+		WeightedBlended
+	};
+
+	// Per render target options consumed by Renderer::DrawScene
+	struct RenderSettings
+	{
+		// Lay down opaque depth first so the color pass only shades visible fragments
+		bool depthPrepass = false;
+
+		// Rasterize occluder MeshInstances on the CPU and skip draws hidden behind them
+		bool occlusionCulling = false;
+
+		// Draw what the last frame found visible, then test everything against that depth on the GPU and draw what was missed
+		bool gpuOcclusionCulling = false;
+
+		// Screen space error in pixels a simplified LOD may introduce, 0 always draws full detail
+		float lodErrorThreshold = 1.0f;
+
+		TransparencyMode transparencyMode = TransparencyMode::Sorted;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Nightbird
+{
+	// Draw counts of the last DrawScene call, total covers the instances kept by the spatial index
+	struct RenderStats
+	{
+		uint32_t totalDraws = 0;
+		uint32_t visibleDraws = 0;
+		// Passed the frustum test but hidden behind occluders, not included in visibleDraws
+		uint32_t occludedDraws = 0;
+		// Skipped by the GPU test, read back a few frames late and still counted in visibleDraws
+		uint32_t gpuOccludedDraws = 0;
+
+		// Triangles of the visible draws at their selected LOD, and how many full detail would have added
+		uint32_t drawnTriangles = 0;
+		uint32_t lodTrianglesSaved = 0;
+	};
+}
\ No newline at end of file
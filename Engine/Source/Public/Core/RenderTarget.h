@@ -4,6 +4,7 @@
 
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/Pipeline.h"
+#include "Core/RenderSettings.h"
 
 #include <volk.h>
 
@@ -22,7 +23,27 @@ namespace Nightbird
 		
 		virtual void Render(Scene* scene, VulkanRenderPass* renderPass, VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent) = 0;
 
+		void SetRenderSettings(const RenderSettings& settings);
+		const RenderSettings& GetRenderSettings() const;
+
+		void SetDepthPrepassEnabled(bool enabled);
+		bool IsDepthPrepassEnabled() const;
+
+		void SetOcclusionCullingEnabled(bool enabled);
+		bool IsOcclusionCullingEnabled() const;
+
+		void SetGpuOcclusionCullingEnabled(bool enabled);
+		bool IsGpuOcclusionCullingEnabled() const;
+
+		void SetLodErrorThreshold(float pixels);
+		float GetLodErrorThreshold() const;
+
+		void SetTransparencyMode(TransparencyMode mode);
+		TransparencyMode GetTransparencyMode() const;
+
 	protected:
 		Renderer* renderer = nullptr;
+
+		RenderSettings renderSettings;
 	};
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <volk.h>
+
 namespace Nightbird
 {
 	class MeshInstance;
@@ -9,5 +11,11 @@ namespace Nightbird
 	{
 		MeshInstance* instance;
 		MeshPrimitive* primitive;
+		// Index range drawn, see MeshPrimitive::GetLod
+		uint32_t lod = 0;
+
+		// Set when the GPU occlusion test left a command for this draw, instanceCount 0 skips it
+		VkBuffer indirectBuffer = VK_NULL_HANDLE;
+		VkDeviceSize indirectOffset = 0;
 	};
 }
\ No newline at end of file
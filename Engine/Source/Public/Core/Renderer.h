@@ -1,10 +1,17 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <vector>
 
 #include <volk.h>
 
+#include "Vulkan/Config.h"
+#include "Core/RenderSettings.h"
+#include "Core/RenderStats.h"
+#include "Core/FrustumCuller.h"
+#include "Core/OcclusionCuller.h"
+
 namespace Nightbird
 {
 	class VulkanInstance;
@@ -15,10 +22,15 @@ namespace Nightbird
 	class GlobalDescriptorSetManager;
 	class VulkanPipeline;
 	class VulkanDescriptorPool;
+	class VulkanOitTargets;
+	class VulkanHiZCuller;
+	class VulkanImage;
 	class VulkanSync;
 	class GlfwWindow;
+	class JobSystem;
 	class Scene;
 	class SceneObject;
+	class SpatialObject;
 	class Camera;
 	class MeshInstance;
 	class MeshPrimitive;
@@ -28,7 +40,7 @@ namespace Nightbird
 	class Renderer
 	{
 	public:
-		Renderer(GlfwWindow* glfwWindow);
+		Renderer(GlfwWindow* glfwWindow, JobSystem* jobSystem);
 		~Renderer();
 		
 		VulkanDevice* GetDevice() const;
@@ -38,19 +50,34 @@ namespace Nightbird
 		VulkanDescriptorSetLayoutManager* GetDescriptorSetLayoutManager() const;
 		GlobalDescriptorSetManager* GetGlobalDescriptorSetManager() const;
 		VulkanDescriptorPool* GetDescriptorPool() const;
+		VulkanOitTargets* GetOitTargets() const;
 		
 		void SetRenderTarget(RenderTarget* renderTarget);
 
 		void DrawFrame(Scene* scene);
 
-		void DrawScene(Scene* scene, Camera* camera, VkCommandBuffer commandBuffer, VkExtent2D extent);
+		// The render pass is advanced through its OIT subpasses, oitTargets and depthImage belong to the bound framebuffer.
+		// With GPU occlusion culling the pass is ended for the test and resumed on the framebuffer
+		void DrawScene(Scene* scene, Camera* camera, VkCommandBuffer commandBuffer, VulkanRenderPass* renderPass, VkFramebuffer framebuffer, VulkanOitTargets* oitTargets, VulkanImage* depthImage, VkExtent2D extent, const RenderSettings& settings);
 
 		void FramebufferResized();
 
+		uint64_t GetFrameNumber() const;
+
+		// Every frame up to this one has finished on the GPU
+		uint64_t GetCompletedFrameNumber() const;
+
+		const RenderStats& GetRenderStats() const;
+
 	private:
 		void RecreateSwapChain();
+		void CreateSwapChainFramebuffers();
+
+		// Gathers the instance primitives and queues their world bounding spheres in frustumCuller at the same index
+		void CollectRenderables(MeshInstance* instance, std::vector<Renderable>& renderables);
 
-		void CollectRenderables(SceneObject* object, std::vector<Renderable>& opaque, std::vector<Renderable>& opaqueDoubleSided, std::vector<Renderable>& transparent);
+		// Coarsest level whose projected error stays under errorThreshold pixels, lodScale is pixels per unit at distance one
+		void SelectLod(MeshInstance* instance, const glm::vec3& cameraPosition, float lodScale, float errorThreshold);
 
 		std::unique_ptr<VulkanInstance> instance;
 		std::unique_ptr<VulkanDevice> device;
@@ -61,17 +88,45 @@ namespace Nightbird
 		std::unique_ptr<GlobalDescriptorSetManager> globalDescriptorSetManager;
 		std::unique_ptr<VulkanSync> sync;
 
+		// OIT targets shared by all swap chain framebuffers
+		std::unique_ptr<VulkanOitTargets> oitTargets;
+
 		std::unique_ptr<VulkanPipeline> opaquePipeline;
 		std::unique_ptr<VulkanPipeline> transparentPipeline;
 		std::unique_ptr<VulkanPipeline> opaqueDoubleSidedPipeline;
 		std::unique_ptr<VulkanPipeline> transparentDoubleSidedPipeline;
+
+		std::unique_ptr<VulkanPipeline> depthPrepassPipeline;
+		std::unique_ptr<VulkanPipeline> depthPrepassDoubleSidedPipeline;
+		std::unique_ptr<VulkanPipeline> opaqueDepthEqualPipeline;
+		std::unique_ptr<VulkanPipeline> opaqueDepthEqualDoubleSidedPipeline;
+
+		std::unique_ptr<VulkanPipeline> transparentAccumulatePipeline;
+		std::unique_ptr<VulkanPipeline> transparentAccumulateDoubleSidedPipeline;
+		std::unique_ptr<VulkanPipeline> transparentCompositePipeline;
 		
 		RenderTarget* renderTarget = nullptr;
 
+		FrustumCuller frustumCuller;
+		std::vector<uint8_t> cullVisibility;
+		std::vector<SpatialObject*> visibleObjects;
+		std::unique_ptr<OcclusionCuller> occlusionCuller;
+		std::unique_ptr<VulkanHiZCuller> hiZCuller;
+
+		RenderStats renderStats;
+
 		GlfwWindow* glfwWindow = nullptr;
+		JobSystem* jobSystem = nullptr;
 
 		int currentFrame = 0;
 
+		// Frame counter starting at 1, used to stamp mesh usage for residency
+		uint64_t frameNumber = 0;
+
+		// Frame last submitted with each in flight fence
+		std::array<uint64_t, VulkanConfig::MAX_FRAMES_IN_FLIGHT> submittedFrameNumbers{};
+		uint64_t completedFrameNumber = 0;
+
 		bool framebufferResized = false;
 	};
 }
\ No newline at end of file
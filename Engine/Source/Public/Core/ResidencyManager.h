@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+#include <volk.h>
+
+namespace Nightbird
+{
+	class VulkanDevice;
+	class ModelManager;
+
+	struct ResidencyStats
+	{
+		VkDeviceSize deviceLocalUsage = 0;
+		VkDeviceSize deviceLocalBudget = 0;
+		VkDeviceSize residentAssetMemory = 0;
+
+		uint32_t residentModels = 0;
+		uint32_t evictedModels = 0;
+	};
+
+	class ResidencyManager
+	{
+	public:
+		ResidencyManager(VulkanDevice* device, ModelManager* modelManager);
+		~ResidencyManager();
+
+		// Call once per frame between frames, after the upload queue has been processed
+		void Update(uint64_t frameNumber);
+
+		// Limits resident asset memory to a fixed size instead of the device heap budget, 0 disables
+		void SetBudgetOverride(VkDeviceSize bytes);
+		void SetBudgetFraction(float fraction);
+
+		const ResidencyStats& GetStats() const;
+
+	private:
+		VulkanDevice* device;
+		ModelManager* modelManager;
+
+		VkDeviceSize budgetOverride = 0;
+
+		// Headroom left for swap chain, render targets and other processes
+		float budgetFraction = 0.9f;
+
+		// Models rendered within this many frames are never evicted
+		uint64_t minIdleFrames = 120;
+
+		ResidencyStats stats;
+	};
+}
\ No newline at end of file
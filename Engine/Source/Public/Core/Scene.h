@@ -17,6 +17,8 @@
 
 #include "Core/SceneObject.h"
 #include "Core/SpatialObject.h"
+#include "Core/Bounds.h"
+#include "Core/SpatialCategory.h"
 
 namespace Nightbird
 {
@@ -29,11 +31,26 @@ namespace Nightbird
 	class Mesh;
 	class Camera;
 	class PointLight;
+	class DirectionalLight;
+	class LightClusterGrid;
 	class Transform;
+	class DynamicAABBTree;
 	struct DirectionalLightData;
 	struct PointLightData;
 	struct Model;
 
+	struct SpatialQueryHit
+	{
+		SpatialObject* object = nullptr;
+		float distance = 0.0f;
+	};
+
+	enum class LightingMode
+	{
+		Clustered,
+		PerObject
+	};
+
 	class Scene
 	{
 	public:
@@ -65,8 +82,28 @@ namespace Nightbird
 
 		void Update(float delta);
 
-		void UpdateBuffers(int currentFrame, VkExtent2D swapChainExtent);
-		void UpdateBuffersRecursive(int currentFrame, VkExtent2D swapChainExtent, SceneObject* object, std::vector<DirectionalLightData>& directionalLightData, std::vector<PointLightData>& pointLightData);
+		void UpdateBuffers(int currentFrame, VkExtent2D swapChainExtent, const Camera* camera);
+
+		LightingMode GetLightingMode() const;
+		void SetLightingMode(LightingMode mode);
+
+		// Light types that reached the GPU in the last UpdateBuffers, used to pick shader variants
+		bool HasDirectionalLights() const;
+		bool HasPointLights() const;
+
+		// Bounds of the spatial objects in the scene, moves marked dirty are applied by Update, UpdateBuffers and the queries below
+		const DynamicAABBTree& GetSpatialIndex() const;
+
+		// Appends the objects whose bounds touch the frustum, the buffer is not cleared
+		void QueryFrustum(const Frustum& frustum, uint32_t categoryMask, std::vector<SpatialObject*>& results);
+
+		// Gameplay queries write at most capacity results into caller owned buffers and return the count written
+		bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, SpatialQueryHit& hit, uint32_t categoryMask = SpatialCategory::All, uint32_t layerMask = ~0u);
+		size_t OverlapSphere(const glm::vec3& center, float radius, SpatialObject** results, size_t capacity, uint32_t categoryMask = SpatialCategory::All, uint32_t layerMask = ~0u);
+		size_t OverlapBox(const AABB& box, SpatialObject** results, size_t capacity, uint32_t categoryMask = SpatialCategory::All, uint32_t layerMask = ~0u);
+
+		// Closest first, distances are to the object bounds and maxDistance must be positive. Of equally distant objects the one found first is kept
+		size_t NearestK(const glm::vec3& point, float maxDistance, SpatialQueryHit* results, size_t k, uint32_t categoryMask = SpatialCategory::All, uint32_t layerMask = ~0u);
 
 	private:
 		VulkanDevice* device;
@@ -80,11 +117,54 @@ namespace Nightbird
 		
 		Camera* mainCamera = nullptr;
 
+		std::unique_ptr<LightClusterGrid> lightClusterGrid;
+
+		LightingMode lightingMode = LightingMode::Clustered;
+
+		bool hasDirectionalLights = false;
+		bool hasPointLights = false;
+
+		// Tree user data points here, unordered_map nodes keep their address
+		struct SpatialProxy
+		{
+			SpatialObject* object;
+			int32_t id;
+			uint32_t category;
+			AABB bounds;
+		};
+
+		// Proxies live while their object hangs under the root, SceneObject registers and unregisters whole subtrees
+		std::unique_ptr<DynamicAABBTree> spatialIndex;
+		std::unordered_map<const SceneObject*, SpatialProxy> spatialProxies;
+		std::unordered_set<SceneObject*> dirtySpatialObjects;
+
+		std::vector<DirectionalLight*> directionalLights;
+
 		void InstantiateModelNode(const std::shared_ptr<Model>& model, const fastgltf::Node& node, SceneObject* parent);
 
 		PrefabInstance* CreatePrefabInstance(const std::string& name, const std::string& path, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, SceneObject* parent = nullptr);
 		MeshInstance* CreateMeshInstance(const std::string& name, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, SceneObject* parent, std::shared_ptr<Mesh> mesh);
 
 		void GetAllObjectsRecursive(SceneObject* root, std::vector<SceneObject*>& allObjects);
+
+		void AssignObjectLights(const std::vector<MeshInstance*>& meshInstances, const std::vector<PointLight*>& pointLights, const std::vector<PointLightData>& pointLightData, const Frustum& frustum);
+
+		friend class SceneObject;
+		friend class SpatialObject;
+
+		void RegisterObject(SceneObject* object);
+		void UnregisterObject(SceneObject* object);
+		void MarkTransformDirty(SpatialObject* object);
+
+		// Moves the proxies of every dirty subtree, an object whose ancestor is dirty is moved with it
+		void FlushSpatialUpdates();
+		void UpdateSpatialProxies(SceneObject* object);
+		void UpdateSpatialProxy(SpatialObject* object);
+
+		const SpatialProxy* GetSpatialProxy(int32_t proxyId, uint32_t layerMask) const;
+
+		// Point lights are tested as the sphere their bounds enclose, rays hit mesh triangles when the mesh has a CPU copy
+		static float DistanceSquaredToProxy(const SpatialProxy& proxy, const glm::vec3& point);
+		static bool RaycastProxy(const SpatialProxy& proxy, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance);
 	};
 }
\ No newline at end of file
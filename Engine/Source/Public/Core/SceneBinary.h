@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Nightbird
+{
+	class SceneObject;
+
+	// Bumped when the container layout changes, property changes are handled by the per type field tables
+	constexpr uint32_t SceneBinaryVersion = 1;
+
+	// Writes the object tree in depth first order. Children of prefab instances are rebuilt from their model on load,
+	// so like the JSON format they are not written
+	bool SaveSceneBinary(const SceneObject& root, const std::string& path);
+
+	// Applies the first object's properties to root and replaces root's children with the rest of the tree
+	bool LoadSceneBinary(const std::string& path, SceneObject& root);
+}
\ No newline at end of file
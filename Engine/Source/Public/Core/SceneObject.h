@@ -16,6 +16,8 @@ using json = nlohmann::json;
 
 namespace Nightbird
 {
+	class Scene;
+
 	class SceneObject
 	{
 	public:
@@ -28,11 +30,16 @@ namespace Nightbird
 		
 		void SetParent(SceneObject* transform);
 		SceneObject* GetParent() const;
+
+		// Set while the object hangs under a scene root, children added or removed here join or leave the scene index
+		Scene* GetScene() const;
 		
 		const std::vector<std::unique_ptr<SceneObject>>& GetChildren() const;
 		
 		void AddChild(std::unique_ptr<SceneObject> child);
 		std::unique_ptr<SceneObject> DetachChild(SceneObject* child);
+		void ClearChildren();
+		void ReserveChildren(size_t count);
 		
 		virtual void EnterScene();
 		virtual void Tick(float delta);
@@ -45,8 +52,12 @@ namespace Nightbird
 		RTTR_ENABLE()
 		RTTR_REGISTRATION_FRIEND
 
+		friend class Scene;
+
 	protected:
 		std::string name;
+
+		Scene* scene = nullptr;
 		
 		std::vector<std::unique_ptr<SceneObject>> children;
 
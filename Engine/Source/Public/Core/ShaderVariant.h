@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Nightbird
+{
+	// Bits of a pipeline variant key, each mapped to a specialization constant in Shader.frag
+	namespace ShaderVariant
+	{
+		constexpr uint32_t BaseColorTexture = 1 << 0;
+		constexpr uint32_t MetallicRoughnessTexture = 1 << 1;
+		constexpr uint32_t DirectionalLights = 1 << 2;
+		constexpr uint32_t PointLights = 1 << 3;
+
+		constexpr uint32_t Count = 4;
+		constexpr uint32_t All = (1 << Count) - 1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Nightbird
+{
+	// Category bits of the scene spatial index, queries take a mask of these
+	namespace SpatialCategory
+	{
+		constexpr uint32_t MeshInstance = 1 << 0;
+		constexpr uint32_t PointLight = 1 << 1;
+		// Any other spatial object, indexed by its position
+		constexpr uint32_t Object = 1 << 2;
+
+		constexpr uint32_t All = ~0u;
+	}
+}
\ No newline at end of file
@@ -13,6 +13,20 @@ namespace Nightbird
 		glm::mat4 GetLocalMatrix() const;
 		glm::mat4 GetWorldMatrix() const;
 
+		// Writes go through the setters, they mark the object so the scene index moves the subtree before its next query
+		const Transform& GetTransform() const;
+		void SetTransform(const Transform& value);
+		void SetPosition(const glm::vec3& position);
+		void SetRotation(const glm::quat& rotation);
+		void SetScale(const glm::vec3& scale);
+
+		// For anything else the bounds depend on, the transform setters already call it
+		void MarkTransformDirty();
+
+		// Bits matched against the layer mask of scene spatial queries
+		uint32_t layers = 1;
+
+	private:
 		Transform transform;
 		
 		RTTR_ENABLE(Nightbird::SceneObject)
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Core/Bounds.h"
+
+namespace Nightbird
+{
+	// Static CPU side triangle hierarchy for exact ray queries, leaves hold packs of four triangles tested together with SSE
+	class TriangleBVH
+	{
+	public:
+		void Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+
+		// Flat copy of the nodes and triangle packs, used by the cooked model format
+		void Serialize(std::vector<uint8_t>& out) const;
+		bool Deserialize(const uint8_t* data, size_t size);
+
+		bool IsEmpty() const;
+		size_t GetTriangleCount() const;
+
+		// Nearest hit along the ray, the direction does not need to be normalized and distance is in units of it
+		bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const;
+
+		// Calls callback(v0, v1, v2) for every stored triangle in leaf order
+		template<typename Callback>
+		void ForEachTriangle(Callback&& callback) const;
+
+	private:
+		struct Node
+		{
+			glm::vec3 min;
+			// Leaf: first pack, inner: left child (the right child follows it)
+			uint32_t leftOrFirst = 0;
+			glm::vec3 max;
+			// Pack count, 0 for inner nodes
+			uint32_t packCount = 0;
+		};
+
+		// Structure of arrays over four triangles, unused lanes are degenerate and never hit
+		struct TrianglePack
+		{
+			float v0x[4], v0y[4], v0z[4];
+			float e1x[4], e1y[4], e1z[4];
+			float e2x[4], e2y[4], e2z[4];
+		};
+
+		static constexpr uint32_t MaxDepth = 48;
+		static constexpr uint32_t LeafSize = 4;
+		static constexpr uint32_t BinCount = 8;
+
+		std::vector<Node> nodes;
+		std::vector<TrianglePack> packs;
+		size_t triangleCount = 0;
+
+		struct BuildData
+		{
+			const std::vector<glm::vec3>& positions;
+			const std::vector<uint32_t>& indices;
+			std::vector<uint32_t> triangles;
+			std::vector<AABB> triangleBounds;
+			std::vector<glm::vec3> centroids;
+		};
+
+		// Child and pack ranges in bounds and depth within the traversal stack
+		bool Validate() const;
+
+		void Subdivide(BuildData& data, uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth);
+		void MakeLeaf(BuildData& data, uint32_t nodeIndex, uint32_t first, uint32_t count);
+
+		static float SurfaceArea(const AABB& aabb);
+		static bool IntersectNode(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& entry);
+		static void IntersectPack(const TrianglePack& pack, const glm::vec3& origin, const glm::vec3& direction, float& closest);
+	};
+
+	template<typename Callback>
+	void TriangleBVH::ForEachTriangle(Callback&& callback) const
+	{
+		for (const TrianglePack& pack : packs)
+		{
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				glm::vec3 e1(pack.e1x[lane], pack.e1y[lane], pack.e1z[lane]);
+				glm::vec3 e2(pack.e2x[lane], pack.e2y[lane], pack.e2z[lane]);
+
+				// Padding lanes have zero edges
+				if (e1 == glm::vec3(0.0f) && e2 == glm::vec3(0.0f))
+					continue;
+
+				glm::vec3 v0(pack.v0x[lane], pack.v0y[lane], pack.v0z[lane]);
+				callback(v0, v0 + e1, v0 + e2);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 namespace Nightbird
 {
+	// Full precision vertex used during import, packed into the GPU layout below at upload
 	struct Vertex
 	{
 		glm::vec3 position;
@@ -17,8 +18,33 @@ namespace Nightbird
 		glm::vec2 metallicRoughnessTexCoord;
 		glm::vec2 normalTexCoord;
 
-		static VkVertexInputBindingDescription GetBindingDescription();
+		// Binding 0 holds PackedVertex, bindings 1-3 one PackedTexCoord stream per texture coordinate set
+		static std::array<VkVertexInputBindingDescription, 4> GetBindingDescriptions();
 
 		static std::array<VkVertexInputAttributeDescription, 5> GetAttributeDescriptions();
 	};
+
+	struct PackedVertex
+	{
+		// Unorm over the primitive bounds, w is padding
+		uint16_t position[4];
+		// Octahedral encoded snorm
+		int16_t normal[2];
+	};
+
+	// Half float, sets matching another one share its stream
+	struct PackedTexCoord
+	{
+		uint16_t uv[2];
+	};
+
+	// Vertex stage push constant, position = offset + unorm * scale
+	struct VertexDecode
+	{
+		glm::vec4 positionOffset;
+		glm::vec4 positionScale;
+	};
+
+	PackedVertex PackVertex(const Vertex& vertex, const VertexDecode& decode);
+	PackedTexCoord PackTexCoord(const glm::vec2& texCoord);
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ namespace Nightbird
 
 		VkBuffer Get() const;
 		VmaAllocation GetAllocation() const;
+		VkDeviceSize GetSize() const;
 
 		void* Map();
 		void Unmap();
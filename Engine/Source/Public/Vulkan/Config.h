@@ -12,6 +12,9 @@ namespace VulkanConfig
 
 	extern const std::vector<const char*> deviceExtensions;
 
+	// Enabled when the physical device supports them
+	extern const std::vector<const char*> optionalDeviceExtensions;
+
 	extern bool CheckValidationLayerSupport();
 
 	extern void InitializeVulkanConfig();
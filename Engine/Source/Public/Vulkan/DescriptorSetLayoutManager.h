@@ -15,15 +15,18 @@ namespace Nightbird
 		VkDescriptorSetLayout GetGlobalDescriptorSetLayout() const;
 		VkDescriptorSetLayout GetMeshDescriptorSetLayout() const;
 		VkDescriptorSetLayout GetMaterialDescriptorSetLayout() const;
+		VkDescriptorSetLayout GetOitCompositeDescriptorSetLayout() const;
 
 	private:
 		void CreateGlobalDescriptorSetLayout();
 		void CreateMeshDescriptorSetLayout();
 		void CreateMaterialDescriptorSetLayout();
+		void CreateOitCompositeDescriptorSetLayout();
 
 		VkDescriptorSetLayout globalDescriptorSetLayout;
 		VkDescriptorSetLayout meshDescriptorSetLayout;
 		VkDescriptorSetLayout materialDescriptorSetLayout;
+		VkDescriptorSetLayout oitCompositeDescriptorSetLayout;
 		
 		VulkanDevice* device;
 	};
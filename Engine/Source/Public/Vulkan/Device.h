@@ -28,6 +28,14 @@ namespace Nightbird
 
 		VmaAllocator GetAllocator() const;
 
+		bool IsExtensionEnabled(const char* extensionName) const;
+		bool IsMemoryBudgetSupported() const;
+
+		void SetFrameIndex(uint32_t frameIndex);
+
+		std::vector<VmaBudget> GetHeapBudgets() const;
+		bool IsHeapDeviceLocal(uint32_t heapIndex) const;
+
 		std::vector<VkCommandBuffer> commandBuffers;
 
 		VkQueue graphicsQueue;
@@ -44,6 +52,11 @@ namespace Nightbird
 
 		VmaAllocator allocator;
 
+		std::vector<const char*> enabledExtensions;
+		bool memoryBudgetSupported = false;
+
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+
 		VkCommandPool commandPool;
 
 		void SelectPhysicalDevice();
@@ -14,6 +14,7 @@ namespace Nightbird
 	struct DirectionalLightMetaUBO;
 	struct PointLightData;
 	struct PointLightMetaUBO;
+	class LightClusterGrid;
 
 	class GlobalDescriptorSetManager
 	{
@@ -25,7 +26,8 @@ namespace Nightbird
 
 		void UpdateCamera(uint32_t frameIndex, const CameraUBO& cameraUBO);
 		void UpdateDirectionalLights(uint32_t frameIndex, const std::vector<DirectionalLightData>& directionalLights);
-		void UpdatePointLights(uint32_t frameIndex, const std::vector<PointLightData>& pointLights);
+		void UpdatePointLights(uint32_t frameIndex, const std::vector<PointLightData>& pointLights, bool perObjectLights);
+		void UpdateLightClusters(uint32_t frameIndex, const LightClusterGrid& lightClusterGrid);
 
 	private:
 		VulkanDevice* device;
@@ -37,6 +39,9 @@ namespace Nightbird
 		std::vector<VulkanUniformBuffer> directionalLightMetaBuffers;
 		std::vector<VulkanStorageBuffer> pointLightBuffers;
 		std::vector<VulkanUniformBuffer> pointLightMetaBuffers;
+		std::vector<VulkanStorageBuffer> lightClusterBuffers;
+		std::vector<VulkanStorageBuffer> lightIndexBuffers;
+		std::vector<VulkanUniformBuffer> lightClusterMetaBuffers;
 		
 		void CreateBuffers();
 		void CreateDescriptorSets(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool descriptorPool);
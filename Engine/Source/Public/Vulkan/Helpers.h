@@ -27,6 +27,8 @@ namespace Nightbird
 	};
 	
 	int RateDeviceSuitability(VkPhysicalDevice device, VkSurfaceKHR surface);
+
+	bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName);
 	
 	QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
 	SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface);
@@ -36,6 +38,6 @@ namespace Nightbird
 
 	bool HasStencilComponent(VkFormat format);
 
-	void CopyBuffer(VulkanDevice* device, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+	void CopyBuffer(VulkanDevice* device, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0);
 	void CopyBufferToImage(VulkanDevice* device, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
 }
\ No newline at end of file
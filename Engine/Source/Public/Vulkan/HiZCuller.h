@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include <volk.h>
+#include <vk_mem_alloc.h>
+
+#include <glm/glm.hpp>
+
+#include <Vulkan/Config.h>
+
+namespace Nightbird
+{
+	class VulkanDevice;
+	class VulkanImage;
+	class VulkanStorageBuffer;
+	class MeshInstance;
+	class MeshPrimitive;
+	struct Renderable;
+	struct AABB;
+
+	// GPU occlusion culling against a hierarchical depth pyramid. Draws visible in the last frame are drawn first,
+	// their depth is reduced into a max-depth mip chain and every queued draw is tested against it in a compute shader.
+	// Draws rejected last frame but visible now get a late command drawn in the same frame, all results are indirect
+	// draws with an instance count of 0 or 1
+	class VulkanHiZCuller
+	{
+	public:
+		VulkanHiZCuller(VulkanDevice* device);
+		~VulkanHiZCuller();
+
+		// False when the depth format can't be sampled or the compute pipelines failed to build
+		bool IsSupported() const;
+
+		// Returns how many draws the last test recorded in this frame slot found occluded
+		uint32_t Begin(uint32_t currentFrame, uint64_t frameNumber, const glm::mat4& viewProjection, VkExtent2D extent, size_t drawCount);
+
+		// Queues the draw for this frame's test, draws tested by the previous frame are pointed at its indirect command
+		void AddDraw(Renderable& renderable, const AABB& worldBounds);
+
+		// Recorded between the two scene passes, the depth image must be in the attachment layout the first left.
+		// Returns false when nothing was tested, the late commands are then stale
+		bool Dispatch(VkCommandBuffer commandBuffer, VulkanImage* depthImage);
+
+		// Same layout as the command buffer AddDraw points at, only draws occluded last frame and visible now are set
+		VkBuffer GetLateCommandBuffer() const;
+
+	private:
+		static constexpr uint32_t MaxMipCount = 16;
+
+		// Mirrors CullObject in OcclusionCull.comp
+		struct CullObject
+		{
+			glm::vec4 boundsMin;
+			glm::vec4 boundsMax;
+			uint32_t indexCount;
+			uint32_t firstIndex;
+			uint32_t active;
+			uint32_t padding;
+		};
+
+		struct ReducePushConstants
+		{
+			glm::ivec2 inputSize;
+			glm::ivec2 outputSize;
+		};
+
+		struct CullPushConstants
+		{
+			glm::mat4 viewProjection;
+			glm::vec2 pyramidSize;
+			uint32_t objectCount;
+			uint32_t mipCount;
+		};
+
+		struct DrawKey
+		{
+			const MeshInstance* instance;
+			const MeshPrimitive* primitive;
+
+			bool operator==(const DrawKey& other) const
+			{
+				return instance == other.instance && primitive == other.primitive;
+			}
+		};
+
+		struct DrawKeyHash
+		{
+			size_t operator()(const DrawKey& key) const
+			{
+				return std::hash<const void*>()(key.instance) ^ (std::hash<const void*>()(key.primitive) * 31);
+			}
+		};
+
+		// Draws keep their slot while they stay in view, so a command written last frame is found again
+		struct Slot
+		{
+			uint64_t lastSeenFrame = 0;
+			uint64_t testedFrame = 0;
+			// The command holds the index range of the tested LOD, a different one has to draw directly
+			uint32_t testedFirstIndex = 0;
+			uint32_t testedIndexCount = 0;
+		};
+
+		void CreateDescriptorSetLayouts();
+		void CreateDescriptorPool();
+		void CreatePipelines();
+		void CreatePyramid(VkExtent2D extent);
+		void CleanupPyramid();
+		void CreateBuffers(size_t capacity);
+
+		void UpdateDescriptorSets(VulkanImage* depthImage);
+
+		std::array<VkDescriptorSet, VulkanConfig::MAX_FRAMES_IN_FLIGHT * MaxMipCount> reduceDescriptorSets{};
+		std::array<VkDescriptorSet, VulkanConfig::MAX_FRAMES_IN_FLIGHT> cullDescriptorSets{};
+
+		VkDescriptorSetLayout reduceDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout cullDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+		VkPipelineLayout reducePipelineLayout = VK_NULL_HANDLE;
+		VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline reducePipeline = VK_NULL_HANDLE;
+		VkPipeline cullPipeline = VK_NULL_HANDLE;
+
+		VkImage pyramidImage = VK_NULL_HANDLE;
+		VmaAllocation pyramidAllocation = VK_NULL_HANDLE;
+		VkImageView pyramidView = VK_NULL_HANDLE;
+		std::array<VkImageView, MaxMipCount> pyramidMipViews{};
+		VkExtent2D pyramidExtent = {0, 0};
+		VkExtent2D depthExtent = {0, 0};
+		uint32_t mipCount = 0;
+
+		VkSampler sampler = VK_NULL_HANDLE;
+
+		// Objects and stats are written by the host each frame, the commands only live on the GPU
+		std::array<std::unique_ptr<VulkanStorageBuffer>, VulkanConfig::MAX_FRAMES_IN_FLIGHT> objectBuffers;
+		std::array<std::unique_ptr<VulkanStorageBuffer>, VulkanConfig::MAX_FRAMES_IN_FLIGHT> statsBuffers;
+		std::unique_ptr<VulkanStorageBuffer> drawCommandBuffer;
+		std::unique_ptr<VulkanStorageBuffer> lateCommandBuffer;
+		size_t capacity = 0;
+
+		std::unordered_map<DrawKey, uint32_t, DrawKeyHash> slotLookup;
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeSlots;
+		std::vector<uint32_t> queuedSlots;
+		std::vector<CullObject> objects;
+
+		glm::mat4 viewProjection = glm::mat4(1.0f);
+		uint32_t currentFrame = 0;
+		uint64_t frameNumber = 0;
+
+		VulkanDevice* device;
+
+		bool supported = false;
+	};
+}
\ No newline at end of file
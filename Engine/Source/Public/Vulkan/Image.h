@@ -1,6 +1,7 @@
 #pragma once
 
 #include <volk.h>
+#include <vk_mem_alloc.h>
 
 namespace Nightbird
 {
@@ -15,6 +16,8 @@ namespace Nightbird
 
 		VkImage Get() const;
 		VkImageView GetImageView() const;
+		VkFormat GetFormat() const;
+		VkDeviceSize GetMemorySize() const;
 
 		void CreateImageView(VkImageAspectFlags aspectFlags);
 
@@ -27,12 +30,13 @@ namespace Nightbird
 		VkFormat format;
 
 		VkImageView imageView;
-		VkDeviceMemory memory;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		VkDeviceSize memorySize = 0;
 
 		VulkanDevice* device;
 
 		bool ownsImage;
 
-		void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImage& image, VkDeviceMemory& imageMemory);
+		void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+
+#include <volk.h>
+
+namespace Nightbird
+{
+	class VulkanDevice;
+	class VulkanImage;
+
+	// Accumulation and revealage attachments for weighted blended order independent transparency,
+	// plus the input attachment descriptor set read by the composite subpass
+	class VulkanOitTargets
+	{
+	public:
+		VulkanOitTargets(VulkanDevice* device, uint32_t width, uint32_t height, VkDescriptorSetLayout compositeDescriptorSetLayout, VkDescriptorPool descriptorPool);
+		~VulkanOitTargets();
+
+		VkImageView GetAccumImageView() const;
+		VkImageView GetRevealageImageView() const;
+
+		VkDescriptorSet GetCompositeDescriptorSet() const;
+
+		static constexpr VkFormat ACCUM_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+		static constexpr VkFormat REVEALAGE_FORMAT = VK_FORMAT_R16_SFLOAT;
+
+	private:
+		void CreateCompositeDescriptorSet(VkDescriptorSetLayout compositeDescriptorSetLayout);
+
+		std::unique_ptr<VulkanImage> accumImage;
+		std::unique_ptr<VulkanImage> revealageImage;
+
+		VkDescriptorSet compositeDescriptorSet = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+		VulkanDevice* device;
+	};
+}
\ No newline at end of file
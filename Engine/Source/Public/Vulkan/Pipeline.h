@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 #include <volk.h>
 
@@ -13,12 +14,21 @@ namespace Nightbird
 	class GlobalDescriptorSetManager;
 	struct Renderable;
 	class Mesh;
+	class MeshPrimitive;
 	class Camera;
 	
 	enum class PipelineType
 	{
 		Opaque,
-		Transparent
+		Transparent,
+		// Position only, no fragment stage, writes depth
+		DepthPrepass,
+		// Opaque shading over a pre-pass depth buffer, EQUAL test without depth writes
+		OpaqueDepthEqual,
+		// Weighted blended OIT accumulation into the accum and revealage targets
+		TransparentAccumulate,
+		// Fullscreen resolve of the OIT targets over the opaque color
+		TransparentComposite
 	};
 
 	class VulkanPipeline
@@ -29,13 +39,27 @@ namespace Nightbird
 
 		void SetDescriptorPool(VkDescriptorPool pool);
 		
-		void Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<Renderable>& renderables, Camera* camera);
-		void RenderSingle(VkCommandBuffer commandBuffer, uint32_t currentFrame, const Renderable& renderable, Camera* camera);
+		// sceneVariantKey holds the scene dependent ShaderVariant bits, combined with each primitive's material bits
+		void Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<Renderable>& renderables, Camera* camera, uint32_t sceneVariantKey);
+		void RenderSingle(VkCommandBuffer commandBuffer, uint32_t currentFrame, const Renderable& renderable, Camera* camera, uint32_t sceneVariantKey);
+		void RenderFullscreen(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet);
 
 	private:
-		void CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* layoutManager);
+		void CreatePipelineLayout(VulkanDescriptorSetLayoutManager* layoutManager);
+		VkPipeline CreateGraphicsPipeline(uint32_t variantKey);
 
-		VkPipeline pipeline;
+		// Returns the cached variant, creating it on first use
+		VkPipeline GetVariant(uint32_t variantKey);
+		bool UsesShaderVariants() const;
+
+		// Vertex streams, index buffer and the position dequantization push constant
+		void BindPrimitive(VkCommandBuffer commandBuffer, const MeshPrimitive* primitive);
+
+		uint32_t GetBoundDescriptorSetCount() const;
+		uint32_t GetSubpass() const;
+
+		// Specialization constant permutations keyed by ShaderVariant bits, all sharing one layout
+		std::unordered_map<uint32_t, VkPipeline> variants;
 		VkPipelineLayout pipelineLayout;
 		
 		VkDescriptorPool descriptorPool;
@@ -6,6 +6,15 @@ namespace Nightbird
 {
 	class VulkanDevice;
 
+	// Scene pass first (opaque and sorted transparency), then the weighted blended OIT accumulation and composite
+	namespace RenderSubpass
+	{
+		constexpr uint32_t Scene = 0;
+		constexpr uint32_t TransparentAccumulate = 1;
+		constexpr uint32_t TransparentComposite = 2;
+		constexpr uint32_t Count = 3;
+	}
+
 	class VulkanRenderPass
 	{
 	public:
@@ -15,6 +24,10 @@ namespace Nightbird
 		VkRenderPass Get() const;
 
 		void Begin(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent);
+		// Begins again on the same framebuffer after End, keeping the color and depth the first pass left
+		void Resume(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent);
+		void NextSubpass(VkCommandBuffer commandBuffer);
+		// Steps through any subpasses the caller did not use before ending
 		void End(VkCommandBuffer commandBuffer);
 
 		void BeginCommandBuffer(VkCommandBuffer commandBuffer);
@@ -22,9 +35,15 @@ namespace Nightbird
 
 	private:
 		VkRenderPass renderPass;
+		// Compatible with renderPass, only the load operations and initial layouts differ
+		VkRenderPass resumeRenderPass;
+
+		uint32_t currentSubpass = 0;
 
 		VulkanDevice* device;
 
-		void Create(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout finalColorLayout);
+		void BeginPass(VkCommandBuffer commandBuffer, VkRenderPass pass, VkFramebuffer framebuffer, VkExtent2D extent);
+
+		VkRenderPass Create(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout finalColorLayout, bool resume);
 	};
 }
\ No newline at end of file
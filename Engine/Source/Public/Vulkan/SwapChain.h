@@ -21,10 +21,12 @@ namespace Nightbird
 
 		VkFormat GetColorFormat() const;
 		VkFormat GetDepthFormat() const;
+		VulkanImage* GetDepthImage() const;
 
 		void CreateSwapChain();
 		void CreateDepthResources();
-		void CreateFramebuffers(VkRenderPass renderPass);
+		// Shared attachments (e.g. OIT targets) are appended after color and depth in every framebuffer
+		void CreateFramebuffers(VkRenderPass renderPass, const std::vector<VkImageView>& sharedAttachments);
 
 		void CleanupSwapChain();
 
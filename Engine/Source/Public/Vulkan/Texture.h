@@ -33,8 +33,10 @@ namespace Nightbird
 		VulkanTexture(VulkanDevice* device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usageFlags, VkImageAspectFlags aspectFlags);
 		~VulkanTexture();
 
+		VulkanImage* GetImage() const;
 		VkImageView GetImageView() const;
 		VkSampler GetSampler() const;
+		VkDeviceSize GetMemorySize() const;
 
 		void TransitionToShaderRead(VkCommandBuffer commandBuffer);
 		void TransitionToColor(VkCommandBuffer commandBuffer);
@@ -16,6 +16,8 @@ void Player::Tick(float delta)
 {
 	auto& input = Input::Get();
 
+	const Transform& transform = GetTransform();
+
 	glm::vec3 forward = transform.rotation * glm::vec3(0.0f, 0.0f, -1.0f);
 	glm::vec3 right = transform.rotation * glm::vec3(1.0f, 0.0f, 0.0f);
 	glm::vec3 up = transform.rotation * glm::vec3(0.0f, 1.0f, 0.0f);
@@ -35,7 +37,7 @@ void Player::Tick(float delta)
 	if (input.IsKeyPressed(GLFW_KEY_E))
 		movementDir += up;
 
-	transform.position += movementDir * movementSpeed * delta;
+	SetPosition(transform.position + movementDir * movementSpeed * delta);
 
 	double mouseX, mouseY;
 	input.GetCursorPos(mouseX, mouseY);
@@ -52,7 +54,7 @@ void Player::Tick(float delta)
 	glm::quat pitchQuat = glm::angleAxis(pitchDelta, right);
 	glm::quat yawQuat = glm::angleAxis(yawDelta, glm::vec3(0.0f, 1.0f, 0.0f));
 
-	transform.rotation = glm::normalize(yawQuat * pitchQuat * transform.rotation);
+	SetRotation(glm::normalize(yawQuat * pitchQuat * transform.rotation));
 }
 
 void Player::OnJump()
@@ -33,6 +33,10 @@ group "Nightbird"
 	include "Editor"
 group ""
 
+group "Tools"
+	include "AssetCooker"
+group ""
+
 group "Nightbird/Modules"
 	include "Engine/Modules/Input"
 group ""